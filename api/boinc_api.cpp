@@ -335,6 +335,13 @@ static int setup_shared_mem() {
 #endif
 #endif  // ! _WIN32
     if (app_client_shm == NULL) return -1;
+
+    // if the client's segment has message rings, tell it we'll use them
+    //
+    if (aid.msg_ring_version >= MSG_RING_VERSION) {
+        app_client_shm->has_rings = true;
+        app_client_shm->shm->ring_header.app_ring_version = MSG_RING_VERSION;
+    }
     return 0;
 }
 #endif      // MSGS_FROM_FILE
@@ -440,7 +447,7 @@ static bool update_app_progress(double cpu_t, double cp_cpu_t) {
     }
     return 0;
 #else
-    return app_client_shm->shm->app_status.send_msg(msg_buf);
+    return app_client_shm->send_msg(app_client_shm->shm->app_status, msg_buf);
 #endif
 }
 
@@ -451,7 +458,7 @@ static void handle_heartbeat_msg() {
     double dtemp;
     bool btemp;
 
-    if (!app_client_shm->shm->heartbeat.get_msg(buf)) {
+    if (!app_client_shm->get_msg(app_client_shm->shm->heartbeat, buf)) {
         return;
     }
     boinc_status.network_suspended = false;
@@ -520,7 +527,7 @@ static void parallel_master(int child_pid) {
         interrupt_count++;
         if (app_client_shm) {
             handle_heartbeat_msg();
-            if (app_client_shm->shm->process_control_request.get_msg(buf)) {
+            if (app_client_shm->get_msg(app_client_shm->shm->process_control_request, buf)) {
                 if (match_tag(buf, "<suspend/>")) {
                     kill(child_pid, SIGSTOP);
                 } else if (match_tag(buf, "<resume/>")) {
@@ -740,7 +747,7 @@ static void send_trickle_up_msg() {
     }
     if (strlen(buf)) {
         BOINCINFO("Sending Trickle Up Message");
-        if (app_client_shm->shm->trickle_up.send_msg(buf)) {
+        if (app_client_shm->send_msg(app_client_shm->shm->trickle_up, buf)) {
             have_new_trickle_up = false;
             have_new_upload_file = false;
         }
@@ -988,7 +995,7 @@ int boinc_report_app_status_aux(
     }
     return 0;
 #else
-    if (app_client_shm->shm->app_status.send_msg(msg_buf)) {
+    if (app_client_shm->send_msg(app_client_shm->shm->app_status, msg_buf)) {
         return 0;
     }
     return ERR_WRITE;
@@ -1123,7 +1130,7 @@ static void handle_upload_file_status() {
 //
 static void handle_trickle_down_msg() {
     char buf[MSG_CHANNEL_SIZE];
-    if (app_client_shm->shm->trickle_down.get_msg(buf)) {
+    if (app_client_shm->get_msg(app_client_shm->shm->trickle_down, buf)) {
         BOINCINFO("Received Trickle Down Message");
         if (match_tag(buf, "<have_trickle_down/>")) {
             have_trickle_down = true;
@@ -1161,7 +1168,7 @@ static void handle_process_control_msg() {
         return;
     }
 #else
-    if (!app_client_shm->shm->process_control_request.get_msg(buf)) {
+    if (!app_client_shm->get_msg(app_client_shm->shm->process_control_request, buf)) {
         return;
     }
 #endif
@@ -62,6 +62,8 @@
 #include "util.h"
 
 #include "async_file.h"
+#include "cgroup.h"
+#include "disk_usage.h"
 #include "client_msgs.h"
 #include "client_state.h"
 #include "procinfo.h"
@@ -97,8 +99,14 @@ ACTIVE_TASK::ACTIVE_TASK() {
     wup = NULL;
     app_version = NULL;
     pid = 0;
+#ifdef __linux__
+    pidfd = -1;
+    numa_node = -1;
+    in_cgroup = false;
+#endif
 
     _task_state = PROCESS_UNINITIALIZED;
+    saved_task_state = -1;
     slot = 0;
     checkpoint_cpu_time = 0;
     checkpoint_elapsed_time = 0;
@@ -267,9 +275,23 @@ void ACTIVE_TASK::cleanup_task() {
         app_client_shm.shm = NULL;
         gstate.retry_shmem_time = 0;
     }
+#ifdef __linux__
+    if (pidfd >= 0) {
+        close(pidfd);
+        pidfd = -1;
+    }
+#endif
 #endif
 
     kill_subsidiary_processes();
+#ifdef __linux__
+    if (in_cgroup) {
+        cgroups.remove_slot(slot);
+        in_cgroup = false;
+    }
+    numa_node = -1;
+    placed_cpus.clear();
+#endif
 
     if (cc_config.exit_after_finish) {
         msg_printf(wup->project, MSG_INFO,
@@ -352,17 +374,79 @@ void procinfo_show(PROC_MAP& pm) {
 }
 #endif
 
+#ifdef __linux__
+// Set the task's cgroup limits:
+// its share of the CPU usage limit (unless it's not throttled)
+// and the client's RAM limit.
+// The kernel enforces these smoothly,
+// so we don't need to suspend and resume the task to throttle it.
+//
+void ACTIVE_TASK::set_cgroup_limits() {
+    double ncpus = 0;
+    double limit = gstate.global_prefs.cpu_usage_limit;
+    if (!result->dont_throttle() && limit > 0 && limit < 100) {
+        ncpus = std::max(app_version->avg_ncpus, 1.)*limit/100;
+    }
+    int retval = cgroups.set_limits(slot, ncpus, gstate.max_available_ram());
+    if (retval && log_flags.task_debug) {
+        msg_printf(result->project, MSG_INFO,
+            "[task] can't set cgroup limits for %s: %s",
+            result->name, boincerror(retval)
+        );
+    }
+}
+
+// Get the CPU time of non-BOINC processes since boot,
+// given a PROC_MAP of the client's process tree (see procinfo_setup_tree()).
+// This is the host total from /proc/stat
+// minus the part of it used by BOINC processes
+// (their kernel time, and their user time if they're not niced).
+// BOINC time is accumulated per process from one call to the next,
+// so that when a long-running task exits
+// it doesn't look like a burst of non-BOINC usage.
+//
+static int non_boinc_cpu_time(PROC_MAP& pm, double& t) {
+    static std::map<int, double> last_times;
+    static double boinc_time = 0;
+    std::map<int, double> times;
+    std::map<int, double>::iterator j;
+    double host_time;
+
+    int retval = procinfo_host_cpu_time(host_time);
+    if (retval) return retval;
+    for (PROC_MAP::iterator i=pm.begin(); i!=pm.end(); ++i) {
+        PROCINFO& p = i->second;
+        double x = p.kernel_time;
+        if (!p.is_niced) x += p.user_time;
+        times[p.id] = x;
+        j = last_times.find(p.id);
+        double d = (j == last_times.end())? x : x - j->second;
+        if (d > 0) boinc_time += d;
+    }
+    last_times.swap(times);
+    t = host_time - boinc_time;
+    return 0;
+}
+#endif
+
 // scan the set of all processes to
 // 1) get the working-set size of active tasks
 // 2) see if exclusive apps are running
 // 3) get CPU time of non-BOINC processes
 //
+// With <proc_tree_scan> (Linux) only the client's process tree is scanned,
+// and non-BOINC CPU time is derived from the host total.
+// Exclusive apps are recognized by name, so they need a full scan.
+//
 void ACTIVE_TASK_SET::get_memory_usage() {
     static double last_mem_time=0;
     unsigned int i;
     int retval;
     static bool first = true;
     static double last_cpu_time;
+    static bool last_have_cpu_time = false;
+    static bool last_tree_scan = false;
+    bool tree_scan = false;
     double diff=0;
 
     if (!first) {
@@ -379,14 +463,42 @@ void ACTIVE_TASK_SET::get_memory_usage() {
 
     last_mem_time = gstate.now;
     PROC_MAP pm;
-    retval = procinfo_setup(pm);
-    if (retval) {
-        if (log_flags.mem_usage_debug) {
-            msg_printf(NULL, MSG_INTERNAL_ERROR,
-                "[mem_usage] procinfo_setup() returned %d", retval
-            );
+#ifdef __linux__
+    if (cc_config.proc_tree_scan
+        && cc_config.exclusive_apps.empty()
+        && cc_config.exclusive_gpu_apps.empty()
+    ) {
+        // other_pids (e.g. VMs) may not be our descendants
+        //
+        vector<int> roots(1, getpid());
+        for (i=0; i<active_tasks.size(); i++) {
+            ACTIVE_TASK* atp = active_tasks[i];
+            roots.insert(roots.end(), atp->other_pids.begin(), atp->other_pids.end());
+        }
+        retval = procinfo_setup_tree(pm, roots);
+        if (retval) {
+            if (log_flags.mem_usage_debug) {
+                msg_printf(NULL, MSG_INFO,
+                    "[mem_usage] procinfo_setup_tree() returned %d; scanning all processes",
+                    retval
+                );
+            }
+            pm.clear();
+        } else {
+            tree_scan = true;
+        }
+    }
+#endif
+    if (!tree_scan) {
+        retval = procinfo_setup(pm);
+        if (retval) {
+            if (log_flags.mem_usage_debug) {
+                msg_printf(NULL, MSG_INTERNAL_ERROR,
+                    "[mem_usage] procinfo_setup() returned %d", retval
+                );
+            }
+            return;
         }
-        return;
     }
     PROCINFO boinc_total;
     if (log_flags.mem_usage_debug) {
@@ -414,6 +526,14 @@ void ACTIVE_TASK_SET::get_memory_usage() {
             v = &(atp->other_pids);
         }
         procinfo_app(pi, v, pm, atp->app_version->graphics_exec_file);
+#ifdef __linux__
+        // the cgroup has exact figures for all the task's processes
+        //
+        if (atp->in_cgroup) {
+            cgroups.get_usage(atp->slot, pi);
+            atp->set_cgroup_limits();
+        }
+#endif
         if (atp->app_version->is_vm_app) {
             // the memory of virtual machine apps is not reported correctly,
             // at least on Windows.  Use the VM size instead.
@@ -495,18 +615,40 @@ void ACTIVE_TASK_SET::get_memory_usage() {
     // not all of them generate disk I/O,
     // so they're not useful for detecting paging/thrashing.
     //
-    PROCINFO pi;
-    procinfo_non_boinc(pi, pm);
-    if (log_flags.mem_usage_debug) {
-        //procinfo_show(pm);
-        msg_printf(NULL, MSG_INFO,
-            "[mem_usage] All others: WS %.2fMB, swap %.2fMB, user %.3fs, kernel %.3fs",
-            pi.working_set_size/MEGA, pi.swap_size/MEGA,
-            pi.user_time, pi.kernel_time
-        );
+    double new_cpu_time = 0;
+    bool have_cpu_time = true;
+#ifdef __linux__
+    if (tree_scan) {
+        retval = non_boinc_cpu_time(pm, new_cpu_time);
+        if (retval) {
+            if (log_flags.mem_usage_debug) {
+                msg_printf(NULL, MSG_INTERNAL_ERROR,
+                    "[mem_usage] can't get host CPU time: %s", boincerror(retval)
+                );
+            }
+            have_cpu_time = false;
+        }
+    } else
+#endif
+    {
+        PROCINFO pi;
+        procinfo_non_boinc(pi, pm);
+        if (log_flags.mem_usage_debug) {
+            //procinfo_show(pm);
+            msg_printf(NULL, MSG_INFO,
+                "[mem_usage] All others: WS %.2fMB, swap %.2fMB, user %.3fs, kernel %.3fs",
+                pi.working_set_size/MEGA, pi.swap_size/MEGA,
+                pi.user_time, pi.kernel_time
+            );
+        }
+        new_cpu_time = pi.user_time + pi.kernel_time;
     }
-    double new_cpu_time = pi.user_time + pi.kernel_time;
-    if (!first) {
+
+    // the two ways of getting non-BOINC CPU time aren't comparable
+    //
+    if (!first && have_cpu_time && last_have_cpu_time
+        && tree_scan == last_tree_scan
+    ) {
         non_boinc_cpu_usage = (new_cpu_time - last_cpu_time)/(diff*gstate.host_info.p_ncpus);
         // processes might have exited in the last 10 sec,
         // causing this to be negative.
@@ -518,6 +660,8 @@ void ACTIVE_TASK_SET::get_memory_usage() {
         }
     }
     last_cpu_time = new_cpu_time;
+    last_have_cpu_time = have_cpu_time;
+    last_tree_scan = tree_scan;
     first = false;
 }
 
@@ -558,7 +702,11 @@ int ACTIVE_TASK::current_disk_usage(double& size) {
     FILE_INFO* fip;
     char path[MAXPATHLEN];
 
+#if defined(__linux__) && !defined(SIM)
+    retval = disk_usage_tracker.get_usage(slot_dir, size, false);
+#else
     retval = dir_size(slot_dir, size);
+#endif
     if (retval) return retval;
     for (i=0; i<result->output_files.size(); i++) {
         fip = result->output_files[i].file_info;
@@ -964,8 +1112,10 @@ void MSG_QUEUE::init(char* n) {
     msgs.clear();
 }
 
-void MSG_QUEUE::msg_queue_send(const char* msg, MSG_CHANNEL& channel) {
-    if ((msgs.size()==0) && channel.send_msg(msg)) {
+void MSG_QUEUE::msg_queue_send(
+    const char* msg, APP_CLIENT_SHM& shm, MSG_CHANNEL& channel
+) {
+    if ((msgs.size()==0) && shm.send_msg(channel, msg)) {
         if (log_flags.app_msg_send) {
             msg_printf(NULL, MSG_INFO,
                 "[app_msg_send] sent %s to %s", msg, name
@@ -983,7 +1133,9 @@ void MSG_QUEUE::msg_queue_send(const char* msg, MSG_CHANNEL& channel) {
     if (!last_block) last_block = gstate.now;
 }
 
-void MSG_QUEUE::msg_queue_poll(MSG_CHANNEL& channel) {
+// send as many queued messages as the channel will take
+//
+void MSG_QUEUE::msg_queue_poll(APP_CLIENT_SHM& shm, MSG_CHANNEL& channel) {
     if (msgs.empty()) return;
     if (log_flags.app_msg_send) {
         msg_printf(NULL, MSG_INFO,
@@ -991,7 +1143,7 @@ void MSG_QUEUE::msg_queue_poll(MSG_CHANNEL& channel) {
             (int)msgs.size(), name
         );
     }
-    if (channel.send_msg(msgs[0].c_str())) {
+    while (!msgs.empty() && shm.send_msg(channel, msgs[0].c_str())) {
         if (log_flags.app_msg_send) {
             msg_printf(NULL, MSG_INFO,
                 "[app_msg_send] poll: delayed sent %s", msgs[0].c_str()
@@ -1196,7 +1348,9 @@ void* throttler(void*) {
     while (1) {
         client_mutex.lock(); //!< @todo a mutex should be in a RAII form
 
-        // Don't throttle if all tasks are suspended
+        // Don't throttle if all tasks are suspended.
+        // Tasks in cgroups are throttled by those
+        // (see ACTIVE_TASK::set_cgroup_limits())
         if (gstate.tasks_suspended) {
             gstate.tasks_throttled = false;
             goto end;
@@ -1217,6 +1371,9 @@ void* throttler(void*) {
             const auto task_state = apt->task_state();
             // Filter out CPU tasks
             if (apt->result->dont_throttle()) continue;
+#ifdef __linux__
+            if (apt->in_cgroup) continue;
+#endif
             if (task_state != PROCESS_EXECUTING && task_state != PROCESS_SUSPENDED) continue;
             // Unsuspend if no limit
             if (cpu_usage_limit >= 100 && task_state == PROCESS_SUSPENDED) {
@@ -1240,6 +1397,9 @@ void* throttler(void*) {
 	            const auto task_state = apt->task_state();
                 // Filter out CPU tasks
                 if (apt->result->dont_throttle()) continue;
+#ifdef __linux__
+                if (apt->in_cgroup) continue;
+#endif
                 if (task_state != PROCESS_EXECUTING && task_state != PROCESS_SUSPENDED) continue;
 
                 // Determine start tick; spread start of tasks evenly over 100 second window
@@ -25,6 +25,7 @@
 
 #include "app_ipc.h"
 #include "common_defs.h"
+#include "network.h"
 #include "procinfo.h"
 
 #include "client_types.h"
@@ -63,6 +64,18 @@ struct ACTIVE_TASK {
     WORKUNIT* wup;
     APP_VERSION* app_version;
     PROCESS_ID pid;
+#ifdef __linux__
+    int pidfd;
+        // a pidfd for the task's process, or -1.
+        // It becomes readable when the process exits.
+    int numa_node;
+    std::vector<int> placed_cpus;
+        // if numa_node >= 0, the task's processes are bound
+        // to these CPUs in that node (see <numa_placement>)
+    bool in_cgroup;
+        // the task runs in a cgroup of its own (see cgroup.h),
+        // which limits its CPU usage instead of the throttler
+#endif
     PROCINFO procinfo;
 
     // START OF ITEMS SAVED IN TASK STATE FILE
@@ -84,6 +97,9 @@ struct ACTIVE_TASK {
 
     int _task_state;
         // PROCESS_*; see common_defs.h
+    int saved_task_state;
+        // task state as of the last state file write or journal record;
+        // -1 if none
     int slot;
         // subdirectory of slots/ where this runs
     double checkpoint_fraction_done;
@@ -272,6 +288,13 @@ struct ACTIVE_TASK {
     void handle_temporary_exit(bool&, double, const char*, bool);
 
     bool check_max_disk_exceeded();
+#ifdef __linux__
+    void set_cgroup_limits();
+    bool wants_placement();
+    bool choose_placement();
+    void bind_to_placement();
+    void bind_running_task();
+#endif
 
     bool get_app_status_msg();
     bool get_trickle_up_msg();
@@ -302,6 +325,16 @@ class ACTIVE_TASK_SET {
 public:
     typedef std::vector<ACTIVE_TASK*> active_tasks_v;
     active_tasks_v active_tasks;
+    bool exit_pending;
+        // a task process may have exited; check right away
+        // rather than at the next periodic poll
+    double last_exit_time;
+        // when the most recent task exit was handled, or 0.
+        // Used to measure how long it takes to start the next task.
+    ACTIVE_TASK_SET() {
+        exit_pending = false;
+        last_exit_time = 0;
+    }
     ACTIVE_TASK* lookup_pid(int);
     ACTIVE_TASK* lookup_result(RESULT*);
     ACTIVE_TASK* lookup_slot(int);
@@ -317,6 +350,13 @@ public:
     int abort_project(PROJECT*);
     void get_msgs();
     bool check_app_exited();
+#ifdef __linux__
+    void place_unplaced_tasks();
+#endif
+#ifndef _WIN32
+    void get_fdset(FDSET_GROUP&);
+    bool got_select(FDSET_GROUP&);
+#endif
     bool check_rsc_limits_exceeded();
     bool check_quit_timeout_exceeded();
     bool is_slot_in_use(int);
@@ -87,10 +87,19 @@ bool ACTIVE_TASK_SET::poll() {
     bool action;
     unsigned int i;
     static double last_time = 0;
-    if (!gstate.clock_change && gstate.now - last_time < TASK_POLL_PERIOD) return false;
+
+    // if we were told that a process exited, handle it now,
+    // so that its CPUs can be reused in this pass of the main loop
+    //
+    action = false;
+    if (exit_pending) {
+        exit_pending = false;
+        action = check_app_exited();
+    }
+    if (!gstate.clock_change && gstate.now - last_time < TASK_POLL_PERIOD) return action;
     last_time = gstate.now;
 
-    action = check_app_exited();
+    action |= check_app_exited();
     send_heartbeats();
     send_trickle_downs();
     process_control_poll();
@@ -203,6 +212,7 @@ int ACTIVE_TASK::request_exit() {
     if (app_client_shm.shm) {
         process_control_queue.msg_queue_send(
             "<quit/>",
+            app_client_shm,
             app_client_shm.shm->process_control_request
         );
     }
@@ -221,6 +231,7 @@ int ACTIVE_TASK::request_abort() {
     if (app_client_shm.shm) {
         process_control_queue.msg_queue_send(
             "<abort/>",
+            app_client_shm,
             app_client_shm.shm->process_control_request
         );
     }
@@ -613,6 +624,7 @@ void ACTIVE_TASK::handle_exited_app(int stat) {
         clear_schedule_backoffs(this);
             // clear scheduling backoffs of jobs waiting for GPU
     }
+    gstate.active_tasks.last_exit_time = dtime();
     gstate.request_schedule_cpus("application exited");
     gstate.request_work_fetch("application exited");
 }
@@ -689,12 +701,16 @@ void ACTIVE_TASK_SET::send_trickle_downs() {
         if (!atp->process_exists()) continue;
         if (atp->have_trickle_down) {
             if (!atp->app_client_shm.shm) continue;
-            sent = atp->app_client_shm.shm->trickle_down.send_msg("<have_trickle_down/>\n");
+            sent = atp->app_client_shm.send_msg(
+                atp->app_client_shm.shm->trickle_down, "<have_trickle_down/>\n"
+            );
             if (sent) atp->have_trickle_down = false;
         }
         if (atp->send_upload_file_status) {
             if (!atp->app_client_shm.shm) continue;
-            sent = atp->app_client_shm.shm->trickle_down.send_msg("<upload_file_status/>\n");
+            sent = atp->app_client_shm.send_msg(
+                atp->app_client_shm.shm->trickle_down, "<upload_file_status/>\n"
+            );
             if (sent) atp->send_upload_file_status = false;
        }
     }
@@ -718,7 +734,9 @@ void ACTIVE_TASK_SET::send_heartbeats() {
         if (gstate.network_suspended) {
             safe_strcat(buf, "<network_suspended/>");
         }
-        bool sent = atp->app_client_shm.shm->heartbeat.send_msg(buf);
+        bool sent = atp->app_client_shm.send_msg(
+            atp->app_client_shm.shm->heartbeat, buf
+        );
         if (log_flags.heartbeat_debug) {
             if (sent) {
                 msg_printf(atp->result->project, MSG_INFO,
@@ -758,6 +776,7 @@ void ACTIVE_TASK_SET::process_control_poll() {
             atp->kill_running_task(true);
         } else {
             atp->process_control_queue.msg_queue_poll(
+                atp->app_client_shm,
                 atp->app_client_shm.shm->process_control_request
             );
         }
@@ -805,7 +824,10 @@ bool ACTIVE_TASK_SET::check_app_exited() {
 #else
     int pid, stat;
 
-    if ((pid = waitpid(-1, &stat, WNOHANG)) > 0) {
+    // reap all exited processes, not just one;
+    // several tasks may finish between polls
+    //
+    while ((pid = waitpid(-1, &stat, WNOHANG)) > 0) {
         atp = lookup_pid(pid);
         if (!atp) {
             // if we're running benchmarks, exited process
@@ -816,16 +838,54 @@ bool ACTIVE_TASK_SET::check_app_exited() {
                     "Process %d not found\n", pid
                 );
             }
-            return false;
+            continue;
         }
         atp->handle_exited_app(stat);
         found = true;
     }
+#ifdef __linux__
+    if (found) {
+        place_unplaced_tasks();
+    }
+#endif
 #endif
 
     return found;
 }
 
+#ifndef _WIN32
+// add the pidfds of running tasks to the select() read set
+//
+void ACTIVE_TASK_SET::get_fdset(FDSET_GROUP& fg) {
+#ifdef __linux__
+    for (unsigned int i=0; i<active_tasks.size(); i++) {
+        int fd = active_tasks[i]->pidfd;
+        if (fd < 0 || fd >= FD_SETSIZE) continue;
+        FD_SET(fd, &fg.read_fds);
+        if (fd > fg.max_fd) fg.max_fd = fd;
+    }
+#endif
+}
+
+// if a task's pidfd is readable, its process has exited.
+// Set exit_pending and return true.
+//
+bool ACTIVE_TASK_SET::got_select(FDSET_GROUP& fg) {
+    bool found = false;
+#ifdef __linux__
+    for (unsigned int i=0; i<active_tasks.size(); i++) {
+        int fd = active_tasks[i]->pidfd;
+        if (fd < 0 || fd >= FD_SETSIZE) continue;
+        if (FD_ISSET(fd, &fg.read_fds)) {
+            found = true;
+        }
+    }
+    if (found) exit_pending = true;
+#endif
+    return found;
+}
+#endif
+
 // if an app has exceeded its maximum disk usage, abort it
 //
 bool ACTIVE_TASK::check_max_disk_exceeded() {
@@ -1031,6 +1091,7 @@ int ACTIVE_TASK::request_reread_prefs() {
 #if 0
     graphics_request_queue.msg_queue_send(
         xml_graphics_modes[MODE_REREAD_PREFS],
+        app_client_shm,
         app_client_shm.shm->graphics_request
     );
 #endif
@@ -1047,6 +1108,7 @@ int ACTIVE_TASK::request_reread_app_info() {
     if (retval) return retval;
     process_control_queue.msg_queue_send(
         "<reread_app_info/>",
+        app_client_shm,
         app_client_shm.shm->process_control_request
     );
     return 0;
@@ -1333,6 +1395,7 @@ int ACTIVE_TASK::suspend() {
     if (n == 0) {
         process_control_queue.msg_queue_send(
             "<suspend/>",
+            app_client_shm,
             app_client_shm.shm->process_control_request
         );
     }
@@ -1358,6 +1421,7 @@ int ACTIVE_TASK::unsuspend(int reason) {
     if (n == 0) {
         process_control_queue.msg_queue_send(
             "<resume/>",
+            app_client_shm,
             app_client_shm.shm->process_control_request
         );
     }
@@ -1369,6 +1433,7 @@ void ACTIVE_TASK::send_network_available() {
     if (!app_client_shm.shm) return;
     process_control_queue.msg_queue_send(
         "<network_available/>",
+        app_client_shm,
         app_client_shm.shm->process_control_request
     );
     return;
@@ -1391,9 +1456,15 @@ bool ACTIVE_TASK::get_app_status_msg() {
         );
         return false;
     }
-    if (!app_client_shm.shm->app_status.get_msg(msg_buf)) {
+    if (!app_client_shm.get_msg(app_client_shm.shm->app_status, msg_buf)) {
         return false;
     }
+
+    // if several status messages are queued in the ring,
+    // each supersedes the previous one; use the latest
+    //
+    while (app_client_shm.get_msg(app_client_shm.shm->app_status, msg_buf)) {
+    }
     if (log_flags.app_msg_receive) {
         msg_printf(this->wup->project, MSG_INFO,
             "[app_msg_receive] got msg from slot %d: %s", slot, msg_buf
@@ -1488,7 +1559,7 @@ bool ACTIVE_TASK::get_trickle_up_msg() {
     int retval;
 
     if (!app_client_shm.shm) return false;
-    if (app_client_shm.shm->trickle_up.get_msg(msg_buf)) {
+    if (app_client_shm.get_msg(app_client_shm.shm->trickle_up, msg_buf)) {
         if (match_tag(msg_buf, "<have_new_trickle_up/>")) {
             if (log_flags.app_msg_receive) {
                 msg_printf(NULL, MSG_INFO,
@@ -80,6 +80,7 @@ void ACTIVE_TASK::request_graphics_mode(GRAPHICS_MSG& m) {
     }
     graphics_request_queue.msg_queue_send(
         buf,
+        app_client_shm,
         app_client_shm.shm->graphics_request
     );
 }
@@ -122,6 +123,7 @@ void ACTIVE_TASK_SET::graphics_poll() {
         atp = active_tasks[i];
         if (!atp->process_exists()) continue;
         atp->graphics_request_queue.msg_queue_poll(
+            atp->app_client_shm,
             atp->app_client_shm.shm->graphics_request
         );
         atp->check_graphics_mode_ack();
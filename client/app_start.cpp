@@ -43,6 +43,12 @@
 #include <cerrno>
 #include <sys/stat.h>
 #include <string>
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
 #endif
 
 #ifdef __EMX__
@@ -53,6 +59,7 @@
 #include <fcntl.h>
 #endif
 
+#include <cmath>
 #include <vector>
 
 using std::vector;
@@ -61,12 +68,14 @@ using std::string;
 #include "base64.h"
 #include "error_numbers.h"
 #include "filesys.h"
+#include "proc_control.h"
 #include "shmem.h"
 #include "str_replace.h"
 #include "str_util.h"
 #include "util.h"
 
 #include "async_file.h"
+#include "cgroup.h"
 #include "client_msgs.h"
 #include "client_state.h"
 #include "file_names.h"
@@ -268,6 +277,7 @@ void ACTIVE_TASK::init_app_init_data(APP_INIT_DATA& aid) {
 #else
     aid.shmem_seg_name = shmem_seg_name;
 #endif
+    aid.msg_ring_version = MSG_RING_VERSION;
     aid.wu_cpu_time = checkpoint_cpu_time;
     APP_VERSION* avp = app_version;
     for (unsigned int i=0; i<avp->app_files.size(); i++) {
@@ -357,9 +367,31 @@ bool ACTIVE_TASK::must_copy_file(FILE_REF& fref, bool is_io_file) {
     return false;
 }
 
+// counts for the slot setup message (<slot_debug>)
+//
+static int slot_files_copied, slot_files_linked;
+static double slot_bytes_copied;
+
+#ifndef _WIN32
+// hard-link an input file into the slot dir (<hard_link_input_files>).
+// Make the file read-only, so that the app can't change
+// the project's copy through the link.
+//
+static int link_input_file(const char* path, const char* link_path) {
+    struct stat sbuf;
+    if (stat(path, &sbuf)) return ERR_STAT;
+    if (sbuf.st_mode & 0222) {
+        if (chmod(path, sbuf.st_mode & ~0222)) return ERR_CHMOD;
+    }
+    if (link(path, link_path)) return ERR_SYMLINK;
+    return 0;
+}
+#endif
+
 // set up a file reference, given a slot dir and project dir.
 // This means:
 // 1) copy the file to slot dir, if reference is by copy
+//    (or hard-link it, if <hard_link_input_files> is set)
 // 2) else make a soft link
 //
 int ACTIVE_TASK::setup_file(
@@ -403,7 +435,30 @@ int ACTIVE_TASK::setup_file(
             if (boinc_file_exists(link_path)) {
                 return 0;
             }
+#ifndef _WIN32
+            if (cc_config.hard_link_input_files) {
+                retval = link_input_file(file_path, link_path);
+                if (!retval) {
+                    slot_files_linked++;
+                    return 0;
+                }
+                if (log_flags.slot_debug) {
+                    msg_printf(project, MSG_INFO,
+                        "[slot] can't hard-link %s: %s; copying it",
+                        file_path, boincerror(retval)
+                    );
+                }
+            }
+#endif
             if (fip->nbytes > ASYNC_FILE_THRESHOLD) {
+                // a reflink takes no time; if we can't make one,
+                // copy the file in the background
+                //
+                if (!boinc_reflink(file_path, link_path)) {
+                    slot_files_copied++;
+                    slot_bytes_copied += fip->nbytes;
+                    return fip->set_permissions(link_path);
+                }
                 ASYNC_COPY* ac = new ASYNC_COPY;
                 retval = ac->init(this, fip, file_path, link_path);
                 if (retval) return retval;
@@ -419,6 +474,8 @@ int ACTIVE_TASK::setup_file(
                 }
                 retval = fip->set_permissions(link_path);
                 if (retval) return retval;
+                slot_files_copied++;
+                slot_bytes_copied += fip->nbytes;
             }
         }
         return 0;
@@ -520,6 +577,186 @@ static int get_priority(bool is_high_priority) {
 #endif
 }
 
+#ifdef __linux__
+
+// NUMA placement (<numa_placement> in cc_config.xml).
+// On hosts with more than one NUMA node, each CPU-intensive task
+// (all the threads of a multithread task together)
+// is bound to CPUs in a single node,
+// and its memory is allocated from that node if possible.
+// This avoids remote memory access, and keeps the kernel from
+// moving tasks between nodes and away from their memory.
+
+// should this task be placed?
+//
+bool ACTIVE_TASK::wants_placement() {
+    if (!cc_config.numa_placement) return false;
+    if (gstate.host_info.numa_nodes.size() < 2) return false;
+    if (result->non_cpu_intensive()) return false;
+    if (result->uses_gpu()) return false;
+    return true;
+}
+
+// choose CPUs for the task: ceil(avg_ncpus) of them,
+// not used by any other placed task, all in one node.
+// Of the nodes with room, use the one with the most free CPUs,
+// so that tasks (and their memory traffic) are spread over the nodes.
+// Within the node use the first free CPUs in numa_nodes order,
+// which lists one CPU of each physical core before any siblings,
+// so this fills physical cores before their hyperthreads.
+//
+// CPUs of tasks that are preempted but still in memory stay reserved,
+// so that they don't compete with new tasks when they resume.
+//
+// Return false if no node has room; the task then runs unbound,
+// and we try again when another task exits.
+//
+bool ACTIVE_TASK::choose_placement() {
+    vector<vector<int> >& nodes = gstate.host_info.numa_nodes;
+    vector<int> used;
+    unsigned int i, j;
+
+    numa_node = -1;
+    placed_cpus.clear();
+    for (i=0; i<gstate.active_tasks.active_tasks.size(); i++) {
+        ACTIVE_TASK* atp = gstate.active_tasks.active_tasks[i];
+        if (atp == this) continue;
+        if (atp->numa_node < 0) continue;
+        if (!atp->process_exists()) continue;
+        for (j=0; j<atp->placed_cpus.size(); j++) {
+            int cpu = atp->placed_cpus[j];
+            if ((int)used.size() <= cpu) used.resize(cpu+1, 0);
+            used[cpu]++;
+        }
+    }
+
+    int n = (int)ceil(app_version->avg_ncpus);
+    if (n < 1) n = 1;
+    int best = -1, best_nfree = 0;
+    for (i=0; i<nodes.size(); i++) {
+        int nfree = 0;
+        for (j=0; j<nodes[i].size(); j++) {
+            int cpu = nodes[i][j];
+            if (cpu >= (int)used.size() || !used[cpu]) nfree++;
+        }
+        if (nfree >= n && nfree > best_nfree) {
+            best = i;
+            best_nfree = nfree;
+        }
+    }
+    if (best < 0) {
+        if (log_flags.task_debug) {
+            msg_printf(wup->project, MSG_INFO,
+                "[task] no NUMA node has %d free CPUs for %s",
+                n, result->name
+            );
+        }
+        return false;
+    }
+    for (j=0; j<nodes[best].size(); j++) {
+        int cpu = nodes[best][j];
+        if (cpu >= (int)used.size() || !used[cpu]) {
+            placed_cpus.push_back(cpu);
+            if ((int)placed_cpus.size() == n) break;
+        }
+    }
+    numa_node = best;
+    if (log_flags.task_debug) {
+        char buf[256], cpu[16];
+        buf[0] = 0;
+        for (j=0; j<placed_cpus.size(); j++) {
+            snprintf(cpu, sizeof(cpu), "%s%d", j?",":"", placed_cpus[j]);
+            safe_strcat(buf, cpu);
+        }
+        msg_printf(wup->project, MSG_INFO,
+            "[task] placing %s on NUMA node %d, CPUs %s",
+            result->name, numa_node, buf
+        );
+    }
+    return true;
+}
+
+static void placement_cpu_set(vector<int>& cpus, cpu_set_t& s) {
+    CPU_ZERO(&s);
+    for (unsigned int i=0; i<cpus.size(); i++) {
+        if (cpus[i] < CPU_SETSIZE) CPU_SET(cpus[i], &s);
+    }
+}
+
+// bind the calling process to the task's CPUs,
+// and have it prefer its node's memory.
+// Called in the child process between fork() and exec();
+// both settings are inherited across exec() and by the app's threads.
+//
+void ACTIVE_TASK::bind_to_placement() {
+    cpu_set_t s;
+    placement_cpu_set(placed_cpus, s);
+    if (sched_setaffinity(0, sizeof(s), &s)) {
+        perror("sched_setaffinity");
+    }
+#ifdef SYS_set_mempolicy
+    unsigned long mask[1024/(8*sizeof(unsigned long))];
+    memset(mask, 0, sizeof(mask));
+    mask[numa_node/(8*sizeof(unsigned long))] |=
+        1UL << (numa_node%(8*sizeof(unsigned long)));
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, 1024)) {
+        perror("set_mempolicy");
+    }
+#endif
+}
+
+// bind all threads of a running task, and of its descendants,
+// to the task's CPUs.
+// The memory policy of a running process can't be changed from outside,
+// but its threads now run on the node, so new memory
+// (which by default comes from the local node) is allocated there.
+//
+void ACTIVE_TASK::bind_running_task() {
+    char path[MAXPATHLEN];
+    cpu_set_t s;
+    vector<int> pids;
+
+    placement_cpu_set(placed_cpus, s);
+    get_descendants(pid, pids);
+    pids.push_back(pid);
+    for (unsigned int i=0; i<pids.size(); i++) {
+        snprintf(path, sizeof(path), "/proc/%d/task", pids[i]);
+        DIR* d = opendir(path);
+        if (!d) continue;
+        dirent* de;
+        while ((de = readdir(d))) {
+            int tid = atoi(de->d_name);
+            if (tid <= 0) continue;
+            if (sched_setaffinity(tid, sizeof(s), &s) && log_flags.task_debug) {
+                msg_printf(wup->project, MSG_INFO,
+                    "[task] can't set CPU affinity of %s thread %d: %s",
+                    result->name, tid, strerror(errno)
+                );
+            }
+        }
+        closedir(d);
+    }
+}
+
+// Called when tasks have exited, freeing CPUs.
+// Place running tasks that didn't fit when they started.
+// This is done before the scheduler starts new tasks,
+// so tasks that are already running get first pick.
+//
+void ACTIVE_TASK_SET::place_unplaced_tasks() {
+    for (unsigned int i=0; i<active_tasks.size(); i++) {
+        ACTIVE_TASK* atp = active_tasks[i];
+        if (atp->numa_node >= 0) continue;
+        if (atp->task_state() != PROCESS_EXECUTING) continue;
+        if (!atp->wants_placement()) continue;
+        if (atp->choose_placement()) {
+            atp->bind_running_task();
+        }
+    }
+}
+
+#endif
+
 // Start a task in a slot directory.
 // This includes setting up soft links,
 // passing preferences, and starting the process
@@ -543,6 +780,7 @@ int ACTIVE_TASK::start(bool test) {
     FILE_INFO* fip;
     int retval;
     APP_INIT_DATA aid;
+    double setup_start;
 #ifdef _WIN32
     bool success = false;
     LPVOID environment_block=NULL;
@@ -616,6 +854,10 @@ int ACTIVE_TASK::start(bool test) {
 
     // set up applications files
     //
+    setup_start = dtime();
+    slot_files_copied = 0;
+    slot_files_linked = 0;
+    slot_bytes_copied = 0;
     if (test) {
         safe_strcpy(exec_name, "test_app");
         safe_strcpy(exec_path, "test_app");
@@ -685,6 +927,14 @@ int ACTIVE_TASK::start(bool test) {
     link_user_files();
         // don't check retval here
 
+    if (log_flags.slot_debug) {
+        msg_printf(wup->project, MSG_INFO,
+            "[slot] set up slot %d for %s in %.3f sec: copied %d files (%.2f MB), hard-linked %d",
+            slot, result->name, dtime() - setup_start,
+            slot_files_copied, slot_bytes_copied/MEGA, slot_files_linked
+        );
+    }
+
     // remove temporary exit file from last run
     //
     snprintf(file_path, sizeof(file_path), "%s/%s", slot_dir, TEMPORARY_EXIT_FILE);
@@ -986,6 +1236,19 @@ int ACTIVE_TASK::start(bool test) {
         set_task_state(PROCESS_EXECUTING, "start");
         return 0;
     }
+#ifdef __linux__
+    in_cgroup = false;
+    if (cgroups.enabled) {
+        retval = cgroups.setup_slot(slot);
+        if (!retval) {
+            in_cgroup = true;
+            set_cgroup_limits();
+        }
+    }
+    if (wants_placement()) {
+        choose_placement();
+    }
+#endif
     pid = fork();
     if (pid == -1) {
         snprintf(buf, sizeof(buf), "fork() failed: %s", strerror(errno));
@@ -1037,6 +1300,15 @@ int ACTIVE_TASK::start(bool test) {
         setenv("DYLD_LIBRARY_PATH", libpath, 1);
 #endif
 
+#ifdef __linux__
+        if (in_cgroup && cgroups.join_slot(slot)) {
+            perror("join cgroup");
+        }
+        if (numa_node >= 0) {
+            bind_to_placement();
+        }
+#endif
+
         retval = chdir(slot_dir);
         if (retval) {
             perror("chdir");
@@ -1149,6 +1421,14 @@ int ACTIVE_TASK::start(bool test) {
         );
     }
 
+#if defined(__linux__) && defined(SYS_pidfd_open)
+    // get a descriptor that becomes readable when the process exits,
+    // so that the main loop can react without waiting for a poll.
+    // Needs Linux 5.3; if we don't get one, the SIGCHLD wakeup
+    // and the periodic waitpid() still find the exit.
+    //
+    pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+#endif
 #endif
     set_task_state(PROCESS_EXECUTING, "start");
     return 0;
@@ -1194,6 +1474,16 @@ int ACTIVE_TASK::resume_or_start(bool first_time) {
             set_task_state(PROCESS_COULDNT_START, "resume_or_start1");
             return retval;
         }
+        if (gstate.active_tasks.last_exit_time) {
+            if (log_flags.task_debug) {
+                msg_printf(result->project, MSG_INFO,
+                    "[task] task %s started %.3f sec after last task exit",
+                    result->name,
+                    dtime() - gstate.active_tasks.last_exit_time
+                );
+            }
+            gstate.active_tasks.last_exit_time = 0;
+        }
         break;
     case PROCESS_SUSPENDED:
         retval = unsuspend();
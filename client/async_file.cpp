@@ -20,11 +20,18 @@
 // in the client's polling loop,
 // so that the client continues to respond to GUI RPCs
 // and the manager won't freeze.
+// Verifies are normally done by worker threads instead (see async_file.h).
 
 #ifdef _WIN32
 #include "boinc_win.h"
 #else
+#include <cerrno>
+#include <cstdlib>
 #include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #endif
 
 #include "crypt.h"
@@ -36,6 +43,7 @@
 #include "app.h"
 #include "client_msgs.h"
 #include "client_state.h"
+#include "content_store.h"
 #include "project.h"
 #include "sandbox.h"
 
@@ -47,6 +55,17 @@ vector<ASYNC_VERIFY*> async_verifies;
 vector<ASYNC_COPY*> async_copies;
 
 #define BUFSIZE (64*1024)
+#define THREAD_BUFSIZE (1024*1024)
+    // worker threads read in bigger pieces
+#define COPY_RANGE_CHUNK (8*1024*1024)
+    // copies done by the kernel (copy_file_range()) use bigger pieces too
+
+THREAD_LOCK async_verify_lock;
+static bool verify_threads_failed = false;
+
+static inline bool use_verify_threads() {
+    return cc_config.max_async_verifies > 0 && !verify_threads_failed;
+}
 
 // set up an async copy operation.
 //
@@ -89,6 +108,7 @@ int ASYNC_COPY::init(
 
 ASYNC_COPY::ASYNC_COPY() {
     in = out = NULL;
+    use_copy_range = true;
     atp = NULL;
     fip = NULL;
     safe_strcpy(to_path, "");
@@ -103,13 +123,33 @@ ASYNC_COPY::~ASYNC_COPY() {
     }
 }
 
-// copy a 64KB chunk.
+// copy a chunk (64KB, or up to 8MB if the kernel does the copy).
 // return nonzero if we're done (success or fail)
 //
 int ASYNC_COPY::copy_chunk() {
     unsigned char buf[BUFSIZE];
     int retval;
 
+#if defined(__linux__) && defined(SYS_copy_file_range)
+    // have the kernel do the copy if it can.
+    // Neither stream has buffered anything,
+    // so if it can't we continue with fread()/fwrite()
+    // from the current file offsets.
+    //
+    if (use_copy_range) {
+        ssize_t nr = syscall(SYS_copy_file_range,
+            fileno(in), NULL, fileno(out), NULL, COPY_RANGE_CHUNK, 0
+        );
+        if (nr > 0) return 0;
+        if (nr < 0 && errno != EXDEV && errno != ENOSYS && errno != EINVAL
+            && errno != EOPNOTSUPP && errno != EBADF
+        ) {
+            error(ERR_FWRITE);
+            return 1;
+        }
+        use_copy_range = false;
+    }
+#endif
     size_t n = fread(buf, 1, BUFSIZE, in);
     if (n == 0) {
         // copy done.  rename temp file
@@ -196,7 +236,6 @@ int ASYNC_VERIFY::init(FILE_INFO* _fip) {
         out = boinc_temp_file(dir, "verify", temp_path);
 #endif
         if (!out) {
-            fclose(in);
             return ERR_FOPEN;
         }
 
@@ -204,6 +243,7 @@ int ASYNC_VERIFY::init(FILE_INFO* _fip) {
         gzin = gzopen(inpath, "rb");
         if (gzin == Z_NULL) {
             fclose(out);
+            out = NULL;
             boinc_delete_file(temp_path);
             return ERR_FOPEN;
         }
@@ -255,6 +295,9 @@ void ASYNC_VERIFY::finish() {
     fip->async_verify = NULL;
     fip->status = FILE_PRESENT;
     fip->set_permissions();
+#ifndef _WIN32
+    content_store.add_file(fip);
+#endif
 }
 
 void ASYNC_VERIFY::error(int retval) {
@@ -268,44 +311,117 @@ void ASYNC_VERIFY::error(int retval) {
     fip->status = retval;
 }
 
-int ASYNC_VERIFY::verify_chunk() {
+void ASYNC_VERIFY::close_files() {
+    if (gzin) {
+        gzclose(gzin);
+        gzin = NULL;
+    }
+    if (in) {
+        fclose(in);
+        in = NULL;
+    }
+    if (out) {
+        fclose(out);
+        out = NULL;
+    }
+}
+
+// Read, hash, and possibly decompress up to len bytes.
+// Return 1 if done (set io_retval on error).
+// This doesn't touch client state, so it can run in a worker thread.
+//
+int ASYNC_VERIFY::do_chunk(unsigned char* buf, size_t len) {
     size_t n;
-    unsigned char buf[BUFSIZE];
-    if (fip->download_gzipped) {
-        n = gzread(gzin, buf, BUFSIZE);
-        if (n <=0) {
-            // done
-            //
-            gzclose(gzin);
-            fclose(out);
-            delete_project_owned_file(inpath, true);
-            boinc_rename(temp_path, outpath);
-            finish();
+    if (gzin) {
+        int m = gzread(gzin, buf, (unsigned int)len);
+        if (m <= 0) {
+            return 1;
+        }
+        n = m;
+        if (fwrite(buf, 1, n, out) != n || ferror(out)) {
+            io_retval = ERR_FWRITE;
             return 1;
-        } else {
-            size_t m = fwrite(buf, 1, n, out);
-            if (m != n || ferror(out)) {
-                // write failed
-                //
-                error(ERR_FWRITE);
-                return 1;
-            }
-            md5_append(&md5_state, buf, (int)n);
         }
     } else {
-        n = fread(buf, 1, BUFSIZE, in);
+        n = fread(buf, 1, len, in);
         if (!n || ferror(in)) {
-            fclose(in);
-            finish();
             return 1;
-        } else {
-            md5_append(&md5_state, buf, (int)n);
         }
     }
+    md5_append(&md5_state, buf, (int)n);
+    return 0;
+}
+
+// All the data has been processed; finish up in the main thread
+//
+void ASYNC_VERIFY::io_done() {
+    bool gzipped = (gzin != NULL);
+    close_files();
+    if (io_retval) {
+        if (gzipped) boinc_delete_file(temp_path);
+        error(io_retval);
+        return;
+    }
+    if (gzipped) {
+        delete_project_owned_file(inpath, true);
+        boinc_rename(temp_path, outpath);
+    }
+    finish();
+}
+
+int ASYNC_VERIFY::verify_chunk() {
+    unsigned char buf[BUFSIZE];
+    if (do_chunk(buf, BUFSIZE)) {
+        io_done();
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI verify_thread(void* p) {
+#else
+static void* verify_thread(void* p) {
+#endif
+    THREAD& thread = *((THREAD*)p);
+    ASYNC_VERIFY* avp = (ASYNC_VERIFY*)thread.arg;
+    unsigned char* buf = (unsigned char*)malloc(THREAD_BUFSIZE);
+    if (buf) {
+        while (!avp->do_chunk(buf, THREAD_BUFSIZE)) {
+            async_verify_lock.lock();
+            bool quit = thread.quit_flag;
+            async_verify_lock.unlock();
+            if (quit) break;
+        }
+        free(buf);
+    } else {
+        avp->io_retval = ERR_MALLOC;
+    }
+    async_verify_lock.lock();
+    avp->thread_done = true;
+    async_verify_lock.unlock();
+#ifndef _WIN32
+    // on Windows the main loop just polls
+    gstate.wakeup();
+#endif
     return 0;
 }
 
+// If the verify is being done by a thread,
+// tell the thread to stop, and delete the ASYNC_VERIFY
+// in poll_async_verifies() when it has.
+//
 void remove_async_verify(ASYNC_VERIFY* avp) {
+    async_verify_lock.lock();
+    bool running = avp->thread_running;
+    if (running) {
+        avp->thread.quit_flag = true;
+    }
+    async_verify_lock.unlock();
+    if (running) {
+        avp->fip = NULL;
+        return;
+    }
     vector<ASYNC_VERIFY*>::iterator i = async_verifies.begin();
     while (i != async_verifies.end()) {
         if (*i == avp) {
@@ -314,9 +430,71 @@ void remove_async_verify(ASYNC_VERIFY* avp) {
         }
         ++i;
     }
+    avp->close_files();
     delete avp;
 }
 
+// Handle verifies done by worker threads:
+// finish those whose thread is done, and start new threads.
+// Return true if anything finished.
+//
+bool poll_async_verifies() {
+    bool action = false;
+    int nrunning = 0;
+
+    vector<ASYNC_VERIFY*>::iterator i = async_verifies.begin();
+    while (i != async_verifies.end()) {
+        ASYNC_VERIFY* avp = *i;
+        async_verify_lock.lock();
+        bool running = avp->thread_running;
+        bool done = avp->thread_done;
+        async_verify_lock.unlock();
+        if (!running) {
+            ++i;
+            continue;
+        }
+        if (!done) {
+            nrunning++;
+            ++i;
+            continue;
+        }
+        i = async_verifies.erase(i);
+        if (avp->fip) {
+            avp->io_done();
+        } else {
+            // the file was deleted while we were verifying it
+            //
+            bool gzipped = (avp->gzin != NULL);
+            avp->close_files();
+            if (gzipped) boinc_delete_file(avp->temp_path);
+        }
+        delete avp;
+        action = true;
+    }
+
+    if (!use_verify_threads()) return action;
+    for (i = async_verifies.begin(); i != async_verifies.end(); ++i) {
+        if (nrunning >= cc_config.max_async_verifies) break;
+        ASYNC_VERIFY* avp = *i;
+        if (avp->thread_running) continue;
+        avp->thread_running = true;
+        int retval = avp->thread.run(verify_thread, avp);
+        if (retval) {
+            // fall back to verifying in the main loop
+            //
+            msg_printf(NULL, MSG_INTERNAL_ERROR,
+                "Can't create file verification thread: %s",
+                boincerror(retval)
+            );
+            avp->thread_running = false;
+            verify_threads_failed = true;
+            break;
+        }
+        nrunning++;
+    }
+    return action;
+}
+
 // If there are any async file operations,
 // do a 64KB chunk of the first one and return true.
 //
@@ -332,10 +510,28 @@ void do_async_file_op() {
         }
         return;
     }
-    if (async_verifies.size()) {
-        if (async_verifies[0]->verify_chunk()) {
-            async_verifies.erase(async_verifies.begin());
+    if (use_verify_threads()) return;
+    for (unsigned int i=0; i<async_verifies.size(); i++) {
+        ASYNC_VERIFY* avp = async_verifies[i];
+        if (avp->thread_running) continue;
+        if (avp->verify_chunk()) {
+            async_verifies.erase(async_verifies.begin()+i);
+            delete avp;
         }
+        return;
+    }
+}
+
+// is there an operation for do_async_file_op()?
+// Verifies done by threads don't count;
+// they wake up the main loop when they finish.
+//
+bool have_async_file_op() {
+    if (async_copies.size()) return true;
+    if (use_verify_threads()) return false;
+    for (unsigned int i=0; i<async_verifies.size(); i++) {
+        if (!async_verifies[i]->thread_running) return true;
     }
+    return false;
 }
 
@@ -33,6 +33,8 @@
 #include "filesys.h"
 #include "md5.h"
 
+#include "thread.h"
+
 struct FILE_INFO;
 struct ACTIVE_TASK;
 
@@ -47,6 +49,8 @@ struct ASYNC_COPY {
     FILE_INFO* fip;
     FILE* in, *out;
     char to_path[MAXPATHLEN], temp_path[MAXPATHLEN];
+    bool use_copy_range;
+        // try copy_file_range() (Linux)
 
     ASYNC_COPY();
     ~ASYNC_COPY();
@@ -62,12 +66,28 @@ struct ASYNC_COPY {
 // after it has been downloaded.
 // When done, mark it as present.
 //
+// If cc_config.max_async_verifies is nonzero,
+// the reading, decompressing and hashing are done by a worker thread
+// (up to max_async_verifies of them at once)
+// and the result is handled in the main thread by poll_async_verifies().
+// Otherwise it's done in 64KB chunks by do_async_file_op().
+//
 struct ASYNC_VERIFY {
     FILE_INFO* fip;
+        // NULL if the file was deleted while a thread was verifying it
     md5_state_t md5_state;
     FILE* in, *out;
     gzFile gzin;
     char inpath[MAXPATHLEN], temp_path[MAXPATHLEN], outpath[MAXPATHLEN];
+    int io_retval;
+        // error in reading or writing the file
+
+    // the following are shared with the worker thread;
+    // use async_verify_lock
+    //
+    THREAD thread;
+    bool thread_running;
+    bool thread_done;
 
     ASYNC_VERIFY(){
       fip = NULL;
@@ -77,11 +97,17 @@ struct ASYNC_VERIFY {
       safe_strcpy(inpath, "");
       safe_strcpy(temp_path, "");
       safe_strcpy(outpath, "");
+      io_retval = 0;
+      thread_running = false;
+      thread_done = false;
     };
     ~ASYNC_VERIFY(){};
 
     int init(FILE_INFO*);
     int verify_chunk();
+    int do_chunk(unsigned char* buf, size_t len);
+    void io_done();
+    void close_files();
     void finish();
     void error(int);
 };
@@ -91,9 +117,8 @@ extern std::vector<ASYNC_COPY*> async_copies;
 
 extern void remove_async_copy(ASYNC_COPY*);
 extern void remove_async_verify(ASYNC_VERIFY*);
-inline bool have_async_file_op() {
-    return (async_verifies.size() || async_copies.size());
-}
+extern bool have_async_file_op();
 extern void do_async_file_op();
+extern bool poll_async_verifies();
 
 #endif
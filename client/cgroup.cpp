@@ -0,0 +1,265 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+// Linux cgroup-v2 control of running tasks; see cgroup.h
+
+#include "config.h"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "error_numbers.h"
+#include "str_replace.h"
+#include "str_util.h"
+
+#include "client_msgs.h"
+
+#include "cgroup.h"
+
+CGROUPS cgroups;
+
+// write a string to a cgroup control file.
+// This is called in the child process before exec(),
+// so don't use stdio.
+//
+static int write_cgroup_file(const char* path, const char* val) {
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) return ERR_OPEN;
+    ssize_t n = write(fd, val, strlen(val));
+    close(fd);
+    if (n < 0) return ERR_WRITE;
+    return 0;
+}
+
+// find where the cgroup v2 hierarchy is mounted
+// (usually /sys/fs/cgroup; /sys/fs/cgroup/unified on hybrid systems)
+//
+static int get_cgroup2_mount(char* dir, int len) {
+    char buf[1024], dev[256], mnt[MAXPATHLEN], type[64];
+    FILE* f = fopen("/proc/mounts", "r");
+    if (!f) return ERR_FOPEN;
+    int retval = ERR_NOT_FOUND;
+    while (fgets(buf, sizeof(buf), f)) {
+        if (sscanf(buf, "%255s %4095s %63s", dev, mnt, type) != 3) continue;
+        if (!strcmp(type, "cgroup2")) {
+            strlcpy(dir, mnt, len);
+            retval = 0;
+            break;
+        }
+    }
+    fclose(f);
+    return retval;
+}
+
+// find our cgroup, move ourselves into a leaf of it,
+// and enable the cpu and memory controllers for the slot cgroups
+//
+int CGROUPS::init() {
+    char buf[1024], path[MAXPATHLEN], cg[512], mnt[MAXPATHLEN];
+    int retval;
+
+    retval = get_cgroup2_mount(mnt, sizeof(mnt));
+    if (retval) {
+        msg_printf(NULL, MSG_INFO, "cgroups: cgroup v2 not found");
+        return retval;
+    }
+    cg[0] = 0;
+    FILE* f = fopen("/proc/self/cgroup", "r");
+    if (!f) return ERR_FOPEN;
+    while (fgets(buf, sizeof(buf), f)) {
+        if (!strncmp(buf, "0::", 3)) {
+            safe_strcpy(cg, buf+3);
+            strip_whitespace(cg);
+            break;
+        }
+    }
+    fclose(f);
+    if (!strlen(cg)) {
+        msg_printf(NULL, MSG_INFO, "cgroups: cgroup v2 not found");
+        return ERR_NOT_FOUND;
+    }
+
+    // if an earlier instance of the client moved itself to the leaf
+    // and we inherited that, use the parent
+    //
+    char* p = strrchr(cg, '/');
+    if (p && !strcmp(p+1, "boinc_client")) *p = 0;
+    if (!strlen(cg) || !strcmp(cg, "/")) {
+        msg_printf(NULL, MSG_INFO,
+            "cgroups: client is in the root cgroup; not using cgroups"
+        );
+        return ERR_NOT_FOUND;
+    }
+    if (snprintf(root, sizeof(root), "%s%s", mnt, cg) >= (int)sizeof(root)) {
+        root[0] = 0;
+        msg_printf(NULL, MSG_INFO,
+            "cgroups: cgroup path too long; not using cgroups"
+        );
+        return ERR_BUFFER_OVERFLOW;
+    }
+
+    // a cgroup with controllers enabled for its children
+    // can't contain processes itself
+    //
+    snprintf(path, sizeof(path), "%s/boinc_client", root);
+    if (mkdir(path, 0755) && errno != EEXIST) {
+        msg_printf(NULL, MSG_INFO,
+            "cgroups: can't create %s: %s", path, strerror(errno)
+        );
+        return ERR_MKDIR;
+    }
+    snprintf(path, sizeof(path), "%s/boinc_client/cgroup.procs", root);
+    snprintf(buf, sizeof(buf), "%d", getpid());
+    retval = write_cgroup_file(path, buf);
+    if (retval) {
+        msg_printf(NULL, MSG_INFO,
+            "cgroups: can't move client to %s: %s", path, strerror(errno)
+        );
+        return retval;
+    }
+    snprintf(path, sizeof(path), "%s/cgroup.subtree_control", root);
+    retval = write_cgroup_file(path, "+cpu +memory");
+    if (retval) {
+        msg_printf(NULL, MSG_INFO,
+            "cgroups: can't enable cpu and memory controllers in %s: %s",
+            root, strerror(errno)
+        );
+        return retval;
+    }
+    enabled = true;
+    msg_printf(NULL, MSG_INFO, "Running tasks in cgroups under %s", root);
+    return 0;
+}
+
+void CGROUPS::slot_path(int slot, const char* file, char* path, int len) {
+    snprintf(path, len, "%s/slot_%d/%s", root, slot, file);
+}
+
+// create the cgroup for a slot, if it's not there already
+//
+int CGROUPS::setup_slot(int slot) {
+    char path[MAXPATHLEN];
+    snprintf(path, sizeof(path), "%s/slot_%d", root, slot);
+    if (mkdir(path, 0755) && errno != EEXIST) {
+        msg_printf(NULL, MSG_INTERNAL_ERROR,
+            "cgroups: can't create %s: %s", path, strerror(errno)
+        );
+        return ERR_MKDIR;
+    }
+    limits.erase(slot);
+    return 0;
+}
+
+// move the calling process to the slot's cgroup.
+// Called in the child process between fork() and exec().
+//
+int CGROUPS::join_slot(int slot) {
+    char path[MAXPATHLEN], buf[64];
+    slot_path(slot, "cgroup.procs", path, sizeof(path));
+    snprintf(buf, sizeof(buf), "%d", getpid());
+    return write_cgroup_file(path, buf);
+}
+
+// remove the slot's cgroup after its task has exited.
+// This fails if processes are left in it;
+// setup_slot() will reuse it in that case.
+//
+void CGROUPS::remove_slot(int slot) {
+    char path[MAXPATHLEN];
+    snprintf(path, sizeof(path), "%s/slot_%d", root, slot);
+    rmdir(path);
+    limits.erase(slot);
+}
+
+// set the slot's CPU limit (in CPUs; 0 = none)
+// and RAM limit (in bytes; 0 = none)
+//
+int CGROUPS::set_limits(int slot, double ncpus, double ram) {
+    char path[MAXPATHLEN], buf[256];
+    int retval;
+
+    std::map<int, std::pair<double, double> >::iterator i = limits.find(slot);
+    if (i != limits.end() && i->second.first == ncpus && i->second.second == ram) {
+        return 0;
+    }
+    if (ncpus > 0) {
+        double quota = ncpus*CGROUP_CPU_PERIOD;
+        if (quota < 1000) quota = 1000;     // kernel minimum
+        snprintf(buf, sizeof(buf), "%.0f %d", quota, CGROUP_CPU_PERIOD);
+    } else {
+        snprintf(buf, sizeof(buf), "max %d", CGROUP_CPU_PERIOD);
+    }
+    slot_path(slot, "cpu.max", path, sizeof(path));
+    retval = write_cgroup_file(path, buf);
+    if (retval) return retval;
+    if (ram > 0) {
+        snprintf(buf, sizeof(buf), "%.0f", ram);
+    } else {
+        safe_strcpy(buf, "max");
+    }
+    slot_path(slot, "memory.high", path, sizeof(path));
+    retval = write_cgroup_file(path, buf);
+    if (retval) return retval;
+    limits[slot] = std::make_pair(ncpus, ram);
+    return 0;
+}
+
+// get the CPU time and working set of the slot's processes,
+// including exited ones for CPU time
+//
+int CGROUPS::get_usage(int slot, PROCINFO& pi) {
+    char path[MAXPATHLEN], buf[256], name[64];
+    double x, user = -1, system = -1, anon = -1, file_mapped = -1;
+
+    slot_path(slot, "cpu.stat", path, sizeof(path));
+    FILE* f = fopen(path, "r");
+    if (!f) return ERR_FOPEN;
+    while (fgets(buf, sizeof(buf), f)) {
+        if (sscanf(buf, "%63s %lf", name, &x) != 2) continue;
+        if (!strcmp(name, "user_usec")) user = x;
+        if (!strcmp(name, "system_usec")) system = x;
+    }
+    fclose(f);
+
+    slot_path(slot, "memory.stat", path, sizeof(path));
+    f = fopen(path, "r");
+    if (!f) return ERR_FOPEN;
+    while (fgets(buf, sizeof(buf), f)) {
+        if (sscanf(buf, "%63s %lf", name, &x) != 2) continue;
+        if (!strcmp(name, "anon")) anon = x;
+        if (!strcmp(name, "file_mapped")) file_mapped = x;
+    }
+    fclose(f);
+
+    if (user < 0 || system < 0 || anon < 0 || file_mapped < 0) {
+        return ERR_NOT_FOUND;
+    }
+    pi.user_time = user/1e6;
+    pi.kernel_time = system/1e6;
+    pi.working_set_size = anon + file_mapped;
+    return 0;
+}
+
+#endif
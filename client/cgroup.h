@@ -0,0 +1,66 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOINC_CGROUP_H
+#define BOINC_CGROUP_H
+
+// Linux cgroup-v2 control of running tasks (<use_cgroups> in cc_config.xml).
+//
+// The client must be given a cgroup of its own
+// (e.g. a systemd service with Delegate=yes).
+// Within it, the client moves itself to a leaf "boinc_client",
+// and runs each task in a cgroup "slot_N" (N = slot number).
+// For each slot we set
+//  cpu.max: the CPU usage limit (instead of suspending and resuming
+//      the task to throttle it)
+//  memory.high: the RAM limit; the kernel slows the task down
+//      by reclaiming its memory rather than letting it go over
+// and we read the task's CPU time and working set
+// from cpu.stat and memory.stat.
+
+#include <map>
+#include <utility>
+
+#include "procinfo.h"
+
+#define CGROUP_CPU_PERIOD   100000
+    // cpu.max period, usec
+
+struct CGROUPS {
+    bool enabled;
+    char root[MAXPATHLEN];
+        // the client's cgroup directory, e.g.
+        // /sys/fs/cgroup/system.slice/boinc-client.service
+    std::map<int, std::pair<double, double> > limits;
+        // slot -> (ncpus, RAM) last written, so we write only changes
+
+    CGROUPS() {
+        enabled = false;
+        root[0] = 0;
+    }
+    int init();
+    void slot_path(int slot, const char* file, char* path, int len);
+    int setup_slot(int slot);
+    int join_slot(int slot);
+    void remove_slot(int slot);
+    int set_limits(int slot, double ncpus, double ram);
+    int get_usage(int slot, PROCINFO&);
+};
+
+extern CGROUPS cgroups;
+
+#endif
@@ -141,6 +141,9 @@ void CLIENT_STATE::check_active_task(ACTIVE_TASK& p) {
 
 void CLIENT_STATE::check_pers_file_xfer(PERS_FILE_XFER& p) {
     if (p.fxp) check_file_xfer_pointer(p.fxp);
+    for (unsigned int i=0; i<p.ranges.size(); i++) {
+        if (p.ranges[i].fxp) check_file_xfer_pointer(p.ranges[i].fxp);
+    }
     check_file_info_pointer(p.fip);
 }
 
@@ -148,6 +151,31 @@ void CLIENT_STATE::check_file_xfer(FILE_XFER& p) {
     check_file_info_pointer(p.fip);
 }
 
+// check that the name indices match the vectors
+//
+void CLIENT_STATE::check_indices() {
+    unsigned int i;
+    assert(app_index.size() == apps.size());
+    for (i=0; i<apps.size(); i++) {
+        assert(lookup_app(apps[i]->project, apps[i]->name) == apps[i]);
+    }
+    assert(file_info_index.size() == file_infos.size());
+    for (i=0; i<file_infos.size(); i++) {
+        FILE_INFO* fip = file_infos[i];
+        assert(lookup_file_info(fip->project, fip->name) == fip);
+    }
+    assert(workunit_index.size() == workunits.size());
+    for (i=0; i<workunits.size(); i++) {
+        WORKUNIT* wup = workunits[i];
+        assert(lookup_workunit(wup->project, wup->name) == wup);
+    }
+    assert(result_index.size() == results.size());
+    for (i=0; i<results.size(); i++) {
+        RESULT* rp = results[i];
+        assert(lookup_result(rp->project, rp->name) == rp);
+    }
+}
+
 void CLIENT_STATE::check_all() {
     unsigned int i;
     for (i=0; i<apps.size(); i++) {
@@ -165,6 +193,7 @@ void CLIENT_STATE::check_all() {
     for (i=0; i<results.size(); i++) {
         check_result(*results[i]);
     }
+    check_indices();
     for (i=0; i<active_tasks.active_tasks.size(); i++) {
         check_active_task(*active_tasks.active_tasks[i]);
     }
@@ -235,6 +264,11 @@ void CLIENT_STATE::free_mem() {
         delete res;
     }
 
+    app_index.clear();
+    file_info_index.clear();
+    workunit_index.clear();
+    result_index.clear();
+
     active_tasks.free_mem();
 
     message_descs.cleanup();
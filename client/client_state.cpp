@@ -30,6 +30,10 @@
 #if HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 #endif
 
 #ifdef __EMX__
@@ -51,10 +55,13 @@
 
 #include "app_config.h"
 #include "async_file.h"
+#include "cgroup.h"
 #include "client_msgs.h"
+#include "content_store.h"
 #include "cs_notice.h"
 #include "cs_proxy.h"
 #include "cs_trickle.h"
+#include "disk_usage.h"
 #include "file_names.h"
 #include "hostinfo.h"
 #include "http_curl.h"
@@ -93,6 +100,9 @@ CLIENT_STATE::CLIENT_STATE()
 #endif
     time_stats.init();
     client_state_dirty = false;
+    journal_seqno = 0;
+    journal_nrecords = 0;
+    journal_file = NULL;
     old_major_version = 0;
     old_minor_version = 0;
     old_release = 0;
@@ -126,6 +136,7 @@ CLIENT_STATE::CLIENT_STATE()
     run_test_app = false;
 #ifndef _WIN32
     boinc_project_gid = 0;
+    wakeup_fds[0] = wakeup_fds[1] = -1;
 #endif
     show_projects = false;
     safe_strcpy(detach_project_url, "");
@@ -436,6 +447,9 @@ int CLIENT_STATE::init() {
 
     srand((unsigned int)time(0));
     now = dtime();
+#ifndef _WIN32
+    init_wakeup();
+#endif
 #ifdef ANDROID
     device_status_time = dtime();
 #endif
@@ -687,6 +701,13 @@ int CLIENT_STATE::init() {
 
     process_gpu_exclusions();
 
+#ifdef __linux__
+    if (cc_config.use_cgroups) {
+        cgroups.init();
+    }
+    disk_usage_tracker.init();
+#endif
+
     check_clock_reset();
 
     // Check to see if we can write the state file.
@@ -801,6 +822,9 @@ int CLIENT_STATE::init() {
         "Checking presence of %d project files", (int)file_infos.size()
     );
     check_file_existence();
+#ifndef _WIN32
+    content_store.init();
+#endif
     if (!boinc_file_exists(ALL_PROJECTS_LIST_FILENAME)) {
         all_projects_list_check_time = 0;
     }
@@ -857,6 +881,90 @@ int CLIENT_STATE::init() {
     return 0;
 }
 
+#ifndef _WIN32
+static void sigchld_handler(int) {
+    gstate.wakeup();
+}
+
+// Create the wakeup descriptor,
+// and have child process exits write to it,
+// so that finished tasks are handled right away
+// rather than at the next poll.
+//
+void CLIENT_STATE::init_wakeup() {
+#ifdef __linux__
+    int fd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+    if (fd >= 0) {
+        wakeup_fds[0] = wakeup_fds[1] = fd;
+    }
+#endif
+    if (wakeup_fds[0] < 0) {
+        if (pipe(wakeup_fds)) {
+            wakeup_fds[0] = wakeup_fds[1] = -1;
+            return;
+        }
+        for (int i=0; i<2; i++) {
+            fcntl(wakeup_fds[i], F_SETFL, O_NONBLOCK);
+            fcntl(wakeup_fds[i], F_SETFD, FD_CLOEXEC);
+        }
+    }
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigchld_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART|SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &sa, NULL);
+}
+
+void CLIENT_STATE::wakeup() {
+    if (wakeup_fds[1] < 0) return;
+    int e = errno;
+#ifdef __linux__
+    if (wakeup_fds[0] == wakeup_fds[1]) {
+        uint64_t x = 1;
+        if (::write(wakeup_fds[1], &x, sizeof(x))) {}
+        errno = e;
+        return;
+    }
+#endif
+    if (::write(wakeup_fds[1], "", 1)) {}
+    errno = e;
+}
+
+// if the wakeup descriptor is readable, drain it and return true
+//
+bool CLIENT_STATE::check_wakeup(FDSET_GROUP& fg) {
+    if (wakeup_fds[0] < 0) return false;
+    if (!FD_ISSET(wakeup_fds[0], &fg.read_fds)) return false;
+    char buf[64];
+    while (read(wakeup_fds[0], buf, sizeof(buf)) > 0) {}
+    return true;
+}
+#endif
+
+// How long to handle I/O before the next poll_slow_events().
+// If nothing is going on, we can wait longer;
+// I/O or a wakeup will end the wait early.
+//
+double CLIENT_STATE::poll_interval() {
+#ifdef _WIN32
+    return POLL_INTERVAL;
+#else
+    if (wakeup_fds[0] < 0) return POLL_INTERVAL;
+    if (http_ops->nops()) return POLL_INTERVAL;
+    if (gui_rpcs.nconns()) return POLL_INTERVAL;
+    if (have_async_file_op()) return POLL_INTERVAL;
+    if (benchmarks_running) return POLL_INTERVAL;
+    if (requested_exit || in_abort_sequence) return POLL_INTERVAL;
+    for (unsigned int i=0; i<active_tasks.active_tasks.size(); i++) {
+        if (active_tasks.active_tasks[i]->process_exists()) {
+            return POLL_INTERVAL;
+        }
+    }
+    return IDLE_POLL_INTERVAL;
+#endif
+}
+
 static void double_to_timeval(double x, timeval& t) {
     t.tv_sec = (int)x;
     t.tv_usec = (int)(1000000*(x - (int)x));
@@ -883,6 +991,13 @@ void CLIENT_STATE::do_io_or_sleep(double max_time) {
         if (!autologin_in_progress) {
             gui_rpcs.get_fdset(gui_rpc_fds, all_fds);
         }
+#ifndef _WIN32
+        if (wakeup_fds[0] >= 0) {
+            FD_SET(wakeup_fds[0], &all_fds.read_fds);
+            if (wakeup_fds[0] > all_fds.max_fd) all_fds.max_fd = wakeup_fds[0];
+        }
+        active_tasks.get_fdset(all_fds);
+#endif
 
         bool have_async = have_async_file_op();
 
@@ -917,6 +1032,18 @@ void CLIENT_STATE::do_io_or_sleep(double max_time) {
         http_ops->got_select(all_fds, time_remaining);
         gui_rpcs.got_select(all_fds);
 
+#ifndef _WIN32
+        // a wakeup is usually a SIGCHLD, i.e. a process exited
+        //
+        if (n > 0 && check_wakeup(all_fds)) {
+            active_tasks.exit_pending = true;
+            break;
+        }
+        if (n > 0 && active_tasks.got_select(all_fds)) {
+            break;
+        }
+#endif
+
         if (have_async) {
             // do the async file op only if no network activity
             //
@@ -1032,6 +1159,9 @@ bool CLIENT_STATE::poll_slow_events() {
     //
     active_tasks.get_memory_usage();
     suspend_reason = check_suspend_processing();
+#ifdef __linux__
+    disk_usage_tracker.poll();
+#endif
 
     // suspend or resume activities (but only if already did startup)
     //
@@ -1149,6 +1279,7 @@ bool CLIENT_STATE::poll_slow_events() {
     POLL_ACTION(create_and_delete_pers_file_xfers ,
         create_and_delete_pers_file_xfers
     );
+    POLL_ACTION(async_verifies         , poll_async_verifies    );
     POLL_ACTION(handle_finished_apps   , handle_finished_apps   );
     POLL_ACTION(update_results         , update_results         );
     if (!tasks_suspended) {
@@ -1209,28 +1340,20 @@ PROJECT* CLIENT_STATE::lookup_project(const char* master_url) {
     return 0;
 }
 
+// The following lookups use hash indices;
+// they're called for each object when parsing the state file
+// and scheduler replies, so linear search is quadratic overall.
+//
 APP* CLIENT_STATE::lookup_app(PROJECT* p, const char* name) {
-    for (unsigned int i=0; i<apps.size(); i++) {
-        APP* app = apps[i];
-        if (app->project == p && !strcmp(name, app->name)) return app;
-    }
-    return 0;
+    return app_index.lookup(p, name);
 }
 
 RESULT* CLIENT_STATE::lookup_result(PROJECT* p, const char* name) {
-    for (unsigned int i=0; i<results.size(); i++) {
-        RESULT* rp = results[i];
-        if (rp->project == p && !strcmp(name, rp->name)) return rp;
-    }
-    return 0;
+    return result_index.lookup(p, name);
 }
 
 WORKUNIT* CLIENT_STATE::lookup_workunit(PROJECT* p, const char* name) {
-    for (unsigned int i=0; i<workunits.size(); i++) {
-        WORKUNIT* wup = workunits[i];
-        if (wup->project == p && !strcmp(name, wup->name)) return wup;
-    }
-    return 0;
+    return workunit_index.lookup(p, name);
 }
 
 APP_VERSION* CLIENT_STATE::lookup_app_version(
@@ -1248,13 +1371,7 @@ APP_VERSION* CLIENT_STATE::lookup_app_version(
 }
 
 FILE_INFO* CLIENT_STATE::lookup_file_info(PROJECT* p, const char* name) {
-    for (unsigned int i=0; i<file_infos.size(); i++) {
-        FILE_INFO* fip = file_infos[i];
-        if (fip->project == p && !strcmp(fip->name, name)) {
-            return fip;
-        }
-    }
-    return 0;
+    return file_info_index.lookup(p, name);
 }
 
 // functions to create links between state objects
@@ -1591,6 +1708,7 @@ bool CLIENT_STATE::garbage_collect_always() {
                     );
                 }
                 add_old_result(*rp);
+                result_index.remove(rp);
                 delete rp;
                 result_iter = results.erase(result_iter);
                 action = true;
@@ -1666,6 +1784,7 @@ bool CLIENT_STATE::garbage_collect_always() {
                     wup->name
                 );
             }
+            workunit_index.remove(wup);
             delete wup;
             wu_iter = workunits.erase(wu_iter);
             action = true;
@@ -1763,6 +1882,7 @@ bool CLIENT_STATE::garbage_collect_always() {
                     fip->name
                 );
             }
+            file_info_index.remove(fip);
             delete fip;
             fi_iter = file_infos.erase(fi_iter);
             action = true;
@@ -2007,10 +2127,7 @@ int CLIENT_STATE::reset_project(PROJECT* project, bool detaching) {
     for (i=0; i<pers_file_xfers->pers_file_xfers.size(); i++) {
         pxp = pers_file_xfers->pers_file_xfers[i];
         if (pxp->fip->project == project) {
-            if (pxp->fxp) {
-                file_xfers->remove(pxp->fxp);
-                delete pxp->fxp;
-            }
+            pxp->suspend();
             pers_file_xfers->remove(pxp);
             delete pxp;
             i--;
@@ -2068,6 +2185,7 @@ int CLIENT_STATE::reset_project(PROJECT* project, bool detaching) {
         while (app_iter != apps.end()) {
             app = *app_iter;
             if (app->project == project) {
+                app_index.remove(app);
                 app_iter = apps.erase(app_iter);
                 delete app;
             } else {
@@ -2086,6 +2204,9 @@ int CLIENT_STATE::reset_project(PROJECT* project, bool detaching) {
             "reset project",
             "app_config.xml"
         );
+#ifndef _WIN32
+        content_store.garbage_collect();
+#endif
     }
 
     // force refresh of scheduler URLs
@@ -2128,6 +2249,7 @@ int CLIENT_STATE::detach_project(PROJECT* project) {
     while (fi_iter != file_infos.end()) {
         fip = *fi_iter;
         if (fip->project == project) {
+            file_info_index.remove(fip);
             fi_iter = file_infos.erase(fi_iter);
             delete fip;
         } else {
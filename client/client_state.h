@@ -51,6 +51,7 @@ using std::vector;
 #include "project_init.h"
 #include "hostinfo.h"
 #include "miofile.h"
+#include "name_index.h"
 #include "net_stats.h"
 #include "pers_file_xfer.h"
 #include "prefs.h"
@@ -81,6 +82,12 @@ struct CLIENT_STATE {
     vector<WORKUNIT*> workunits;
     vector<RESULT*> results;
         // list of jobs, ordered by increasing arrival time
+    NAME_INDEX<APP> app_index;
+    NAME_INDEX<FILE_INFO> file_info_index;
+    NAME_INDEX<WORKUNIT> workunit_index;
+    NAME_INDEX<RESULT> result_index;
+        // indices of the above by (project, name).
+        // Update these whenever you add to or remove from the vectors
 
     PERS_FILE_XFER_SET* pers_file_xfers;
     HTTP_OP_SET* http_ops;
@@ -218,6 +225,11 @@ struct CLIENT_STATE {
         // so that the Manager can tell the user what the problem is
 
     bool client_state_dirty;
+    int journal_seqno;
+        // sequence number of the last state journal record
+    int journal_nrecords;
+        // records in the journal since the last full write
+    FILE* journal_file;
     int old_major_version;
     int old_minor_version;
     int old_release;
@@ -261,6 +273,16 @@ struct CLIENT_STATE {
         // Returns true if it actually did something,
         // in which case it should be called again immediately.
     void do_io_or_sleep(double dt);
+    double poll_interval();
+#ifndef _WIN32
+    int wakeup_fds[2];
+        // a pipe (an eventfd on Linux) that ends do_io_or_sleep() early,
+        // e.g. when a child process exits
+    void init_wakeup();
+    void wakeup();
+        // async-signal-safe
+    bool check_wakeup(FDSET_GROUP&);
+#endif
     bool time_to_exit();
     PROJECT* lookup_project(const char*);
     APP* lookup_app(PROJECT*, const char*);
@@ -307,8 +329,6 @@ struct CLIENT_STATE {
     bool must_enforce_cpu_schedule;
     bool must_schedule_cpus;
     bool must_check_work_fetch;
-    void assign_results_to_projects();
-    RESULT* highest_prio_project_best_result();
     void reset_rec_accounting();
     bool schedule_cpus();
     void make_run_list(vector<RESULT*>&);
@@ -461,6 +481,9 @@ struct CLIENT_STATE {
     int write_state(MIOFILE&);
     int write_state_file();
     int write_state_file_if_needed();
+    void journal_active_tasks(const char*);
+    int replay_journal();
+    void truncate_journal();
     void check_anonymous();
     int parse_app_info(PROJECT*, FILE*);
     int write_state_gui(MIOFILE&);
@@ -495,6 +518,7 @@ struct CLIENT_STATE {
     void check_active_task(ACTIVE_TASK&);
     void check_pers_file_xfer(PERS_FILE_XFER&);
     void check_file_xfer(FILE_XFER&);
+    void check_indices();
 
     void check_all();
     void free_mem();
@@ -548,6 +572,10 @@ extern THREAD throttle_thread;
     // the client will handle I/O (including GUI RPCs)
     // for up to POLL_INTERVAL seconds before calling poll_slow_events()
     // to call the polling functions
+#define IDLE_POLL_INTERVAL  5.0
+    // if no tasks are running and there's no network or GUI RPC activity,
+    // use this instead.
+    // Must be less than 10*POLL_INTERVAL (see poll_slow_events())
 
 #define GARBAGE_COLLECT_PERIOD  10
     // how often to garbage collect
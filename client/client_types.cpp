@@ -49,6 +49,7 @@
 #include "async_file.h"
 #include "client_msgs.h"
 #include "client_state.h"
+#include "content_store.h"
 #include "file_names.h"
 #include "project.h"
 #include "pers_file_xfer.h"
@@ -248,40 +249,43 @@ int FILE_INFO::set_permissions(const char* path) {
         get_pathname(this, pathname, sizeof(pathname));
     }
 
+    mode_t mode;
     if (g_use_sandbox) {
         // give exec permissions for user, group and others but give
         // read permissions only for user and group to protect account keys
         retval = set_to_project_group(pathname);
         if (retval) return retval;
         if (executable) {
-            retval = chmod(pathname,
-                S_IRUSR|S_IWUSR|S_IXUSR
+            mode = S_IRUSR|S_IWUSR|S_IXUSR
                 |S_IRGRP|S_IWGRP|S_IXGRP
-                |S_IXOTH
-            );
+                |S_IXOTH;
         } else {
-            retval = chmod(pathname,
-                S_IRUSR|S_IWUSR
-                |S_IRGRP|S_IWGRP
-            );
+            mode = S_IRUSR|S_IWUSR
+                |S_IRGRP|S_IWGRP;
         }
     } else {
         // give read/exec permissions for user, group and others
         // in case someone runs BOINC from different user
         if (executable) {
-            retval = chmod(pathname,
-                S_IRUSR|S_IWUSR|S_IXUSR
+            mode = S_IRUSR|S_IWUSR|S_IXUSR
                 |S_IRGRP|S_IXGRP
-                |S_IROTH|S_IXOTH
-            );
+                |S_IROTH|S_IXOTH;
         } else {
-            retval = chmod(pathname,
-                S_IRUSR|S_IWUSR
+            mode = S_IRUSR|S_IWUSR
                 |S_IRGRP
-                |S_IROTH
-            );
+                |S_IROTH;
         }
     }
+
+    // if the file has other hard links
+    // (the content store, or a slot with <hard_link_input_files>)
+    // keep it read-only, so that nothing can change it through one of them
+    //
+    struct stat sbuf;
+    if (!stat(pathname, &sbuf) && sbuf.st_nlink > 1) {
+        mode &= ~(S_IWUSR|S_IWGRP|S_IWOTH);
+    }
+    retval = chmod(pathname, mode);
     return retval;
 }
 #endif
@@ -310,7 +314,7 @@ int FILE_INFO::parse(XML_PARSER& xp) {
         }
         if (xp.match_tag("xml_signature")) {
             retval = copy_element_contents(
-                xp.f->f,
+                *xp.f,
                 "</xml_signature>",
                 xml_signature,
                 sizeof(xml_signature)
@@ -321,7 +325,7 @@ int FILE_INFO::parse(XML_PARSER& xp) {
         }
         if (xp.match_tag("file_signature")) {
             retval = copy_element_contents(
-                xp.f->f,
+                *xp.f,
                 "</file_signature>",
                 file_signature,
                 sizeof(file_signature)
@@ -406,7 +410,7 @@ int FILE_INFO::parse(XML_PARSER& xp) {
         }
         if (xp.match_tag("error_msg")) {
             retval = copy_element_contents(
-                xp.f->f,
+                *xp.f,
                 "</error_msg>", buf2, sizeof(buf2)
             );
             if (retval) return retval;
@@ -547,9 +551,19 @@ int FILE_INFO::delete_file() {
     safe_strcat(path, "t");
     delete_project_owned_file(path, true);
 
+    // or as a partial download in ranges (see PERS_FILE_XFER)
+    //
+    char part_path[MAXPATHLEN+16];
+    get_pathname(this, part_path, sizeof(part_path));
+    safe_strcat(part_path, ".part");
+    delete_project_owned_file(part_path, true);
+
     if (retval && status != FILE_NOT_PRESENT) {
         msg_printf(project, MSG_INTERNAL_ERROR, "Couldn't delete file %s", path);
     }
+#if !defined(_WIN32) && !defined(SIM)
+    content_store.release_file(this);
+#endif
     status = FILE_NOT_PRESENT;
     return retval;
 }
@@ -0,0 +1,169 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+// Content-addressed store of downloaded files; see content_store.h
+
+#include "config.h"
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "filesys.h"
+#include "str_replace.h"
+
+#include "client_msgs.h"
+#include "client_state.h"
+#include "file_names.h"
+#include "log_flags.h"
+#include "project.h"
+
+#include "content_store.h"
+
+CONTENT_STORE content_store;
+
+void CONTENT_STORE::init() {
+    if (!cc_config.use_content_store) return;
+    boinc_mkdir(CONTENT_STORE_DIR);
+    if (!is_dir(CONTENT_STORE_DIR)) {
+        msg_printf(NULL, MSG_INTERNAL_ERROR,
+            "Can't create %s; not using content store", CONTENT_STORE_DIR
+        );
+        return;
+    }
+    enabled = true;
+    garbage_collect();
+}
+
+// get the store path for a file.
+// Return false if the file can't be in the store.
+//
+bool CONTENT_STORE::get_path(FILE_INFO* fip, char* path, int len) {
+    if (strlen(fip->md5_cksum) != 32) return false;
+    if (fip->nbytes < CONTENT_STORE_MIN_NBYTES) return false;
+    snprintf(path, len, "%s/%s_%.0f%s",
+        CONTENT_STORE_DIR, fip->md5_cksum, fip->nbytes,
+        fip->executable?"_x":""
+    );
+    return true;
+}
+
+// Called before downloading a file.
+// If it's in the store, link it into the project dir
+// and return true.
+//
+bool CONTENT_STORE::link_file(FILE_INFO* fip) {
+    char store_path[MAXPATHLEN], path[MAXPATHLEN];
+
+    if (!enabled) return false;
+    if (!get_path(fip, store_path, sizeof(store_path))) return false;
+    get_pathname(fip, path, sizeof(path));
+    if (boinc_file_exists(path)) return false;
+    if (link(store_path, path)) return false;
+    if (log_flags.file_xfer) {
+        msg_printf(fip->project, MSG_INFO,
+            "Using stored copy of %s; skipping download", fip->name
+        );
+    }
+    return true;
+}
+
+// Called when a file has been downloaded and verified.
+// If its MD5 was checked, add it to the store.
+// If the store has a copy already (e.g. two projects downloaded
+// the same file at the same time) replace the file with a link to it.
+//
+// Make the file read-only, since it may be shared;
+// FILE_INFO::set_permissions() keeps files with other links read-only.
+//
+void CONTENT_STORE::add_file(FILE_INFO* fip) {
+    char store_path[MAXPATHLEN], path[MAXPATHLEN], tmp_path[MAXPATHLEN+16];
+    struct stat sbuf;
+
+    if (!enabled) return;
+    if (fip->signature_required) return;
+    if (!get_path(fip, store_path, sizeof(store_path))) return;
+    get_pathname(fip, path, sizeof(path));
+    if (stat(path, &sbuf)) return;
+    if (sbuf.st_mode & 0222) {
+        chmod(path, sbuf.st_mode & ~0222);
+    }
+    if (!link(path, store_path)) return;
+    if (errno != EEXIST) return;
+
+    struct stat sbuf2;
+    if (stat(store_path, &sbuf2)) return;
+    if (sbuf.st_ino == sbuf2.st_ino && sbuf.st_dev == sbuf2.st_dev) return;
+    snprintf(tmp_path, sizeof(tmp_path), "%s.link", path);
+    unlink(tmp_path);
+    if (link(store_path, tmp_path)) return;
+    if (rename(tmp_path, path)) {
+        unlink(tmp_path);
+        return;
+    }
+    if (log_flags.file_xfer_debug) {
+        msg_printf(fip->project, MSG_INFO,
+            "[file_xfer] replaced %s with stored copy", fip->name
+        );
+    }
+}
+
+// Called when a project file has been deleted.
+// If only the store refers to its contents now, delete them.
+//
+void CONTENT_STORE::release_file(FILE_INFO* fip) {
+    char store_path[MAXPATHLEN];
+    struct stat sbuf;
+
+    if (!enabled) return;
+    if (!get_path(fip, store_path, sizeof(store_path))) return;
+    if (stat(store_path, &sbuf)) return;
+    if (sbuf.st_nlink <= 1) {
+        boinc_delete_file(store_path);
+    }
+}
+
+// delete stored files that nothing refers to.
+// Called at startup and after a project is reset,
+// since whole directories are deleted without release_file().
+//
+void CONTENT_STORE::garbage_collect() {
+    char name[256], path[MAXPATHLEN];
+    struct stat sbuf;
+
+    if (!enabled) return;
+    DIRREF dirp = dir_open(CONTENT_STORE_DIR);
+    if (!dirp) return;
+    while (!dir_scan(name, dirp, sizeof(name))) {
+        snprintf(path, sizeof(path), "%s/%s", CONTENT_STORE_DIR, name);
+        if (stat(path, &sbuf)) continue;
+        if (sbuf.st_nlink > 1) continue;
+        if (log_flags.file_xfer_debug) {
+            msg_printf(NULL, MSG_INFO,
+                "[file_xfer] deleting unused stored file %s", name
+            );
+        }
+        boinc_delete_file(path);
+    }
+    dir_close(dirp);
+}
+
+#endif
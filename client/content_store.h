@@ -0,0 +1,59 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOINC_CONTENT_STORE_H
+#define BOINC_CONTENT_STORE_H
+
+// A client-wide store of downloaded files, keyed by content
+// (<use_content_store> in cc_config.xml; Unix only).
+//
+// Projects and apps often use identical large files
+// (runtime libraries, databases, VM images) under different names.
+// When a file whose MD5 and size were given by the scheduler
+// has been downloaded and verified,
+// we add a hard link to it in content_store/, named MD5_SIZE
+// (plus "_x" for executables, since the two can't share permissions).
+// Before downloading a file, we look for it there;
+// if it's present we link it into the project dir instead,
+// and it's verified as if it had been downloaded.
+//
+// The inode's link count serves as the reference count:
+// when a project file is deleted and only the store's link is left,
+// we delete that too.
+
+#include "client_types.h"
+
+#define CONTENT_STORE_MIN_NBYTES    1e6
+    // smaller files aren't worth sharing
+
+struct CONTENT_STORE {
+    bool enabled;
+
+    CONTENT_STORE() {
+        enabled = false;
+    }
+    void init();
+    bool get_path(FILE_INFO*, char* path, int len);
+    bool link_file(FILE_INFO*);
+    void add_file(FILE_INFO*);
+    void release_file(FILE_INFO*);
+    void garbage_collect();
+};
+
+extern CONTENT_STORE content_store;
+
+#endif
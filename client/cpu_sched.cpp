@@ -34,6 +34,9 @@
 //          It's possible that we include a bunch of jobs that can't run
 //          because of memory limits,
 //          even though there are other jobs that could run.
+//      The runnable jobs are sorted into per-resource candidate lists
+//      once per pass (RUN_LIST_CANDIDATES), and jobs are picked
+//      by walking those lists.
 //      - add running jobs to the list
 //          (in case they haven't finished time slice or checkpointed)
 //      - sort the list according to "more_important()"
@@ -63,6 +66,8 @@
 #include <list>
 #endif
 
+#include <algorithm>
+#include <unordered_map>
 
 #include "coproc.h"
 #include "error_numbers.h"
@@ -319,108 +324,209 @@ static inline bool finished_time_slice(ACTIVE_TASK* atp) {
     return (running_beyond_sched_period && checkpointed);
 }
 
-// Choose a "best" runnable CPU job for each project
+// A project's runnable jobs for a given resource type,
+// in the order in which make_run_list() picks them.
 //
-// Values are returned in project->next_runnable_result
-// (skip projects for which this is already non-NULL)
+struct PROJECT_JOBS {
+    PROJECT* p;
+    vector<RESULT*> jobs;
+    size_t next;
+
+    PROJECT_JOBS(PROJECT* _p) {
+        p = _p;
+        next = 0;
+    }
+
+    // the next job, skipping ones already selected (e.g. by EDF)
+    //
+    RESULT* head() {
+        while (next < jobs.size()) {
+            RESULT* rp = jobs[next];
+            if (!rp->already_selected) return rp;
+            next++;
+        }
+        return NULL;
+    }
+};
+
+// The candidate jobs for make_run_list(), built and sorted
+// once per scheduling pass.
+// Picking a job used to mean scanning all results,
+// and looking up the active task of each one, for every job picked.
 //
-// Don't choose results with already_selected == true;
-// mark chosen results as already_selected.
+struct RUN_LIST_CANDIDATES {
+    std::unordered_map<RESULT*, ACTIVE_TASK*> tasks;
+    vector<RESULT*> edf[MAX_RSC];
+        // runnable jobs by increasing deadline
+    size_t edf_next[MAX_RSC];
+    vector<PROJECT_JOBS> fifo[MAX_RSC];
+        // runnable jobs per project
+
+    void init();
+    ACTIVE_TASK* lookup_task(RESULT* rp) {
+        std::unordered_map<RESULT*, ACTIVE_TASK*>::iterator i = tasks.find(rp);
+        if (i == tasks.end()) return NULL;
+        return i->second;
+    }
+    RESULT* earliest_deadline_result(int rsc_type);
+    RESULT* first_coproc_result(int rsc_type);
+    RESULT* highest_prio_project_best_result();
+};
+
+struct EDF_CANDIDATE {
+    RESULT* rp;
+    bool started;
+    double runtime_remaining;
+    int pos;
+};
+
+// Order of jobs for EDF:
+// earliest deadline, then started jobs,
+// then least remaining time, then arrival
 //
-// The preference order:
-// 1. results with active tasks that are running
-// 2. results with active tasks that are preempted (but have a process)
-// 3. results with active tasks that have no process
-// 4. results with no active task
+static bool edf_before(const EDF_CANDIDATE& c0, const EDF_CANDIDATE& c1) {
+    if (c0.rp->report_deadline != c1.rp->report_deadline) {
+        return c0.rp->report_deadline < c1.rp->report_deadline;
+    }
+    if (c0.started != c1.started) return c0.started;
+    if (c0.runtime_remaining != c1.runtime_remaining) {
+        return c0.runtime_remaining < c1.runtime_remaining;
+    }
+    return c0.pos < c1.pos;
+}
+
+// Order of a project's GPU jobs: already-started, then earlier received.
+// Give priority to already-started jobs because of the following scenario:
+// - client gets several jobs in a sched reply and starts downloading files
+// - a later job finishes downloading and starts
+// - an earlier finishes downloading and preempts
 //
-// TODO: this is called in a loop over NCPUs, which is silly.
-// Should call it once, and have it make an ordered list per project.
+static bool coproc_fifo_before(RESULT* r0, RESULT* r1) {
+    if (r0->not_started != r1->not_started) return r1->not_started;
+    return r0->index < r1->index;
+}
+
+// Order of a project's CPU jobs:
+// 0. results with active tasks that are running
+// 1. results with active tasks that are preempted (but have a process)
+// 2. results with active tasks that have no process
+// 3. results with no active task
 //
-void CLIENT_STATE::assign_results_to_projects() {
-    unsigned int i;
-    RESULT* rp;
-    PROJECT* project;
+static int cpu_job_rank(ACTIVE_TASK* atp) {
+    if (!atp) return 3;
+    if (!atp->process_exists()) return 2;
+    if (atp->scheduler_state == CPU_SCHED_SCHEDULED) return 0;
+    return 1;
+}
 
-    // scan results with an ACTIVE_TASK
-    //
-    for (i=0; i<active_tasks.active_tasks.size(); i++) {
-        ACTIVE_TASK *atp = active_tasks.active_tasks[i];
-        if (!atp->runnable()) continue;
-        rp = atp->result;
-        if (rp->already_selected) continue;
-        if (rp->uses_coprocs()) continue;
-        if (!rp->runnable()) continue;
-        project = rp->project;
-        if (!project->next_runnable_result) {
-            project->next_runnable_result = rp;
-            continue;
-        }
+static bool cpu_rank_before(
+    const std::pair<int, RESULT*>& x0, const std::pair<int, RESULT*>& x1
+) {
+    return x0.first < x1.first;
+}
 
-        // see if this task is "better" than the one currently
-        // selected for this project
-        //
-        ACTIVE_TASK *next_atp = lookup_active_task_by_result(
-            project->next_runnable_result
-        );
+// Call this after setting already_selected, not_started,
+// and deadlines_missed_copy
+//
+void RUN_LIST_CANDIDATES::init() {
+    unsigned int i;
+    int j;
+    std::unordered_map<PROJECT*, int> project_slot;
+    vector<EDF_CANDIDATE> edf_cands[MAX_RSC];
+    vector<vector<std::pair<int, RESULT*> > > cpu_jobs(gstate.projects.size());
 
-        if ((next_atp->task_state() == PROCESS_UNINITIALIZED && atp->process_exists())
-            || (next_atp->scheduler_state == CPU_SCHED_PREEMPTED
-            && atp->scheduler_state == CPU_SCHED_SCHEDULED)
-        ) {
-            project->next_runnable_result = atp->result;
+    tasks.clear();
+    for (i=0; i<gstate.active_tasks.active_tasks.size(); i++) {
+        ACTIVE_TASK* atp = gstate.active_tasks.active_tasks[i];
+        tasks[atp->result] = atp;
+    }
+    for (j=0; j<coprocs.n_rsc; j++) {
+        edf[j].clear();
+        edf_next[j] = 0;
+        fifo[j].clear();
+        for (i=0; i<gstate.projects.size(); i++) {
+            fifo[j].push_back(PROJECT_JOBS(gstate.projects[i]));
         }
     }
+    for (i=0; i<gstate.projects.size(); i++) {
+        project_slot[gstate.projects[i]] = i;
+    }
 
-    // Now consider results that don't have an active task
+    // CPU jobs with an active task go first, in active task order
     //
-    for (i=0; i<results.size(); i++) {
-        rp = results[i];
-        if (rp->already_selected) continue;
+    for (i=0; i<gstate.active_tasks.active_tasks.size(); i++) {
+        ACTIVE_TASK* atp = gstate.active_tasks.active_tasks[i];
+        if (!atp->runnable()) continue;
+        RESULT* rp = atp->result;
         if (rp->uses_coprocs()) continue;
-        if (lookup_active_task_by_result(rp)) continue;
         if (!rp->runnable()) continue;
+        cpu_jobs[project_slot[rp->project]].push_back(
+            std::make_pair(cpu_job_rank(atp), rp)
+        );
+    }
 
-        project = rp->project;
-        if (project->next_runnable_result) continue;
-        project->next_runnable_result = rp;
+    for (i=0; i<gstate.results.size(); i++) {
+        RESULT* rp = gstate.results[i];
+        if (!rp->runnable()) continue;
+        ACTIVE_TASK* atp = lookup_task(rp);
+        int slot = project_slot[rp->project];
+        int rt = rp->resource_type();
+        if (!rp->uses_coprocs() && !atp) {
+            cpu_jobs[slot].push_back(std::make_pair(cpu_job_rank(NULL), rp));
+        }
+        if (rp->non_cpu_intensive()) continue;
+        EDF_CANDIDATE c;
+        c.rp = rp;
+        c.started = (atp != NULL);
+        c.runtime_remaining = rp->estimated_runtime_remaining();
+        c.pos = i;
+        edf_cands[rt].push_back(c);
+        if (rt) {
+            fifo[rt][slot].jobs.push_back(rp);
+        }
     }
 
-    // mark selected results, so CPU scheduler won't try to consider
-    // a result more than once
-    //
-    for (i=0; i<projects.size(); i++) {
-        project = projects[i];
-        if (project->next_runnable_result) {
-            project->next_runnable_result->already_selected = true;
+    for (j=0; j<coprocs.n_rsc; j++) {
+        std::sort(edf_cands[j].begin(), edf_cands[j].end(), edf_before);
+        for (i=0; i<edf_cands[j].size(); i++) {
+            edf[j].push_back(edf_cands[j][i].rp);
+        }
+        if (!j) continue;
+        for (i=0; i<fifo[j].size(); i++) {
+            vector<RESULT*>& jobs = fifo[j][i].jobs;
+            std::stable_sort(jobs.begin(), jobs.end(), coproc_fifo_before);
+        }
+    }
+    for (i=0; i<cpu_jobs.size(); i++) {
+        std::stable_sort(cpu_jobs[i].begin(), cpu_jobs[i].end(), cpu_rank_before);
+        for (unsigned int k=0; k<cpu_jobs[i].size(); k++) {
+            fifo[0][i].jobs.push_back(cpu_jobs[i][k].second);
         }
     }
 }
 
-// Among projects with a "next runnable result",
+// Among projects with a runnable CPU job,
 // find the project P with the largest priority,
-// and return its next runnable result
+// and return its best job
 //
-RESULT* CLIENT_STATE::highest_prio_project_best_result() {
-    PROJECT *best_project = NULL;
-    double best_prio = 0;
-    bool first = true;
-    unsigned int i;
-
-    for (i=0; i<projects.size(); i++) {
-        PROJECT* p = projects[i];
-        if (!p->next_runnable_result) continue;
-        if (p->non_cpu_intensive) continue;
-        if (first || p->sched_priority > best_prio) {
-            first = false;
-            best_project = p;
-            best_prio = p->sched_priority;
-        }
-    }
-    if (!best_project) return NULL;
-
-    RESULT* rp = best_project->next_runnable_result;
-    best_project->next_runnable_result = 0;
-    return rp;
+RESULT* RUN_LIST_CANDIDATES::highest_prio_project_best_result() {
+    PROJECT_JOBS* best = NULL;
+    RESULT* best_rp = NULL;
+
+    for (unsigned int i=0; i<fifo[0].size(); i++) {
+        PROJECT_JOBS& pj = fifo[0][i];
+        if (pj.p->non_cpu_intensive) continue;
+        RESULT* rp = pj.head();
+        if (!rp) continue;
+        if (!best || pj.p->sched_priority > best->p->sched_priority) {
+            best = &pj;
+            best_rp = rp;
+        }
+    }
+    if (!best) return NULL;
+    best_rp->already_selected = true;
+    best->next++;
+    return best_rp;
 }
 
 // Return a job of the given type according to the following criteria
@@ -428,78 +534,43 @@ RESULT* CLIENT_STATE::highest_prio_project_best_result() {
 //  - from project with higher priority
 //  - already-started job
 //  - earlier received_time
-//  - lexicographically earlier name
 //
-// Give priority to already-started jobs because of the following scenario:
-// - client gets several jobs in a sched reply and starts downloading files
-// - a later job finishes downloading and starts
-// - an earlier finishes downloading and preempts
-//
-RESULT* first_coproc_result(int rsc_type) {
-    unsigned int i;
-    RESULT* best = NULL;
-    double best_prio=0, prio;
-    for (i=0; i<gstate.results.size(); i++) {
-        RESULT* rp = gstate.results[i];
-        if (rp->resource_type() != rsc_type) continue;
-        if (!rp->runnable()) {
-            //msg_printf(rp->project, MSG_INFO, "not runnable: %s", rp->name);
-            continue;
-        }
-        if (rp->non_cpu_intensive()) continue;
-        if (rp->already_selected) continue;
-        prio = rp->project->sched_priority;
-        if (!best) {
-            best = rp;
-            best_prio = prio;
-            continue;
-        }
-
-        if (prio < best_prio) {
-            continue;
-        }
-        if (prio > best_prio) {
-            best = rp;
-            best_prio = prio;
-            continue;
-        }
-
-        bool bs = !best->not_started;
-        bool rs = !rp->not_started;
-        if (rs && !bs) {
-            best = rp;
-            best_prio = prio;
-            continue;
-        }
-        if (!rs && bs) {
-            continue;
-        }
-
-        // else used "arrived first" order
-        //
-        if (rp->index < best->index) {
-            best = rp;
-            best_prio = prio;
+RESULT* RUN_LIST_CANDIDATES::first_coproc_result(int rsc_type) {
+    PROJECT_JOBS* best = NULL;
+    RESULT* best_rp = NULL;
+
+    for (unsigned int i=0; i<fifo[rsc_type].size(); i++) {
+        PROJECT_JOBS& pj = fifo[rsc_type][i];
+        RESULT* rp = pj.head();
+        if (!rp) continue;
+        if (best) {
+            double prio = pj.p->sched_priority;
+            double best_prio = best->p->sched_priority;
+            if (prio < best_prio) continue;
+            if (prio == best_prio && !coproc_fifo_before(rp, best_rp)) {
+                continue;
+            }
         }
+        best = &pj;
+        best_rp = rp;
     }
-    return best;
+    if (!best) return NULL;
+    best->next++;
+    return best_rp;
 }
 
 // Return earliest-deadline result for given resource type;
 // return only results projected to miss their deadline,
-// or from projects with extreme DCF
+// or from projects with extreme DCF.
+// Jobs skipped here are never eligible later in the same pass
+// (deadlines_missed_copy only decreases)
 //
-static RESULT* earliest_deadline_result(int rsc_type) {
-    RESULT *best_result = NULL;
-    ACTIVE_TASK* best_atp = NULL;
-    unsigned int i;
-
-    for (i=0; i<gstate.results.size(); i++) {
-        RESULT* rp = gstate.results[i];
-        if (rp->resource_type() != rsc_type) continue;
+RESULT* RUN_LIST_CANDIDATES::earliest_deadline_result(int rsc_type) {
+    vector<RESULT*>& v = edf[rsc_type];
+    size_t& next = edf_next[rsc_type];
+    while (next < v.size()) {
+        RESULT* rp = v[next++];
         if (rp->already_selected) continue;
-        if (!rp->runnable()) continue;
-        if (rp->non_cpu_intensive()) continue;
         PROJECT* p = rp->project;
 
         // Skip this job if the project's deadline-miss count is zero.
@@ -511,39 +582,9 @@ static RESULT* earliest_deadline_result(int rsc_type) {
                 continue;
             }
         }
-
-        bool new_best = false;
-        if (best_result) {
-            if (rp->report_deadline < best_result->report_deadline) {
-                new_best = true;
-            }
-        } else {
-            new_best = true;
-        }
-        if (new_best) {
-            best_result = rp;
-            best_atp = gstate.lookup_active_task_by_result(rp);
-            continue;
-        }
-        if (rp->report_deadline > best_result->report_deadline) {
-            continue;
-        }
-
-        // If there's a tie, pick the job with the least remaining time
-        // (but don't pick an unstarted job over one that's started)
-        //
-        ACTIVE_TASK* atp = gstate.lookup_active_task_by_result(rp);
-        if (best_atp && !atp) continue;
-        if (rp->estimated_runtime_remaining() < best_result->estimated_runtime_remaining()
-            || (!best_atp && atp)
-        ) {
-            best_result = rp;
-            best_atp = atp;
-        }
+        return rp;
     }
-    if (!best_result) return NULL;
-
-    return best_result;
+    return NULL;
 }
 
 void CLIENT_STATE::reset_rec_accounting() {
@@ -750,6 +791,38 @@ void CLIENT_STATE::adjust_rec() {
 }
 
 
+// histogram of the time taken by a scheduling pass
+// (make_run_list() plus enforce_run_list()),
+// shown with <cpu_sched_debug>
+//
+#define SCHED_LATENCY_NBINS 6
+
+struct SCHED_LATENCY {
+    int count[SCHED_LATENCY_NBINS];
+        // < 0.1 ms, < 1 ms, < 10 ms, < 100 ms, < 1 sec, longer
+
+    SCHED_LATENCY() {
+        memset(count, 0, sizeof(count));
+    }
+    void update(double dt) {
+        int i;
+        double limit = 1e-4;
+        for (i=0; i<SCHED_LATENCY_NBINS-1; i++) {
+            if (dt < limit) break;
+            limit *= 10;
+        }
+        count[i]++;
+    }
+    void print(double dt) {
+        msg_printf(0, MSG_INFO,
+            "[cpu_sched_debug] schedule_cpus(): took %.3f ms; history: <0.1ms %d, <1ms %d, <10ms %d, <100ms %d, <1s %d, >1s %d",
+            dt*1000, count[0], count[1], count[2], count[3], count[4], count[5]
+        );
+    }
+};
+
+static SCHED_LATENCY sched_latency;
+
 // Possibly do job scheduling.
 // This is called periodically.
 //
@@ -780,8 +853,15 @@ bool CLIENT_STATE::schedule_cpus() {
     //
     adjust_rec();
 
+    double t = dtime();
     make_run_list(run_list);
-    return enforce_run_list(run_list);
+    bool action = enforce_run_list(run_list);
+    t = dtime() - t;
+    sched_latency.update(t);
+    if (log_flags.cpu_sched_debug) {
+        sched_latency.print(t);
+    }
+    return action;
 }
 
 // Mark a job J as a deadline miss if either
@@ -823,8 +903,9 @@ static void promote_once_ran_edf() {
     }
 }
 
-void add_coproc_jobs(
-    vector<RESULT*>& run_list, int rsc_type, PROC_RESOURCES& proc_rsc
+static void add_coproc_jobs(
+    vector<RESULT*>& run_list, int rsc_type, PROC_RESOURCES& proc_rsc,
+    RUN_LIST_CANDIDATES& cands
 ) {
     ACTIVE_TASK* atp;
     RESULT* rp;
@@ -835,10 +916,10 @@ void add_coproc_jobs(
     // choose coproc jobs from projects with coproc deadline misses
     //
     while (!proc_rsc.stop_scan_coproc(rsc_type)) {
-        rp = earliest_deadline_result(rsc_type);
+        rp = cands.earliest_deadline_result(rsc_type);
         if (!rp) break;
         rp->already_selected = true;
-        atp = gstate.lookup_active_task_by_result(rp);
+        atp = cands.lookup_task(rp);
         if (!proc_rsc.can_schedule(rp, atp)) continue;
         proc_rsc.schedule(rp, atp, true);
         rp->project->rsc_pwf[rsc_type].deadlines_missed_copy--;
@@ -852,10 +933,10 @@ void add_coproc_jobs(
     // then coproc jobs in FIFO order
     //
     while (!proc_rsc.stop_scan_coproc(rsc_type)) {
-        rp = first_coproc_result(rsc_type);
+        rp = cands.first_coproc_result(rsc_type);
         if (!rp) break;
         rp->already_selected = true;
-        atp = gstate.lookup_active_task_by_result(rp);
+        atp = cands.lookup_task(rp);
         if (!proc_rsc.can_schedule(rp, atp)) continue;
         proc_rsc.schedule(rp, atp, false);
         run_list.push_back(rp);
@@ -870,6 +951,7 @@ void CLIENT_STATE::make_run_list(vector<RESULT*>& run_list) {
     unsigned int i;
     PROC_RESOURCES proc_rsc;
     ACTIVE_TASK* atp;
+    RUN_LIST_CANDIDATES cands;
 
     if (log_flags.cpu_sched_debug) {
         msg_printf(0, MSG_INFO, "[cpu_sched_debug] schedule_cpus(): start");
@@ -899,7 +981,6 @@ void CLIENT_STATE::make_run_list(vector<RESULT*>& run_list) {
     }
     for (i=0; i<projects.size(); i++) {
         p = projects[i];
-        p->next_runnable_result = NULL;
         for (int j=0; j<coprocs.n_rsc; j++) {
             p->rsc_pwf[j].deadlines_missed_copy = p->rsc_pwf[j].deadlines_missed;
         }
@@ -922,10 +1003,12 @@ void CLIENT_STATE::make_run_list(vector<RESULT*>& run_list) {
         atp->result->not_started = false;
     }
 
+    cands.init();
+
     // first, add GPU jobs
 
     for (int j=1; j<coprocs.n_rsc; j++) {
-        add_coproc_jobs(run_list, j, proc_rsc);
+        add_coproc_jobs(run_list, j, proc_rsc, cands);
     }
 
     // enforce max concurrent specs for CPU jobs,
@@ -948,13 +1031,13 @@ void CLIENT_STATE::make_run_list(vector<RESULT*>& run_list) {
     if (!cpu_sched_rr_only) {
 #endif
     while (!proc_rsc.stop_scan_cpu()) {
-        rp = earliest_deadline_result(RSC_TYPE_CPU);
+        rp = cands.earliest_deadline_result(RSC_TYPE_CPU);
         if (!rp) break;
         rp->already_selected = true;
         if (have_max_concurrent && max_concurrent_exceeded(rp)) {
             continue;
         }
-        atp = lookup_active_task_by_result(rp);
+        atp = cands.lookup_task(rp);
         if (!proc_rsc.can_schedule(rp, atp)) continue;
         proc_rsc.schedule(rp, atp, true);
         rp->project->rsc_pwf[0].deadlines_missed_copy--;
@@ -974,15 +1057,14 @@ void CLIENT_STATE::make_run_list(vector<RESULT*>& run_list) {
         if (proc_rsc.stop_scan_cpu()) {
             break;
         }
-        assign_results_to_projects();
-        rp = highest_prio_project_best_result();
+        rp = cands.highest_prio_project_best_result();
         if (!rp) {
             break;
         }
         if (have_max_concurrent && max_concurrent_exceeded(rp)) {
             continue;
         }
-        atp = lookup_active_task_by_result(rp);
+        atp = cands.lookup_task(rp);
         if (!proc_rsc.can_schedule(rp, atp)) continue;
         proc_rsc.schedule(rp, atp, false);
         run_list.push_back(rp);
@@ -1511,7 +1593,11 @@ bool CLIENT_STATE::enforce_run_list(vector<RESULT*>& run_list) {
 
     }
     if (action) {
+#ifdef SIM
         set_client_state_dirty("enforce_cpu_schedule");
+#else
+        journal_active_tasks("enforce_cpu_schedule");
+#endif
     }
     if (log_flags.cpu_sched_debug) {
         msg_printf(0, MSG_INFO, "[cpu_sched_debug] enforce_run_list: end");
@@ -43,6 +43,7 @@
 #include "client_types.h"
 #include "client_state.h"
 #include "client_msgs.h"
+#include "content_store.h"
 #include "file_xfer.h"
 #include "project.h"
 #include "result.h"
@@ -73,6 +74,12 @@ bool CLIENT_STATE::start_new_file_xfer(PERS_FILE_XFER& pfx) {
         if (fip->is_user_file) continue;
         if (fip->is_project_file) continue;
 
+        // count a download in ranges once
+        //
+        if (fip->pers_file_xfer && fip->pers_file_xfer->active_xfer() != fxp) {
+            continue;
+        }
+
         // count transfers in the same direction as this
         //
         if (pfx.is_upload == fxp->is_upload) {
@@ -436,6 +443,9 @@ bool CLIENT_STATE::create_and_delete_pers_file_xfers() {
                     //
                     retval = fip->set_permissions();
                     fip->status = FILE_PRESENT;
+#ifndef _WIN32
+                    content_store.add_file(fip);
+#endif
                 }
 
                 // if it's a user file, tell running apps to reread prefs
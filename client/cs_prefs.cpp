@@ -43,6 +43,7 @@
 #include "client_msgs.h"
 #include "client_state.h"
 #include "cpu_benchmark.h"
+#include "disk_usage.h"
 #include "file_names.h"
 #include "project.h"
 
@@ -90,14 +91,22 @@ int CLIENT_STATE::get_disk_usages() {
     for (i=0; i<projects.size(); i++) {
         p = projects[i];
         p->disk_usage = 0;
+#ifdef __linux__
+        retval = disk_usage_tracker.get_usage(p->project_dir(), size, true);
+#else
         retval = dir_size_alloc(p->project_dir(), size);
+#endif
         if (!retval) p->disk_usage = size;
     }
 
     for (i=0; i<active_tasks.active_tasks.size(); i++) {
         ACTIVE_TASK* atp = active_tasks.active_tasks[i];
         get_slot_dir(atp->slot, buf, sizeof(buf));
+#ifdef __linux__
+        retval = disk_usage_tracker.get_usage(buf, size, true);
+#else
         retval = dir_size_alloc(buf, size);
+#endif
         if (retval) continue;
         atp->wup->project->disk_usage += size;
     }
@@ -569,6 +578,7 @@ int PROJECT::parse_preferences_for_user_files() {
             safe_strcpy(fip->name, filename.c_str());
             fip->is_user_file = true;
             gstate.file_infos.push_back(fip);
+            gstate.file_info_index.add(fip);
         }
 
         fr.file_info = fip;
@@ -38,6 +38,7 @@
 #include "error_numbers.h"
 #include "file_names.h"
 #include "filesys.h"
+#include "list_delta.h"
 #include "parse.h"
 #include "str_util.h"
 #include "str_replace.h"
@@ -252,13 +253,18 @@ int CLIENT_STATE::make_scheduler_request(PROJECT* p) {
 
     read_trickle_files(p, f);
 
-    // report sticky files as needed
+    // report sticky files as needed.
+    // If the scheduler has our previous lists of sticky files
+    // and other results, send only what has changed (see below)
     //
+    bool send_list_delta = !p->sched_lists_acked.digest.empty();
+    SCHED_LISTS& sl = p->sched_lists_sent;
+    sl.clear();
     for (i=0; i<file_infos.size(); i++) {
         FILE_INFO* fip = file_infos[i];
         if (fip->project != p) continue;
         if (!fip->sticky) continue;
-        fprintf(f,
+        snprintf(buf, sizeof(buf),
             "    <file_info>\n"
             "        <name>%s</name>\n"
             "        <nbytes>%f</nbytes>\n"
@@ -266,6 +272,8 @@ int CLIENT_STATE::make_scheduler_request(PROJECT* p) {
             "    </file_info>\n",
             fip->name, fip->nbytes, fip->status
         );
+        sl.items[string("f:") + fip->name] = buf;
+        if (!send_list_delta) fputs(buf, f);
     }
 
     if (p->send_time_stats_log) {
@@ -294,32 +302,77 @@ int CLIENT_STATE::make_scheduler_request(PROJECT* p) {
 
     // send descriptions of jobs in progress for this project
     //
-    fprintf(f, "<other_results>\n");
+    if (!send_list_delta) fprintf(f, "<other_results>\n");
     for (i=0; i<results.size(); i++) {
         rp = results[i];
         if (rp->project != p) continue;
         if ((last_reported_index && (i > last_reported_index)) || !rp->ready_to_report) {
-            fprintf(f,
+            snprintf(buf, sizeof(buf),
                 "    <other_result>\n"
                 "        <name>%s</name>\n"
                 "        <app_version>%d</app_version>\n",
                 rp->name,
                 rp->avp->index
             );
+            string s = buf;
             // the following is for backwards compatibility w/ old schedulers
             //
             if (strlen(rp->avp->plan_class)) {
-                fprintf(f,
+                snprintf(buf, sizeof(buf),
                     "        <plan_class>%s</plan_class>\n",
                     rp->avp->plan_class
                 );
+                s += buf;
             }
-            fprintf(f,
-                "    </other_result>\n"
+            s += "    </other_result>\n";
+            sl.items[string("r:") + rp->name] = s;
+            if (!send_list_delta) fputs(s.c_str(), f);
+        }
+    }
+    if (!send_list_delta) fprintf(f, "</other_results>\n");
+
+    // Label the lists with their digest.
+    // If the scheduler stores them, it will acknowledge the digest,
+    // and in the next request we send only the entries
+    // added or changed since then, and the names of those removed.
+    // If it doesn't have the lists we started from
+    // it won't acknowledge, and we send full lists next time.
+    //
+    sl.digest = list_digest(sl.items);
+    if (send_list_delta) {
+        SCHED_LISTS& base = p->sched_lists_acked;
+        std::map<string, string> changed;
+        vector<string> removed;
+        make_list_delta(base.items, sl.items, changed, removed);
+        fprintf(f,
+            "<list_delta>\n"
+            "    <base_digest>%s</base_digest>\n"
+            "    <digest>%s</digest>\n",
+            base.digest.c_str(), sl.digest.c_str()
+        );
+        std::map<string, string>::iterator it;
+        for (it = changed.begin(); it != changed.end(); ++it) {
+            fputs(it->second.c_str(), f);
+        }
+        for (i=0; i<removed.size(); i++) {
+            const char* name = removed[i].c_str() + 2;
+            if (removed[i][0] == 'f') {
+                fprintf(f, "    <remove_file_info>%s</remove_file_info>\n", name);
+            } else {
+                fprintf(f, "    <remove_other_result>%s</remove_other_result>\n", name);
+            }
+        }
+        fprintf(f, "</list_delta>\n");
+        if (log_flags.sched_op_debug) {
+            msg_printf(p, MSG_INFO,
+                "[sched_op] sending changes to file and job lists: %d changed, %d removed, %d unchanged",
+                (int)changed.size(), (int)removed.size(),
+                (int)(sl.items.size() - changed.size())
             );
         }
+    } else {
+        fprintf(f, "<list_digest>%s</list_digest>\n", sl.digest.c_str());
     }
-    fprintf(f, "</other_results>\n");
 
     // if requested by project, send summary of all in-progress results
     // (for EDF simulation by scheduler)
@@ -824,6 +877,7 @@ int CLIENT_STATE::handle_scheduler_reply(
                 delete app;
             } else {
                 apps.push_back(app);
+                app_index.add(app);
             }
         }
     }
@@ -846,6 +900,7 @@ int CLIENT_STATE::handle_scheduler_reply(
                 delete fip;
             } else {
                 file_infos.push_back(fip);
+                file_info_index.add(fip);
             }
         }
     }
@@ -936,6 +991,7 @@ int CLIENT_STATE::handle_scheduler_reply(
         }
         wup->clear_errors();
         workunits.push_back(wup);
+        workunit_index.add(wup);
     }
     double est_rsc_runtime[MAX_RSC];
     bool got_work_for_rsc[MAX_RSC];
@@ -1005,6 +1061,7 @@ int CLIENT_STATE::handle_scheduler_reply(
         rp->received_time = now;
         new_results.push_back(rp);
         results.push_back(rp);
+        result_index.add(rp);
     }
 
     // find the resources for which we requested work and didn't get any
@@ -1101,6 +1158,24 @@ int CLIENT_STATE::handle_scheduler_reply(
     project->send_job_log = sr.send_job_log;
     project->trickle_up_pending = false;
 
+    // if the scheduler stored the lists of sticky files and other results
+    // we sent, send only changes to them next time
+    //
+    if (!project->sched_lists_sent.digest.empty()
+        && project->sched_lists_sent.digest == sr.list_digest_ack
+    ) {
+        project->sched_lists_acked.items.swap(project->sched_lists_sent.items);
+        project->sched_lists_acked.digest = project->sched_lists_sent.digest;
+    } else {
+        if (sr.send_full_lists && log_flags.sched_op_debug) {
+            msg_printf(project, MSG_INFO,
+                "[sched_op] scheduler doesn't have our file and job lists; will send them"
+            );
+        }
+        project->sched_lists_acked.clear();
+    }
+    project->sched_lists_sent.clear();
+
     // The project returns a hostid only if it has created a new host record.
     // In that case reset RPC seqno
     //
@@ -22,6 +22,7 @@
 #include "config.h"
 #include <cstring>
 #include <errno.h>
+#include <unistd.h>
 #endif
 
 #ifdef __APPLE__
@@ -45,6 +46,9 @@
 
 #define MAX_STATE_FILE_WRITE_ATTEMPTS 2
 
+#define MAX_JOURNAL_RECORDS 1000
+    // do a full state file write after this many journal records
+
 void CLIENT_STATE::set_client_state_dirty(const char* source) {
     if (log_flags.statefile_debug) {
         msg_printf(0, MSG_INFO, "[statefile] set dirty: %s\n", source);
@@ -114,7 +118,26 @@ int CLIENT_STATE::parse_state_file() {
         old_release = BOINC_RELEASE;
         return ERR_FOPEN;
     }
-    return parse_state_file_aux(fname);
+    double t = dtime();
+    int retval = parse_state_file_aux(fname);
+#ifndef SIM
+    // the journal has changes to the current state file.
+    // If we couldn't read that, they don't apply
+    //
+    if (!retval && strcmp(fname, STATE_FILE_PREV)) {
+        replay_journal();
+    } else {
+        truncate_journal();
+    }
+#endif
+    if (log_flags.statefile_debug) {
+        msg_printf(0, MSG_INFO,
+            "[statefile] parsed %s in %.3f sec: %d files, %d workunits, %d tasks",
+            fname, dtime()-t, (int)file_infos.size(), (int)workunits.size(),
+            (int)results.size()
+        );
+    }
+    return retval;
 }
 
 int CLIENT_STATE::parse_state_file_aux(const char* fname) {
@@ -122,11 +145,14 @@ int CLIENT_STATE::parse_state_file_aux(const char* fname) {
     int retval=0;
     string stemp;
 
-    FILE* f = fopen(fname, "r");
-    if (!f) return ERR_FOPEN;
+    // read the whole file and parse from memory;
+    // this is much faster than reading it a character at a time
+    //
+    char* state_buf;
+    if (read_file_malloc(fname, state_buf)) return ERR_FOPEN;
     MIOFILE mf;
     XML_PARSER xp(&mf);
-    mf.init_file(f);
+    mf.init_buf_read(state_buf);
     while (!xp.get_tag()) {
         if (xp.match_tag("/client_state")) {
             break;
@@ -190,6 +216,7 @@ int CLIENT_STATE::parse_state_file_aux(const char* fname) {
                 continue;
             }
             apps.push_back(app);
+            app_index.add(app);
             continue;
         }
         if (xp.match_tag("file_info") || xp.match_tag("file")) {
@@ -223,6 +250,7 @@ int CLIENT_STATE::parse_state_file_aux(const char* fname) {
                 continue;
             }
             file_infos.push_back(fip);
+            file_info_index.add(fip);
 #ifndef SIM
             // If the file had a failure before,
             // don't start another file transfer
@@ -332,6 +360,7 @@ int CLIENT_STATE::parse_state_file_aux(const char* fname) {
                 continue;
             }
             workunits.push_back(wup);
+            workunit_index.add(wup);
             continue;
         }
         if (xp.match_tag("result")) {
@@ -393,6 +422,7 @@ int CLIENT_STATE::parse_state_file_aux(const char* fname) {
             }
             rp->wup->version_num = rp->version_num;
             results.push_back(rp);
+            result_index.add(rp);
             continue;
         }
         if (xp.match_tag("project_files")) {
@@ -502,6 +532,9 @@ int CLIENT_STATE::parse_state_file_aux(const char* fname) {
         if (xp.parse_double("new_version_check_time", new_version_check_time)) {
             continue;
         }
+        if (xp.parse_int("journal_seqno", journal_seqno)) {
+            continue;
+        }
         if (xp.parse_double("all_projects_list_check_time", all_projects_list_check_time)) {
             continue;
         }
@@ -535,7 +568,7 @@ int CLIENT_STATE::parse_state_file_aux(const char* fname) {
         xp.skip_unexpected();
     }
     sort_results();
-    fclose(f);
+    free(state_buf);
     
     // if total resource share is zero, set all shares to 1
     //
@@ -692,7 +725,16 @@ int CLIENT_STATE::write_state_file() {
                 "[statefile] Done writing state file"
             );
         }
-        if (!retval) break;     // Success!
+        if (!retval) {
+            // the new state file includes everything in the journal
+            //
+            truncate_journal();
+            for (unsigned int i=0; i<active_tasks.active_tasks.size(); i++) {
+                ACTIVE_TASK* atp = active_tasks.active_tasks[i];
+                atp->saved_task_state = atp->task_state();
+            }
+            break;     // Success!
+        }
         
         if ((attempt == MAX_STATE_FILE_WRITE_ATTEMPTS) || log_flags.statefile_debug) {
 #ifdef _WIN32
@@ -778,7 +820,8 @@ int CLIENT_STATE::write_state(MIOFILE& f) {
         "<user_gpu_prev_request>%d</user_gpu_prev_request>\n"
         "<user_network_request>%d</user_network_request>\n"
         "<new_version_check_time>%f</new_version_check_time>\n"
-        "<all_projects_list_check_time>%f</all_projects_list_check_time>\n",
+        "<all_projects_list_check_time>%f</all_projects_list_check_time>\n"
+        "<journal_seqno>%d</journal_seqno>\n",
         get_primary_platform(),
         core_client_version.major,
         core_client_version.minor,
@@ -789,7 +832,8 @@ int CLIENT_STATE::write_state(MIOFILE& f) {
         gpu_run_mode.get_prev(),
         network_run_mode.get_perm(),
         new_version_check_time,
-        all_projects_list_check_time
+        all_projects_list_check_time,
+        journal_seqno
     );
     if (strlen(language)) {
         f.printf("<language>%s</language>\n", language);
@@ -826,6 +870,144 @@ int CLIENT_STATE::write_state_file_if_needed() {
     return 0;
 }
 
+// The state journal.
+// Rewriting client_state.xml is expensive if there are lots of jobs,
+// so frequent, self-contained changes are instead appended
+// to a journal file as <journal_record> elements.
+// The journal is replayed on startup after reading the state file,
+// and is deleted after each full write of the state file.
+// Records have sequence numbers, and the state file has the number
+// of the last record it includes,
+// so records left over from a crash after a full write are ignored.
+// Each batch of records is fsync()ed, as full writes are;
+// a crash can lose only a batch that's being written.
+//
+// Currently journaled: active task state changes
+// (e.g. tasks started or preempted by the CPU scheduler).
+
+// write records for active tasks whose state has changed
+// since they were last saved.
+// If we can't write to the journal, do a full write.
+//
+void CLIENT_STATE::journal_active_tasks(const char* source) {
+    unsigned int i;
+    int n = 0;
+
+    if (journal_nrecords >= MAX_JOURNAL_RECORDS) {
+        set_client_state_dirty(source);
+        return;
+    }
+    if (!journal_file) {
+        journal_file = boinc_fopen(STATE_JOURNAL_FILE, "a");
+        if (!journal_file) {
+            set_client_state_dirty(source);
+            return;
+        }
+    }
+    MIOFILE mf;
+    mf.init_file(journal_file);
+    for (i=0; i<active_tasks.active_tasks.size(); i++) {
+        ACTIVE_TASK* atp = active_tasks.active_tasks[i];
+        if (atp->task_state() == atp->saved_task_state) continue;
+        mf.printf(
+            "<journal_record>\n"
+            "    <seqno>%d</seqno>\n",
+            journal_seqno+1
+        );
+        atp->write(mf);
+        mf.printf("</journal_record>\n");
+        journal_seqno++;
+        journal_nrecords++;
+        atp->saved_task_state = atp->task_state();
+        n++;
+    }
+    if (!n) return;
+    bool failed = fflush(journal_file) || ferror(journal_file);
+#ifndef _WIN32
+    if (!failed && fsync(fileno(journal_file)) < 0) failed = true;
+#endif
+    if (failed) {
+        msg_printf(NULL, MSG_INTERNAL_ERROR, "Can't write state journal");
+        truncate_journal();
+        set_client_state_dirty(source);
+        return;
+    }
+    if (log_flags.statefile_debug) {
+        msg_printf(0, MSG_INFO,
+            "[statefile] journaled %d task(s): %s", n, source
+        );
+    }
+}
+
+// apply journal records newer than the state file.
+// Count all the records, so that we know when to do a full write.
+//
+int CLIENT_STATE::replay_journal() {
+    int seqno = 0, n = 0, retval;
+
+    journal_nrecords = 0;
+    FILE* f = boinc_fopen(STATE_JOURNAL_FILE, "r");
+    if (!f) return 0;
+    MIOFILE mf;
+    XML_PARSER xp(&mf);
+    mf.init_file(f);
+
+    // a crash may leave a partial record at the end;
+    // parsing just stops there
+    //
+    while (!xp.get_tag()) {
+        if (xp.match_tag("journal_record")) {
+            seqno = 0;
+            journal_nrecords++;
+            continue;
+        }
+        if (xp.parse_int("seqno", seqno)) continue;
+        if (xp.match_tag("active_task")) {
+            ACTIVE_TASK* atp = new ACTIVE_TASK;
+            retval = atp->parse(xp);
+            if (retval || seqno <= journal_seqno) {
+                delete atp;
+                continue;
+            }
+            journal_seqno = seqno;
+            ACTIVE_TASK* old = active_tasks.lookup_result(atp->result);
+            if (old) {
+                if (old->slot != atp->slot && active_tasks.slot_taken(atp->slot)) {
+                    delete atp;
+                    continue;
+                }
+                for (unsigned int i=0; i<active_tasks.active_tasks.size(); i++) {
+                    if (active_tasks.active_tasks[i] == old) {
+                        active_tasks.active_tasks[i] = atp;
+                    }
+                }
+                delete old;
+            } else {
+                if (active_tasks.slot_taken(atp->slot)) {
+                    delete atp;
+                    continue;
+                }
+                active_tasks.active_tasks.push_back(atp);
+            }
+            n++;
+        }
+    }
+    fclose(f);
+    if (n) {
+        msg_printf(0, MSG_INFO, "Applied %d records from state journal", n);
+    }
+    return 0;
+}
+
+void CLIENT_STATE::truncate_journal() {
+    if (journal_file) {
+        fclose(journal_file);
+        journal_file = NULL;
+    }
+    boinc_delete_file(STATE_JOURNAL_FILE);
+    journal_nrecords = 0;
+}
+
 #endif // ifndef SIM
 
 // look for app_versions.xml file in project dir.
@@ -909,6 +1091,7 @@ int CLIENT_STATE::parse_app_info(PROJECT* p, FILE* in) {
             fip->status = FILE_PRESENT;
             fip->anonymous_platform_file = true;
             file_infos.push_back(fip);
+            file_info_index.add(fip);
             continue;
         }
         if (xp.match_tag("app")) {
@@ -923,6 +1106,7 @@ int CLIENT_STATE::parse_app_info(PROJECT* p, FILE* in) {
             }
             link_app(p, app);
             apps.push_back(app);
+            app_index.add(app);
             continue;
         }
         if (xp.match_tag("app_version")) {
@@ -0,0 +1,302 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+// Incremental disk usage accounting; see disk_usage.h
+
+#include "config.h"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/inotify.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error_numbers.h"
+#include "filesys.h"
+#include "util.h"
+
+#include "client_msgs.h"
+#include "client_state.h"
+
+#include "disk_usage.h"
+
+using std::string;
+
+DISK_USAGE_TRACKER disk_usage_tracker;
+
+#define DU_EVENTS (IN_CREATE|IN_DELETE|IN_MODIFY|IN_CLOSE_WRITE|IN_ATTRIB \
+    |IN_MOVED_FROM|IN_MOVED_TO|IN_ONLYDIR)
+
+void DISK_USAGE_TRACKER::init() {
+    fd = inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+}
+
+// start watching a directory, and get the sizes of its files.
+// Do the same for its subdirectories.
+// On failure, undo whatever was done.
+//
+int DISK_USAGE_TRACKER::add_dir(const char* tree, const char* path, int& wd) {
+    char name[256], subpath[MAXPATHLEN];
+    int retval = 0;
+
+    wd = inotify_add_watch(fd, path, DU_EVENTS);
+    if (wd < 0) {
+        return (errno == ENOSPC)?ERR_MALLOC:ERR_OPENDIR;
+    }
+    if (dirs.count(wd)) {
+        // we're already watching this dir under another name
+        //
+        return ERR_ALREADY_ATTACHED;
+    }
+    DU_DIR& d = dirs[wd];
+    d.tree = tree;
+    d.path = path;
+    DIRREF dirp = dir_open(path);
+    if (!dirp) {
+        remove_dir(wd);
+        return ERR_OPENDIR;
+    }
+    while (!dir_scan(name, dirp, sizeof(name))) {
+        snprintf(subpath, sizeof(subpath), "%s/%s", path, name);
+        if (is_dir(subpath)) {
+            int swd;
+            retval = add_dir(tree, subpath, swd);
+            if (retval) break;
+            d.subdirs[name] = swd;
+        } else {
+            update_file(d, name);
+        }
+    }
+    dir_close(dirp);
+    if (retval) {
+        remove_dir(wd);
+    }
+    return retval;
+}
+
+// stop watching a directory and its subdirectories,
+// and subtract their files from the tree's usage
+//
+void DISK_USAGE_TRACKER::remove_dir(int wd) {
+    std::map<int, DU_DIR>::iterator i = dirs.find(wd);
+    if (i == dirs.end()) return;
+    DU_DIR& d = i->second;
+    std::map<string, int>::iterator j;
+    for (j = d.subdirs.begin(); j != d.subdirs.end(); ++j) {
+        remove_dir(j->second);
+    }
+    std::map<string, DU_TREE>::iterator t = trees.find(d.tree);
+    if (t != trees.end()) {
+        std::map<string, DU_FILE>::iterator k;
+        for (k = d.files.begin(); k != d.files.end(); ++k) {
+            t->second.size -= k->second.size;
+            t->second.alloc -= k->second.alloc;
+        }
+    }
+    inotify_rm_watch(fd, wd);
+    dirs.erase(i);
+    changed_dirs.erase(wd);
+}
+
+// stat a file and update its entry and the tree's usage
+//
+void DISK_USAGE_TRACKER::update_file(DU_DIR& d, const string& name) {
+    char path[MAXPATHLEN];
+    struct stat sbuf;
+    DU_TREE& t = trees[d.tree];
+
+    std::map<string, DU_FILE>::iterator i = d.files.find(name);
+    if (i != d.files.end()) {
+        t.size -= i->second.size;
+        t.alloc -= i->second.alloc;
+        d.files.erase(i);
+    }
+    snprintf(path, sizeof(path), "%s/%s", d.path.c_str(), name.c_str());
+    if (stat(path, &sbuf)) return;
+    if (!S_ISREG(sbuf.st_mode)) return;
+    DU_FILE f;
+    f.size = (double)sbuf.st_size;
+    f.alloc = ((double)sbuf.st_blocks)*512.;
+    d.files[name] = f;
+    t.size += f.size;
+    t.alloc += f.alloc;
+}
+
+void DISK_USAGE_TRACKER::update_changed() {
+    std::set<int>::iterator i;
+    for (i = changed_dirs.begin(); i != changed_dirs.end(); ++i) {
+        std::map<int, DU_DIR>::iterator j = dirs.find(*i);
+        if (j == dirs.end()) continue;
+        DU_DIR& d = j->second;
+        std::set<string>::iterator k;
+        for (k = d.changed.begin(); k != d.changed.end(); ++k) {
+            update_file(d, *k);
+        }
+        d.changed.clear();
+    }
+    changed_dirs.clear();
+}
+
+// stop tracking everything; trees will be rescanned when next asked for
+//
+void DISK_USAGE_TRACKER::clear() {
+    std::map<int, DU_DIR>::iterator i;
+    for (i = dirs.begin(); i != dirs.end(); ++i) {
+        inotify_rm_watch(fd, i->first);
+    }
+    dirs.clear();
+    trees.clear();
+    changed_dirs.clear();
+}
+
+void DISK_USAGE_TRACKER::remove_tree(const char* path) {
+    std::map<string, DU_TREE>::iterator t = trees.find(path);
+    if (t == trees.end()) return;
+    remove_dir(t->second.root_wd);
+    trees.erase(path);
+}
+
+// Read pending inotify events.
+// File events just mark the file as changed;
+// we stat it when the tree's usage is asked for.
+// Called once a second, so that the kernel's event queue doesn't overflow.
+//
+void DISK_USAGE_TRACKER::poll() {
+    char buf[65536] __attribute__((aligned(__alignof__(struct inotify_event))));
+    char path[MAXPATHLEN];
+    bool overflow = false;
+    ssize_t n;
+
+    if (fd < 0) return;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        char* p = buf;
+        while (p < buf + n) {
+            struct inotify_event* ev = (struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+            std::map<int, DU_DIR>::iterator i = dirs.find(ev->wd);
+            if (i == dirs.end()) continue;
+            DU_DIR& d = i->second;
+
+            // the dir itself was deleted.
+            // If it's the root of a tree, forget the tree.
+            //
+            if (ev->mask & IN_IGNORED) {
+                string tree = d.tree;
+                std::map<string, DU_TREE>::iterator t = trees.find(tree);
+                remove_dir(ev->wd);
+                if (t != trees.end() && t->second.root_wd == ev->wd) {
+                    trees.erase(t);
+                }
+                continue;
+            }
+            if (!ev->len) continue;
+            string name = ev->name;
+            if (ev->mask & IN_ISDIR) {
+                if (ev->mask & (IN_DELETE|IN_MOVED_FROM)) {
+                    std::map<string, int>::iterator j = d.subdirs.find(name);
+                    if (j != d.subdirs.end()) {
+                        remove_dir(j->second);
+                        d.subdirs.erase(j);
+                    }
+                }
+                if (ev->mask & (IN_CREATE|IN_MOVED_TO)) {
+                    int swd;
+                    snprintf(path, sizeof(path), "%s/%s",
+                        d.path.c_str(), name.c_str()
+                    );
+                    if (add_dir(d.tree.c_str(), path, swd)) {
+                        overflow = true;
+                    } else {
+                        d.subdirs[name] = swd;
+                    }
+                }
+            } else {
+                d.changed.insert(name);
+                changed_dirs.insert(ev->wd);
+            }
+        }
+    }
+    if (overflow) {
+        if (log_flags.disk_usage_debug) {
+            msg_printf(NULL, MSG_INFO,
+                "[disk_usage] lost track of changes; will rescan"
+            );
+        }
+        clear();
+    }
+}
+
+// get the total size (or allocated size) of the files
+// in a directory tree
+//
+int DISK_USAGE_TRACKER::get_usage(const char* path, double& size, bool alloc) {
+    int retval;
+
+    if (fd >= 0) {
+        poll();
+        update_changed();
+        std::map<string, DU_TREE>::iterator t = trees.find(path);
+        if (t != trees.end()
+            && gstate.now - t->second.scan_time > DISK_USAGE_RESCAN_PERIOD
+        ) {
+            remove_tree(path);
+            t = trees.end();
+        }
+        if (t == trees.end()) {
+            double start = dtime();
+            DU_TREE& nt = trees[path];
+            nt.size = 0;
+            nt.alloc = 0;
+            nt.scan_time = gstate.now;
+            retval = add_dir(path, path, nt.root_wd);
+            if (retval) {
+                trees.erase(path);
+                if (retval == ERR_MALLOC) {
+                    msg_printf(NULL, MSG_INFO,
+                        "Out of inotify watches; will scan directories to get disk usage"
+                    );
+                    clear();
+                    close(fd);
+                    fd = -1;
+                }
+            } else {
+                t = trees.find(path);
+                if (log_flags.disk_usage_debug) {
+                    msg_printf(NULL, MSG_INFO,
+                        "[disk_usage] scanned %s in %.3f sec",
+                        path, dtime() - start
+                    );
+                }
+            }
+        }
+        if (t != trees.end()) {
+            size = alloc?t->second.alloc:t->second.size;
+            return 0;
+        }
+    }
+    return alloc?dir_size_alloc(path, size):dir_size(path, size);
+}
+
+#endif
@@ -0,0 +1,94 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOINC_DISK_USAGE_H
+#define BOINC_DISK_USAGE_H
+
+// Incremental disk usage accounting for project and slot directories
+// (Linux).
+//
+// The first time the usage of a directory tree is asked for,
+// we scan it (as dir_size() does) and add an inotify watch
+// to each of its directories.
+// After that, inotify events mark files as changed,
+// and only those files are stat()ed when the usage is asked for again.
+// Each tree is rescanned every DISK_USAGE_RESCAN_PERIOD seconds
+// in case we missed something (e.g. a change in the target
+// of a symbolic link), and after an event queue overflow.
+//
+// If inotify isn't available, or we run out of watches,
+// get_usage() scans the directory each time, as before.
+
+#include <map>
+#include <set>
+#include <string>
+
+#define DISK_USAGE_RESCAN_PERIOD    (6*3600)
+
+struct DU_FILE {
+    double size;
+    double alloc;
+        // size and allocated size, as dir_size() and dir_size_alloc()
+};
+
+// a watched directory
+//
+struct DU_DIR {
+    std::string tree;
+        // root of the tree this dir is in
+    std::string path;
+    std::map<std::string, DU_FILE> files;
+    std::map<std::string, int> subdirs;
+        // name -> watch descriptor
+    std::set<std::string> changed;
+        // files with events since we last looked at them
+};
+
+// a directory tree whose usage we keep track of
+//
+struct DU_TREE {
+    double size;
+    double alloc;
+    double scan_time;
+    int root_wd;
+};
+
+struct DISK_USAGE_TRACKER {
+    int fd;
+        // inotify descriptor, or -1
+    std::map<int, DU_DIR> dirs;
+        // watch descriptor -> dir
+    std::map<std::string, DU_TREE> trees;
+    std::set<int> changed_dirs;
+
+    DISK_USAGE_TRACKER() {
+        fd = -1;
+    }
+    void init();
+    void poll();
+    int get_usage(const char* path, double& size, bool alloc);
+    void remove_tree(const char* path);
+    int add_dir(const char* tree, const char* path, int& wd);
+    void remove_dir(int wd);
+    void update_file(DU_DIR&, const std::string& name);
+    void update_changed();
+    void clear();
+};
+
+extern DISK_USAGE_TRACKER disk_usage_tracker;
+
+#endif
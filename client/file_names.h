@@ -70,6 +70,7 @@ extern void send_log_after(const char* filename, double t, MIOFILE& mf);
 #endif
 #define CLIENT_OPAQUE_FILENAME      "client_opaque.txt"
 #define CONFIG_FILE                 "cc_config.xml"
+#define CONTENT_STORE_DIR           "content_store"
 #define NVC_CONFIG_FILE             "nvc_config.xml"
 #define COPROC_INFO_FILENAME        "coproc_info.xml"
 #define CPU_BENCHMARKS_FILE_NAME    "cpu_benchmarks"
@@ -95,6 +96,7 @@ extern void send_log_after(const char* filename, double t, MIOFILE& mf);
 #define STATE_FILE_NEXT             "client_state_next.xml"
 #define STATE_FILE_NAME             "client_state.xml"
 #define STATE_FILE_PREV             "client_state_prev.xml"
+#define STATE_JOURNAL_FILE          "client_state_journal.xml"
 #define STDERR_FILE_NAME            "stderr.txt"
 #define STDOUT_FILE_NAME            "stdout.txt"
 #define SWITCHER_DIR                "switcher"
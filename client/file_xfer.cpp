@@ -49,7 +49,7 @@ FILE_XFER::FILE_XFER() {
 }
 
 FILE_XFER::~FILE_XFER() {
-    if (fip && fip->pers_file_xfer) {
+    if (fip && fip->pers_file_xfer && fip->pers_file_xfer->fxp == this) {
         fip->pers_file_xfer->fxp = NULL;
     }
 }
@@ -83,6 +83,27 @@ int FILE_XFER::init_download(FILE_INFO& file_info) {
     );
 }
 
+// download bytes [start, end) of a file,
+// writing them at the same offset of the (preallocated) file "path".
+// See PERS_FILE_XFER::create_range_xfers()
+//
+int FILE_XFER::init_download_range(
+    FILE_INFO& file_info, const char* path, double start, double end
+) {
+    is_upload = false;
+    fip = &file_info;
+    safe_strcpy(pathname, path);
+    starting_size = start;
+    bytes_xferred = start;
+    range_end = end;
+
+    const char* url = fip->download_urls.get_current_url(file_info);
+    if (!url) return ERR_INVALID_URL;
+    return HTTP_OP::init_get(
+        file_info.project, url, pathname, false, start, file_info.nbytes
+    );
+}
+
 // for uploads, we need to build a header with xml_signature etc.
 // (see doc/upload.php)
 // Do this in memory.
@@ -315,6 +336,10 @@ bool FILE_XFER_SET::poll() {
             fxp->fip->error_msg = "Local copy is at least as large as server copy";
         }
 
+        // ranged downloads are checked by their PERS_FILE_XFER
+        //
+        if (fxp->range_end) continue;
+
         // deal with various error cases for downloads
         //
         if (!fxp->is_upload) {
@@ -50,6 +50,9 @@ public:
 
     int parse_upload_response(double &offset);
     int init_download(FILE_INFO&);
+    int init_download_range(
+        FILE_INFO&, const char* path, double start, double end
+    );
     int init_upload(FILE_INFO&);
     bool file_xfer_done;
     int file_xfer_retval;
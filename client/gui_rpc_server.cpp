@@ -91,12 +91,49 @@ GUI_RPC_CONN::GUI_RPC_CONN(int s) :
     au_mgr_state = AU_MGR_INIT;
 
     notice_refresh = false;
+    out_offset = 0;
+    out_nbytes = 0;
 }
 
 GUI_RPC_CONN::~GUI_RPC_CONN() {
     boinc_close_socket(sock);
 }
 
+void GUI_RPC_CONN::queue_reply(std::shared_ptr<GUI_RPC_BUF> buf) {
+    if (buf->n <= 0) return;
+    out_queue.push_back(buf);
+    out_nbytes += buf->n;
+}
+
+void GUI_RPC_CONN::queue_reply(const char* s) {
+    char* p = strdup(s);
+    if (!p) return;
+    queue_reply(std::make_shared<GUI_RPC_BUF>(p, (int)strlen(p)));
+}
+
+int GUI_RPC_CONN::send_pending() {
+    while (!out_queue.empty()) {
+        GUI_RPC_BUF& buf = *out_queue.front();
+        int n = (int)send(sock, buf.p+out_offset, buf.n-out_offset, 0);
+        if (n < 0) {
+#ifdef _WIN32
+            if (WSAGetLastError() == WSAEWOULDBLOCK) return 0;
+#else
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return 0;
+            }
+#endif
+            return ERR_WRITE;
+        }
+        out_offset += n;
+        out_nbytes -= n;
+        if (out_offset < buf.n) return 0;
+        out_queue.pop_front();
+        out_offset = 0;
+    }
+    return 0;
+}
+
 GUI_RPC_CONN_SET::GUI_RPC_CONN_SET() {
     remote_hosts_configured = false;
     lsock = -1;
@@ -424,6 +461,10 @@ void GUI_RPC_CONN_SET::get_fdset(FDSET_GROUP& fg, FDSET_GROUP& all) {
         int s = gr->sock;
         FD_SET(s, &fg.read_fds);
         FD_SET(s, &fg.exc_fds);
+        if (gr->has_pending_output()) {
+            FD_SET(s, &fg.write_fds);
+            FD_SET(s, &all.write_fds);
+        }
         if (s > fg.max_fd) fg.max_fd = s;
 
         FD_SET(s, &all.read_fds);
@@ -480,6 +521,10 @@ void GUI_RPC_CONN_SET::got_select(FDSET_GROUP& fg) {
         fcntl(sock, F_SETFD, FD_CLOEXEC);
 #endif
 
+        // replies are sent as the socket becomes writable
+        //
+        boinc_socket_asynch(sock, true);
+
         bool host_allowed;
          
         // accept the connection if:
@@ -535,24 +580,33 @@ void GUI_RPC_CONN_SET::got_select(FDSET_GROUP& fg) {
         ++iter;
     }
 
-    // handle RPCs on connections with pending requests
+    // handle RPCs on connections with pending requests,
+    // and send queued replies on writable connections
     //
     iter = gui_rpcs.begin();
     while (iter != gui_rpcs.end()) {
         gr = *iter;
-        if (FD_ISSET(gr->sock, &fg.read_fds)) {
+        retval = 0;
+        if (FD_ISSET(gr->sock, &fg.write_fds)) {
+            retval = gr->send_pending();
+        }
+        if (!retval && FD_ISSET(gr->sock, &fg.read_fds)) {
             retval = gr->handle_rpc();
-            if (retval) {
-                if (log_flags.gui_rpc_debug) {
-                    msg_printf(NULL, MSG_INFO,
-                        "[gui_rpc] handler returned %d, closing socket\n",
-                        retval
-                    );
-                }
-                delete gr;
-                iter = gui_rpcs.erase(iter);
-                continue;
+        }
+        if (!retval && gr->out_nbytes > GUI_RPC_MAX_OUT_BYTES) {
+            retval = ERR_BUFFER_OVERFLOW;
+        }
+        if (retval) {
+            if (log_flags.gui_rpc_debug) {
+                msg_printf(NULL, MSG_INFO,
+                    "[gui_rpc] handler returned %d, closing socket\n",
+                    retval
+                );
             }
+            gr->send_pending();
+            delete gr;
+            iter = gui_rpcs.erase(iter);
+            continue;
         }
         ++iter;
     }
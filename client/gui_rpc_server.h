@@ -18,6 +18,10 @@
 #ifndef BOINC_GUI_RPC_SERVER_H
 #define BOINC_GUI_RPC_SERVER_H
 
+#include <cstdlib>
+#include <deque>
+#include <memory>
+
 #include "network.h"
 #include "acct_setup.h"
 
@@ -39,6 +43,24 @@
 
 #define GUI_RPC_REQ_MSG_SIZE    100000
 
+#define GUI_RPC_MAX_OUT_BYTES   (64*1024*1024)
+    // close a connection if it has this much unsent output
+
+// a reply buffer (malloced, e.g. by MFILE::get_buf()).
+// Reference-counted, so replies are queued without copying.
+//
+struct GUI_RPC_BUF {
+    char* p;
+    int n;
+    GUI_RPC_BUF(char* _p, int _n) {
+        p = _p;
+        n = _n;
+    }
+    ~GUI_RPC_BUF() {
+        free(p);
+    }
+};
+
 class GUI_RPC_CONN {
 public:
     int sock;
@@ -69,6 +91,22 @@ public:
     GET_PROJECT_CONFIG_OP get_project_config_op;
     LOOKUP_ACCOUNT_OP lookup_account_op;
     CREATE_ACCOUNT_OP create_account_op;
+
+    // Replies are queued and sent as the socket becomes writable,
+    // so a slow or stalled peer doesn't block the client.
+    //
+    std::deque<std::shared_ptr<GUI_RPC_BUF> > out_queue;
+    int out_offset;
+        // bytes of out_queue.front() already sent
+    int out_nbytes;
+        // unsent bytes in out_queue
+    void queue_reply(std::shared_ptr<GUI_RPC_BUF>);
+    void queue_reply(const char*);
+    int send_pending();
+        // send as much as the socket will take; nonzero on error
+    inline bool has_pending_output() {
+        return !out_queue.empty();
+    }
 private:
     bool notice_refresh;
         // next time we get a get_notices RPC,
@@ -120,6 +158,9 @@ public:
     void send_quits();
     bool quits_sent();
     bool poll();
+    inline int nconns() {
+        return (int)gui_rpcs.size();
+    }
     void set_notice_refresh() {
         for (unsigned int i=0; i<gui_rpcs.size(); i++) {
             gui_rpcs[i]->set_notice_refresh();
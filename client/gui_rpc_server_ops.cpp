@@ -53,6 +53,11 @@
 #endif
 #endif
 
+#include <cerrno>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+
 #include "error_numbers.h"
 #include "filesys.h"
 #include "network.h"
@@ -1302,6 +1307,315 @@ static void handle_get_file_transfers(GUI_RPC_CONN& grc) {
     gstate.write_file_transfers_gui(grc.mfout);
 }
 
+// Support for get_state_changes.
+// For each task and file transfer we keep a hash of the fields
+// that appear in the GUI RPC reply,
+// and the sequence number at which it last changed.
+// Each call recomputes the hashes; this is much cheaper
+// than writing everything, and it means we don't have to
+// find every place where one of these fields changes.
+//
+
+#define MAX_GUI_DELETED 1000
+    // remember this many removed tasks or transfers.
+    // Requests with older seqnos get a full list.
+
+// FNV-1a hash of GUI-visible values
+//
+struct GUI_HASH {
+    unsigned long long h;
+    GUI_HASH() {
+        h = 14695981039346656037ULL;
+    }
+    void add(const void* p, size_t n) {
+        const unsigned char* c = (const unsigned char*)p;
+        for (size_t i=0; i<n; i++) {
+            h ^= c[i];
+            h *= 1099511628211ULL;
+        }
+    }
+    void add(double x) {
+        add(&x, sizeof(x));
+    }
+    void add(int x) {
+        add(&x, sizeof(x));
+    }
+};
+
+struct GUI_CHANGE_ITEM {
+    unsigned long long hash;
+    int seqno;
+    bool seen;
+};
+
+struct GUI_CHANGE_TABLE {
+    std::unordered_map<string, GUI_CHANGE_ITEM> items;
+    std::deque<std::pair<int, string> > deleted;
+        // removed items, oldest first
+    int deleted_floor;
+        // removals with seqno <= this have been forgotten
+
+    GUI_CHANGE_TABLE() {
+        deleted_floor = 0;
+    }
+    void start() {
+        std::unordered_map<string, GUI_CHANGE_ITEM>::iterator i;
+        for (i=items.begin(); i!=items.end(); ++i) {
+            i->second.seen = false;
+        }
+    }
+    // record the current hash of an item; return its seqno
+    //
+    int update(const string& key, unsigned long long hash, int seqno, bool& changed) {
+        std::unordered_map<string, GUI_CHANGE_ITEM>::iterator i = items.find(key);
+        if (i == items.end()) {
+            GUI_CHANGE_ITEM item;
+            item.hash = hash;
+            item.seqno = seqno;
+            item.seen = true;
+            items[key] = item;
+            changed = true;
+            return seqno;
+        }
+        GUI_CHANGE_ITEM& item = i->second;
+        item.seen = true;
+        if (item.hash != hash) {
+            item.hash = hash;
+            item.seqno = seqno;
+            changed = true;
+        }
+        return item.seqno;
+    }
+    // move items not seen since start() to the deleted list
+    //
+    void finish(int seqno, bool& changed) {
+        std::unordered_map<string, GUI_CHANGE_ITEM>::iterator i = items.begin();
+        while (i != items.end()) {
+            if (i->second.seen) {
+                ++i;
+                continue;
+            }
+            deleted.push_back(std::make_pair(seqno, i->first));
+            i = items.erase(i);
+            changed = true;
+        }
+        while (deleted.size() > MAX_GUI_DELETED) {
+            deleted_floor = deleted.front().first;
+            deleted.pop_front();
+        }
+    }
+    void write_deleted(MIOFILE& out, const char* tag, int seqno) {
+        char url[256], name[256];
+        for (unsigned int i=0; i<deleted.size(); i++) {
+            if (deleted[i].first <= seqno) continue;
+            const string& key = deleted[i].second;
+            size_t n = key.find('\n');
+            xml_escape(key.substr(0, n).c_str(), url, sizeof(url));
+            xml_escape(key.substr(n+1).c_str(), name, sizeof(name));
+            out.printf(
+                "<%s>\n"
+                "    <project_url>%s</project_url>\n"
+                "    <name>%s</name>\n"
+                "</%s>\n",
+                tag, url, name, tag
+            );
+        }
+    }
+};
+
+struct GUI_CHANGES {
+    double epoch;
+        // when we started; seqnos from before a restart aren't valid
+    int seqno;
+        // incremented on each scan that finds changes
+    GUI_CHANGE_TABLE results;
+    GUI_CHANGE_TABLE file_transfers;
+    std::vector<int> result_seqnos;
+    std::vector<int> file_info_seqnos;
+        // per-entity seqnos from the last scan, parallel to
+        // gstate.results and gstate.file_infos
+
+    GUI_CHANGES() {
+        epoch = 0;
+        seqno = 0;
+    }
+    void scan();
+};
+
+static GUI_CHANGES gui_changes;
+
+static inline string gui_change_key(PROJECT* p, const char* name) {
+    string key = p->master_url;
+    key += '\n';
+    key += name;
+    return key;
+}
+
+// hash the fields written by RESULT::write_gui()
+// and ACTIVE_TASK::write_gui() that can change
+//
+static unsigned long long result_gui_hash(RESULT* rp) {
+    GUI_HASH h;
+    h.add(rp->state());
+    h.add(rp->exit_status);
+    h.add(rp->final_cpu_time);
+    h.add(rp->final_elapsed_time);
+    h.add(rp->report_deadline);
+    h.add(rp->estimated_runtime_remaining());
+    h.add(rp->completed_time);
+    int flags = (rp->got_server_ack?1:0)
+        | (rp->ready_to_report?2:0)
+        | (rp->suspended_via_gui?4:0)
+        | (rp->project->suspended_via_gui?8:0)
+        | (rp->report_immediately?16:0)
+        | (rp->edf_scheduled?32:0)
+        | (rp->coproc_missing?64:0)
+        | ((rp->schedule_backoff > gstate.now)?128:0)
+        | ((rp->avp->needs_network && gstate.network_suspended)?256:0);
+    h.add(flags);
+    ACTIVE_TASK* atp = gstate.active_tasks.lookup_result(rp);
+    if (atp) {
+        h.add(atp->task_state());
+        h.add(atp->scheduler_state);
+        h.add(atp->slot);
+        h.add(atp->pid);
+        h.add(atp->checkpoint_cpu_time);
+        h.add(atp->fraction_done);
+        h.add(atp->current_cpu_time);
+        h.add(atp->elapsed_time);
+        h.add(atp->procinfo.swap_size);
+        h.add(atp->procinfo.working_set_size_smoothed);
+        h.add(atp->bytes_sent);
+        h.add(atp->bytes_received);
+        h.add((atp->too_large?1:0) | (atp->needs_shmem?2:0));
+    }
+    return h.h;
+}
+
+// same, for FILE_INFO::write_gui()
+//
+static unsigned long long file_transfer_gui_hash(FILE_INFO* fip) {
+    GUI_HASH h;
+    PERS_FILE_XFER* pfx = fip->pers_file_xfer;
+    h.add(fip->status);
+    h.add(fip->download_gzipped?fip->gzipped_nbytes:fip->nbytes);
+    h.add(pfx->next_request_time);
+        // changes on each retry
+    h.add(pfx->time_so_far);
+    h.add(pfx->last_bytes_xferred);
+    h.add(pfx->is_upload?1:0);
+    if (pfx->active_xfer()) {
+        double bytes_xferred, xfer_speed;
+        pfx->get_xfer_status(bytes_xferred, xfer_speed);
+        h.add(bytes_xferred);
+        h.add(pfx->fxp?pfx->fxp->file_offset:0.);
+        h.add(xfer_speed);
+    }
+    FILE_XFER_BACKOFF& fxb = fip->project->file_xfer_backoff(pfx->is_upload);
+    h.add((fxb.next_xfer_time > gstate.now)?fxb.next_xfer_time:0.);
+    return h.h;
+}
+
+void GUI_CHANGES::scan() {
+    unsigned int i;
+    bool changed = false;
+    int next = seqno + 1;
+
+    if (!epoch) {
+        epoch = floor(dtime());
+    }
+
+    results.start();
+    result_seqnos.resize(gstate.results.size());
+    for (i=0; i<gstate.results.size(); i++) {
+        RESULT* rp = gstate.results[i];
+        result_seqnos[i] = results.update(
+            gui_change_key(rp->project, rp->name), result_gui_hash(rp),
+            next, changed
+        );
+    }
+    results.finish(next, changed);
+
+    file_transfers.start();
+    file_info_seqnos.resize(gstate.file_infos.size());
+    for (i=0; i<gstate.file_infos.size(); i++) {
+        FILE_INFO* fip = gstate.file_infos[i];
+        if (!fip->pers_file_xfer) continue;
+        file_info_seqnos[i] = file_transfers.update(
+            gui_change_key(fip->project, fip->name), file_transfer_gui_hash(fip),
+            next, changed
+        );
+    }
+    file_transfers.finish(next, changed);
+
+    if (changed) seqno = next;
+}
+
+// params:
+// <epoch>x</epoch>
+// <seqno>n</seqno>
+//    from the previous reply; if absent or from a different epoch,
+//    return all tasks and file transfers.
+// Returns the tasks and file transfers that changed after seqno,
+// those that were removed,
+// and the highest message and public notice seqnos.
+//
+static void handle_get_state_changes(GUI_RPC_CONN& grc) {
+    double epoch = 0;
+    int seqno = 0;
+    unsigned int i;
+
+    while (!grc.xp.get_tag()) {
+        if (grc.xp.parse_double("epoch", epoch)) continue;
+        if (grc.xp.parse_int("seqno", seqno)) continue;
+    }
+
+    gui_changes.scan();
+    bool full = (epoch != gui_changes.epoch)
+        || (seqno <= 0)
+        || (seqno > gui_changes.seqno)
+        || (seqno < gui_changes.results.deleted_floor)
+        || (seqno < gui_changes.file_transfers.deleted_floor);
+    if (full) seqno = 0;
+
+    int notice_seqno = 0;
+    for (i=0; i<notices.notices.size(); i++) {
+        if (notices.notices[i].is_private) continue;
+        notice_seqno = notices.notices[i].seqno;
+        break;
+    }
+    grc.mfout.printf(
+        "<state_changes>\n"
+        "<epoch>%.0f</epoch>\n"
+        "<seqno>%d</seqno>\n"
+        "<msg_seqno>%d</msg_seqno>\n"
+        "<notice_seqno>%d</notice_seqno>\n"
+        "%s",
+        gui_changes.epoch, gui_changes.seqno,
+        message_descs.highest_seqno(), notice_seqno,
+        full?"<full/>\n":""
+    );
+    for (i=0; i<gstate.results.size(); i++) {
+        if (gui_changes.result_seqnos[i] > seqno) {
+            gstate.results[i]->write_gui(grc.mfout);
+        }
+    }
+    for (i=0; i<gstate.file_infos.size(); i++) {
+        FILE_INFO* fip = gstate.file_infos[i];
+        if (!fip->pers_file_xfer) continue;
+        if (gui_changes.file_info_seqnos[i] > seqno) {
+            fip->write_gui(grc.mfout);
+        }
+    }
+    if (!full) {
+        gui_changes.results.write_deleted(grc.mfout, "deleted_result", seqno);
+        gui_changes.file_transfers.write_deleted(
+            grc.mfout, "deleted_file_transfer", seqno
+        );
+    }
+    grc.mfout.printf("</state_changes>\n");
+}
+
 static void handle_read_global_prefs_override(GUI_RPC_CONN& grc) {
     grc.mfout.printf("<success/>\n");
     gstate.read_global_prefs();
@@ -1786,6 +2100,7 @@ GUI_RPC gui_rpcs[] = {
     GUI_RPC("get_screensaver_tasks", handle_get_screensaver_tasks,  false,  false,  true),
     GUI_RPC("get_simple_gui_info", handle_get_simple_gui_info,      false,  false,  true),
     GUI_RPC("get_state", handle_get_state,                          false,  false,  true),
+    GUI_RPC("get_state_changes", handle_get_state_changes,          false,  false,  true),
     GUI_RPC("get_statistics", handle_get_statistics,                false,  false,  true),
 
     // ops requiring local auth start here
@@ -1997,6 +2312,15 @@ int GUI_RPC_CONN::handle_rpc() {
 #else
     n = read(sock, request_msg+request_nbytes, left);
 #endif
+    if (n < 0) {
+        // the socket is non-blocking
+        //
+#ifdef _WIN32
+        if (WSAGetLastError() == WSAEWOULDBLOCK) return 0;
+#else
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+#endif
+    }
     if (n <= 0) {
         request_nbytes = 0;
         return ERR_READ;
@@ -2029,14 +2353,14 @@ int GUI_RPC_CONN::handle_rpc() {
             "Connection: Keep-Alive\n"
             "Content-Type: text/plain\n\n"
         );
-        send(sock, buf, (int)strlen(buf), 0);
+        queue_reply(buf);
         request_nbytes = 0;
         if (log_flags.gui_rpc_debug) {
             msg_printf(0, MSG_INFO,
                 "[gui_rpc] processed OPTIONS"
             );
         }
-        return 0;
+        return send_pending();
     }
     if (is_http_get_request(request_msg)) {
         handle_get();
@@ -2119,20 +2443,22 @@ int GUI_RPC_CONN::handle_rpc() {
             XML_HEADER,
             n+(int)strlen(XML_HEADER)
         );
-        send(sock, buf, (int)strlen(buf), 0);
+        queue_reply(buf);
     }
     if (p) {
-        send(sock, p, n, 0);
         if (log_flags.gui_rpc_debug) {
-            if (!http_request) {
-                p[n-1]=0;   // replace 003 with NULL
-            }
-            if (n > 128) p[128] = 0;
+            int len = http_request?n:n-1;     // omit 003
+            if (len > 128) len = 128;
             msg_printf(0, MSG_INFO,
-                "[gui_rpc] GUI RPC reply: '%s'\n", p
+                "[gui_rpc] GUI RPC reply: '%.*s'\n", len, p
             );
         }
-        free(p);
+        queue_reply(std::make_shared<GUI_RPC_BUF>(p, n));
     }
+
+    // send what we can now; the rest goes out as the socket drains
+    //
+    int send_retval = send_pending();
+    if (!retval) retval = send_retval;
     return retval;
 }
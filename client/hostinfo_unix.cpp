@@ -35,7 +35,9 @@
 #undef _LARGE_FILES
 #undef _LARGEFILE_SOURCE
 #undef _LARGEFILE64_SOURCE
+#include <algorithm>
 #include <iostream>
+#include <utility>
 #include <vector>
 #include <string>
 #include <cstring>
@@ -1241,6 +1243,101 @@ int HOST_INFO::get_cpu_count() {
     return 0;
 }
 
+#ifdef __linux__
+// parse a sysfs CPU or node list like "0-63,128-191"
+//
+static void parse_cpu_list(char* buf, vector<int>& cpus) {
+    char* p = strtok(buf, ",\n");
+    while (p) {
+        int a, b;
+        int n = sscanf(p, "%d-%d", &a, &b);
+        if (n == 1) b = a;
+        if (n >= 1) {
+            for (int i=a; i<=b; i++) {
+                cpus.push_back(i);
+            }
+        }
+        p = strtok(NULL, ",\n");
+    }
+}
+
+// order a list of CPUs so that the first thread of each core comes first,
+// then the second thread of each core, and so on.
+// The kernel's CPU numbering doesn't always do this,
+// so use /sys/devices/system/cpu/cpuN/topology/thread_siblings_list.
+//
+static void order_cpus_by_core(vector<int>& cpus) {
+    char path[MAXPATHLEN], buf[4096];
+    std::vector<std::pair<int, int> > v;     // (thread within core, CPU)
+    unsigned int i, j;
+
+    for (i=0; i<cpus.size(); i++) {
+        int thread = 0;
+        snprintf(path, sizeof(path),
+            "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list",
+            cpus[i]
+        );
+        FILE* f = fopen(path, "r");
+        if (f) {
+            if (fgets(buf, sizeof(buf), f)) {
+                vector<int> siblings;
+                parse_cpu_list(buf, siblings);
+                for (j=0; j<siblings.size(); j++) {
+                    if (siblings[j] == cpus[i]) {
+                        thread = j;
+                        break;
+                    }
+                }
+            }
+            fclose(f);
+        }
+        v.push_back(std::make_pair(thread, cpus[i]));
+    }
+    std::sort(v.begin(), v.end());
+    for (i=0; i<v.size(); i++) {
+        cpus[i] = v[i].second;
+    }
+}
+
+// get the CPUs in each NUMA node from
+// /sys/devices/system/node/nodeN/cpulist.
+// numa_nodes is indexed by node number;
+// nodes that are offline or have no CPUs (e.g. memory-only) are empty.
+// Each node's CPUs are listed one per physical core first
+// (see order_cpus_by_core()).
+//
+int HOST_INFO::get_numa_topology() {
+    char path[MAXPATHLEN], buf[4096];
+    vector<int> nodes;
+
+    numa_nodes.clear();
+    FILE* f = fopen("/sys/devices/system/node/online", "r");
+    if (!f) return ERR_FOPEN;
+    if (fgets(buf, sizeof(buf), f)) {
+        parse_cpu_list(buf, nodes);
+    }
+    fclose(f);
+    for (unsigned int i=0; i<nodes.size(); i++) {
+        int node = nodes[i];
+        if (node < 0 || node > 1023) continue;
+        if ((int)numa_nodes.size() <= node) {
+            numa_nodes.resize(node+1);
+        }
+        snprintf(path, sizeof(path),
+            "/sys/devices/system/node/node%d/cpulist", node
+        );
+        f = fopen(path, "r");
+        if (!f) continue;
+        if (fgets(buf, sizeof(buf), f)) {
+            parse_cpu_list(buf, numa_nodes[node]);
+        }
+        fclose(f);
+        order_cpus_by_core(numa_nodes[node]);
+    }
+    return 0;
+}
+#endif
+
 // get m_nbytes, m_swap
 //
 int HOST_INFO::get_memory_info() {
@@ -1562,6 +1659,9 @@ int HOST_INFO::get_host_info(bool init) {
 
     get_cpu_info();
     get_cpu_count();
+#ifdef __linux__
+    get_numa_topology();
+#endif
     get_memory_info();
     timezone = get_timezone();
     get_os_info();
@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+
+# This file is part of BOINC.
+# http://boinc.berkeley.edu
+# Copyright (C) 2024 University of California
+#
+# BOINC is free software; you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License
+# as published by the Free Software Foundation,
+# either version 3 of the License, or (at your option) any later version.
+#
+# BOINC is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+# See the GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+# Benchmark the client's download of many small files from one server.
+#
+# usage: http_bench.py [--client path] [--dir path] [--files N] [--size N]
+#           [--xfers N]
+#
+# Starts a local HTTP/1.1 server (with keep-alive) serving the given number
+# of files of the given size, and creates a data directory with a job
+# that has these files as inputs.
+# The client is run with --exit_before_start,
+# so it exits once all the files have been downloaded and verified.
+# Reports files/sec.
+# With <http_debug>, the event log shows whether each transfer
+# reused a connection.
+
+import argparse, hashlib, http.server, os, re, shutil, subprocess, threading, time
+
+PLATFORM = 'x86_64-pc-linux-gnu'
+
+class Handler(http.server.SimpleHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+    def log_message(self, format, *args):
+        pass
+
+# like escape_project_url() in lib/url.cpp
+#
+def escape_url(url):
+    return re.sub('[^A-Za-z0-9._-]', '_', url.split('://')[1]).rstrip('_')
+
+def make_dir(dir, url, nfiles, size, nxfers):
+    if os.path.exists(dir):
+        shutil.rmtree(dir)
+    os.makedirs(os.path.join(dir, 'server'))
+    proj_dir = os.path.join(dir, 'client', 'projects', escape_url(url))
+    os.makedirs(proj_dir)
+    with open(os.path.join(proj_dir, 'app'), 'w') as f:
+        f.write('#!/bin/sh\n')
+    with open(os.path.join(dir, 'client', 'cc_config.xml'), 'w') as f:
+        f.write('''<cc_config>
+<options>
+    <max_file_xfers>%d</max_file_xfers>
+    <max_file_xfers_per_project>%d</max_file_xfers_per_project>
+</options>
+</cc_config>
+'''%(nxfers, nxfers))
+    with open(os.path.join(dir, 'client', 'account_%s.xml'%escape_url(url)), 'w') as f:
+        f.write('<account>\n<master_url>%s</master_url>\n<authenticator>x</authenticator>\n</account>\n'%url)
+    with open(os.path.join(dir, 'client', 'client_state.xml'), 'w') as f:
+        f.write('''<client_state>
+<project>
+    <master_url>%s</master_url>
+    <project_name>bench</project_name>
+</project>
+<app>
+    <name>app</name>
+</app>
+<file_info>
+    <name>app</name>
+    <nbytes>10</nbytes>
+    <status>1</status>
+    <executable/>
+</file_info>
+<app_version>
+    <app_name>app</app_name>
+    <version_num>100</version_num>
+    <platform>%s</platform>
+    <file_ref>
+        <file_name>app</file_name>
+        <main_program/>
+    </file_ref>
+</app_version>
+'''%(url, PLATFORM))
+        refs = ''
+        for i in range(nfiles):
+            name = 'in_%d'%i
+            data = os.urandom(size)
+            with open(os.path.join(dir, 'server', name), 'wb') as g:
+                g.write(data)
+            f.write('''<file_info>
+    <name>%s</name>
+    <nbytes>%d</nbytes>
+    <md5_cksum>%s</md5_cksum>
+    <url>%s%s</url>
+</file_info>
+'''%(name, size, hashlib.md5(data).hexdigest(), url, name))
+            refs += '''    <file_ref>
+        <file_name>%s</file_name>
+        <open_name>%s</open_name>
+    </file_ref>
+'''%(name, name)
+        f.write('''<workunit>
+    <name>wu</name>
+    <app_name>app</app_name>
+    <version_num>100</version_num>
+    <rsc_fpops_est>1e12</rsc_fpops_est>
+%s</workunit>
+<result>
+    <name>wu_0</name>
+    <wu_name>wu</wu_name>
+    <platform>%s</platform>
+    <version_num>100</version_num>
+    <report_deadline>%f</report_deadline>
+    <state>1</state>
+</result>
+</client_state>
+'''%(refs, PLATFORM, time.time() + 7*86400))
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--client', default='./boinc')
+    parser.add_argument('--dir', default='http_bench_dir')
+    parser.add_argument('--files', type=int, default=500)
+    parser.add_argument('--size', type=int, default=10000)
+    parser.add_argument('--xfers', type=int, default=8)
+    args = parser.parse_args()
+
+    dir = os.path.abspath(args.dir)
+    server_dir = os.path.join(dir, 'server')
+    os.makedirs(server_dir, exist_ok=True)
+    handler = lambda *a, **kw: Handler(*a, directory=server_dir, **kw)
+    server = http.server.ThreadingHTTPServer(('127.0.0.1', 0), handler)
+    url = 'http://127.0.0.1:%d/'%server.server_address[1]
+    make_dir(dir, url, args.files, args.size, args.xfers)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+
+    t = time.time()
+    subprocess.call([
+        os.path.abspath(args.client), '--dir', os.path.join(dir, 'client'),
+        '--exit_before_start', '--no_gpus', '--no_gui_rpc', '--no_info_fetch',
+        '--skip_cpu_benchmarks', '--allow_multiple_clients'
+    ])
+    t = time.time() - t
+    server.shutdown()
+    print('%d files in %.3f sec: %.1f files/sec'%(args.files, t, args.files/t))
+
+main()
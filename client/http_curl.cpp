@@ -56,6 +56,10 @@ using std::min;
 using std::vector;
 
 static CURLM* g_curlMulti = NULL;
+static CURLSH* g_curlShare = NULL;
+    // DNS and TLS session caches shared by all easy handles
+static vector<CURL*> g_curl_free_handles;
+    // easy handles available for reuse
 static char g_user_agent_string[256] = {""};
 static unsigned int g_trace_count = 0;
 static bool got_expectation_failed = false;
@@ -82,6 +86,25 @@ size_t libcurl_write(void *ptr, size_t size, size_t nmemb, HTTP_OP* phop) {
     // TODO: maybe assert stRead == size*nmemb,
     // add exception handling on phop members
     //
+    if (phop->range_end) {
+        // A ranged GET writes into the middle of a file,
+        // so make sure we're getting the requested range.
+        // Discard the body of an error reply;
+        // stop if the server sent anything but a 206
+        // (e.g. the whole file with a 200).
+        //
+        long response;
+        curl_easy_getinfo(phop->curlEasy, CURLINFO_RESPONSE_CODE, &response);
+        if ((response/100)*100 != HTTP_STATUS_OK) {
+            return size*nmemb;
+        }
+        if (response != HTTP_STATUS_PARTIAL_CONTENT) {
+            return 0;
+        }
+        if (phop->bytes_xferred + size*nmemb > phop->range_end) {
+            return 0;
+        }
+    }
     size_t stWrite = fwrite(ptr, size, nmemb, phop->fileOut);
     if (log_flags.http_xfer_debug) {
         msg_printf(NULL, MSG_INFO,
@@ -256,6 +279,7 @@ HTTP_OP::HTTP_OP() {
     safe_strcpy(m_curl_user_credentials, "");
     content_length = 0;
     file_offset = 0;
+    range_end = 0;
     safe_strcpy(request_header, "");
     http_op_state = HTTP_STATE_IDLE;
     http_op_type = HTTP_OP_NONE;
@@ -407,6 +431,36 @@ static int set_cloexec(void*, curl_socket_t fd, curlsocktype purpose) {
 }
 #endif
 
+// Connections are cached in the multi handle,
+// so they're reused by later transfers to the same server.
+// Keep the cache big enough to hold a connection to each data server
+// even when few transfers are active.
+//
+#define MAX_CURL_CONNECTS       32
+
+// Easy handles are reset and reused rather than destroyed.
+// Keep at most this many.
+//
+#define MAX_FREE_CURL_HANDLES   16
+
+static CURL* get_curl_handle() {
+    if (g_curl_free_handles.size()) {
+        CURL* c = g_curl_free_handles.back();
+        g_curl_free_handles.pop_back();
+        return c;
+    }
+    return curl_easy_init();
+}
+
+static void release_curl_handle(CURL* c) {
+    if (g_curl_free_handles.size() >= MAX_FREE_CURL_HANDLES) {
+        curl_easy_cleanup(c);
+        return;
+    }
+    curl_easy_reset(c);
+    g_curl_free_handles.push_back(c);
+}
+
 // the following will do an HTTP GET or POST using libcurl
 //
 int HTTP_OP::libcurl_exec(
@@ -438,7 +492,7 @@ int HTTP_OP::libcurl_exec(
         snprintf(outfile, sizeof(outfile), "http_temp_%d", outfile_seqno++);
     }
 
-    curlEasy = curl_easy_init(); // get a curl_easy handle to use
+    curlEasy = get_curl_handle();
     if (!curlEasy) {
         if (log_flags.http_debug) {
             msg_printf(project, MSG_INFO, "Couldn't create curlEasy handle");
@@ -452,6 +506,10 @@ int HTTP_OP::libcurl_exec(
     string_substitute(url, m_url, sizeof(m_url), " ", "%20");
     curl_easy_setopt(curlEasy, CURLOPT_URL, m_url);
 
+    if (g_curlShare) {
+        curl_easy_setopt(curlEasy, CURLOPT_SHARE, g_curlShare);
+    }
+
     // This option determines whether curl verifies that the server
     // claims to be who you want it to be.
     // When negotiating an SSL connection,
@@ -569,6 +627,17 @@ int HTTP_OP::libcurl_exec(
     if (cc_config.http_1_0 || (cc_config.force_auth == "ntlm") || got_expectation_failed) {
         curl_easy_setopt(curlEasy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
     }
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    else {
+        // use HTTP/2 over TLS if the server supports it,
+        // and wait for a connection to the server that's being set up
+        // rather than opening another one,
+        // so that transfers from the same server are multiplexed
+        //
+        curl_easy_setopt(curlEasy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(curlEasy, CURLOPT_PIPEWAIT, 1L);
+    }
+#endif
     curl_easy_setopt(curlEasy, CURLOPT_MAXREDIRS, 50L);
     curl_easy_setopt(curlEasy, CURLOPT_AUTOREFERER, 1L);
     curl_easy_setopt(curlEasy, CURLOPT_FOLLOWLOCATION, 1L);
@@ -581,7 +650,12 @@ int HTTP_OP::libcurl_exec(
     //
     // Per: http://curl.haxx.se/dev/readme-encoding.html
     // NULL disables, empty string accepts all.
-    if (out) {
+    // A ranged GET needs byte offsets in the file itself,
+    // so don't accept any encoding in that case either.
+    //
+    if (out && range_end) {
+        curl_easy_setopt(curlEasy, CURLOPT_ENCODING, NULL);
+    } else if (out) {
         if (ends_with(out, ".gzt") || ends_with(out, ".gz") || ends_with(out, ".tgz")) {
             curl_easy_setopt(curlEasy, CURLOPT_ENCODING, NULL);
         } else {
@@ -602,7 +676,11 @@ int HTTP_OP::libcurl_exec(
 
     // set the file offset for resumable downloads
     //
-    if (!is_post && offset>0.0f) {
+    if (!is_post && range_end) {
+        file_offset = offset;
+        snprintf(buf, sizeof(buf), "Range: bytes=%.0f-%.0f", offset, range_end-1);
+        pcurlList = curl_slist_append(pcurlList, buf);
+    } else if (!is_post && offset>0.0f) {
         file_offset = offset;
         snprintf(buf, sizeof(buf), "Range: bytes=%.0f-", offset);
         pcurlList = curl_slist_append(pcurlList, buf);
@@ -611,7 +689,16 @@ int HTTP_OP::libcurl_exec(
     // set up an output file for the reply
     //
     if (strlen(outfile)) {
-        if (file_offset > 0) {
+        if (!is_post && range_end) {
+            fileOut = boinc_fopen(outfile, "rb+");
+            if (fileOut) {
+#ifdef _WIN32
+                _fseeki64(fileOut, (__int64)file_offset, SEEK_SET);
+#else
+                fseeko(fileOut, (off_t)file_offset, SEEK_SET);
+#endif
+            }
+        } else if (file_offset > 0) {
             fileOut = boinc_fopen(outfile, "ab+");
         } else {
 #ifdef _WIN32
@@ -905,13 +992,38 @@ fd_set read_fds, write_fds, error_fds;
 int curl_init() {
     curl_global_init(CURL_GLOBAL_ALL);
     g_curlMulti = curl_multi_init();
-    return (int)(g_curlMulti == NULL);
+    if (!g_curlMulti) return 1;
+    curl_multi_setopt(g_curlMulti, CURLMOPT_MAXCONNECTS, (long)MAX_CURL_CONNECTS);
+#if LIBCURL_VERSION_NUM >= 0x072b00
+    curl_multi_setopt(g_curlMulti, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+
+    // Share DNS entries and TLS sessions among all handles,
+    // so that a new connection to a server we've already talked to
+    // skips the DNS lookup and resumes the TLS session
+    // rather than doing a full handshake.
+    // The client is single-threaded, so no locking is needed.
+    //
+    g_curlShare = curl_share_init();
+    if (g_curlShare) {
+        curl_share_setopt(g_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(g_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+    return 0;
 }
 
 int curl_cleanup() {
     if (g_curlMulti) {
         curl_multi_cleanup(g_curlMulti);
     }
+    for (unsigned int i=0; i<g_curl_free_handles.size(); i++) {
+        curl_easy_cleanup(g_curl_free_handles[i]);
+    }
+    g_curl_free_handles.clear();
+    if (g_curlShare) {
+        curl_share_cleanup(g_curlShare);
+        g_curlShare = NULL;
+    }
     curl_global_cleanup();
     return 0;
 }
@@ -930,7 +1042,7 @@ void HTTP_OP::close_socket() {
     }
     if (curlEasy && g_curlMulti) {  // release this handle
         curl_multi_remove_handle(g_curlMulti, curlEasy);
-        curl_easy_cleanup(curlEasy);
+        release_curl_handle(curlEasy);
         curlEasy = NULL;
     }
 }
@@ -1010,6 +1122,15 @@ void HTTP_OP::handle_messages(CURLMsg *pcurlMsg) {
     http_op_state = HTTP_STATE_DONE;
     CurlResult = pcurlMsg->data.result;
 
+    if (log_flags.http_debug) {
+        long nconnects = 0;
+        curl_easy_getinfo(curlEasy, CURLINFO_NUM_CONNECTS, &nconnects);
+        msg_printf(project, MSG_INFO,
+            "[http] [ID#%d] %s connection", trace_id,
+            nconnects?"used a new":"reused a"
+        );
+    }
+
     if (CurlResult == CURLE_OK) {
         switch ((response/100)*100) {
         case HTTP_STATUS_OK:                        // 200
@@ -89,6 +89,9 @@ public:
         // then (is nonempty) this file
     double file_offset;
         // starting at this offset
+    double range_end;
+        // for GETs: if nonzero, request only bytes [file_offset, range_end)
+        // and write them at file_offset in the (existing) outfile
 
     // reply message stuff
     //
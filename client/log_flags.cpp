@@ -401,6 +401,7 @@ int CC_CONFIG::parse_options_client(XML_PARSER& xp) {
             downcase_string(force_auth);
             continue;
         }
+        if (xp.parse_bool("hard_link_input_files", hard_link_input_files)) continue;
         if (xp.parse_bool("http_1_0", http_1_0)) continue;
         if (xp.parse_int("http_transfer_timeout", http_transfer_timeout)) continue;
         if (xp.parse_int("http_transfer_timeout_bps", http_transfer_timeout_bps)) continue;
@@ -416,6 +417,8 @@ int CC_CONFIG::parse_options_client(XML_PARSER& xp) {
             ignore_gpu_instance[PROC_TYPE_INTEL_GPU].push_back(n);
             continue;
         }
+        if (xp.parse_int("max_async_verifies", max_async_verifies)) continue;
+        if (xp.parse_int("max_download_ranges", max_download_ranges)) continue;
         if (xp.parse_int("max_event_log_lines", max_event_log_lines)) continue;
         if (xp.parse_int("max_file_xfers", max_file_xfers)) continue;
         if (xp.parse_int("max_file_xfers_per_project", max_file_xfers_per_project)) continue;
@@ -428,7 +431,9 @@ int CC_CONFIG::parse_options_client(XML_PARSER& xp) {
         if (xp.parse_bool("no_info_fetch", no_info_fetch)) continue;
         if (xp.parse_bool("no_opencl", no_opencl)) continue;
         if (xp.parse_bool("no_priority_change", no_priority_change)) continue;
+        if (xp.parse_bool("numa_placement", numa_placement)) continue;
         if (xp.parse_bool("os_random_only", os_random_only)) continue;
+        if (xp.parse_bool("proc_tree_scan", proc_tree_scan)) continue;
         if (xp.parse_int("process_priority", process_priority)) continue;
         if (xp.parse_int("process_priority_special", process_priority_special)) continue;
         if (xp.match_tag("proxy_info")) {
@@ -457,6 +462,8 @@ int CC_CONFIG::parse_options_client(XML_PARSER& xp) {
         if (xp.parse_bool("use_all_gpus", use_all_gpus)) continue;
         if (xp.parse_bool("use_certs", use_certs)) continue;
         if (xp.parse_bool("use_certs_only", use_certs_only)) continue;
+        if (xp.parse_bool("use_cgroups", use_cgroups)) continue;
+        if (xp.parse_bool("use_content_store", use_content_store)) continue;
         if (xp.parse_bool("vbox_window", vbox_window)) continue;
         if (xp.parse_string("ignore_tty", s)) {
             ignore_tty.push_back(s);
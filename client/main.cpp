@@ -165,6 +165,7 @@ static void signal_handler(int signum, siginfo_t*, void*) {
     case SIGPWR:
 #endif
         gstate.requested_exit = true;
+        gstate.wakeup();
 #ifdef __EMX__
         // close socket
         shutdown(gstate.gui_rpcs.lsock, 2);
@@ -381,7 +382,7 @@ int boinc_main_loop() {
 
     while (1) {
         if (!gstate.poll_slow_events()) {
-            gstate.do_io_or_sleep(POLL_INTERVAL);
+            gstate.do_io_or_sleep(gstate.poll_interval());
         }
 
         if (gstate.time_to_exit()) {
@@ -0,0 +1,64 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOINC_NAME_INDEX_H
+#define BOINC_NAME_INDEX_H
+
+#include <string>
+#include <unordered_map>
+
+struct PROJECT;
+
+// A hash index of state objects (APP, FILE_INFO, WORKUNIT, RESULT)
+// by (project, name).
+// The objects are owned by the vectors in CLIENT_STATE;
+// whoever adds an object to or removes it from one of those vectors
+// must also add() or remove() it here.
+//
+template <class T> struct NAME_INDEX {
+    std::unordered_map<std::string, T*> map;
+
+    static std::string key(PROJECT* p, const char* name) {
+        std::string k((const char*)&p, sizeof(p));
+        k += name;
+        return k;
+    }
+    T* lookup(PROJECT* p, const char* name) {
+        typename std::unordered_map<std::string, T*>::iterator i;
+        i = map.find(key(p, name));
+        if (i == map.end()) return NULL;
+        return i->second;
+    }
+    void add(T* t) {
+        map[key(t->project, t->name)] = t;
+    }
+    void remove(T* t) {
+        typename std::unordered_map<std::string, T*>::iterator i;
+        i = map.find(key(t->project, t->name));
+        if (i != map.end() && i->second == t) {
+            map.erase(i);
+        }
+    }
+    void clear() {
+        map.clear();
+    }
+    size_t size() {
+        return map.size();
+    }
+};
+
+#endif
@@ -35,6 +35,7 @@
 #include "client_state.h"
 #include "client_types.h"
 #include "client_msgs.h"
+#include "content_store.h"
 #include "file_names.h"
 #include "log_flags.h"
 #include "project.h"
@@ -52,6 +53,7 @@ PERS_FILE_XFER::PERS_FILE_XFER() {
     pers_xfer_done = false;
     fxp = NULL;
     fip = NULL;
+    no_ranges = false;
 }
 
 PERS_FILE_XFER::~PERS_FILE_XFER() {
@@ -97,6 +99,11 @@ int PERS_FILE_XFER::create_xfer() {
         char pathname[256];
         get_pathname(fip, pathname, sizeof(pathname));
 
+#if !defined(_WIN32) && !defined(SIM)
+        // if an identical file is in the content store, use it
+        //
+        content_store.link_file(fip);
+#endif
         retval = fip->verify_file(true, false, true);
         if (!retval) {
             retval = fip->set_permissions();
@@ -128,6 +135,10 @@ int PERS_FILE_XFER::create_xfer() {
         return ERR_IDLE_PERIOD;
     }
 
+    if (use_ranges()) {
+        return create_range_xfers();
+    }
+
     URL_LIST& ul = fip->get_url_list(is_upload);
     file_xfer = new FILE_XFER;
     fxp = file_xfer;
@@ -170,6 +181,286 @@ int PERS_FILE_XFER::create_xfer() {
     return 0;
 }
 
+int DOWNLOAD_RANGE::parse(XML_PARSER& xp) {
+    while (!xp.get_tag()) {
+        if (xp.match_tag("/download_range")) return 0;
+        if (xp.parse_double("start", start)) continue;
+        if (xp.parse_double("end", end)) continue;
+        if (xp.parse_double("done", done)) continue;
+    }
+    return ERR_XML_PARSE;
+}
+
+void PERS_FILE_XFER::get_part_pathname(char* path, int len) {
+    get_pathname(fip, path, len);
+    strlcat(path, ".part", len);
+}
+
+// Decide whether to download the file in ranges.
+// Don't switch over if part of it was already downloaded in one piece.
+//
+bool PERS_FILE_XFER::use_ranges() {
+    char pathname[MAXPATHLEN];
+    double size;
+
+    if (ranges.size()) return true;
+    if (is_upload || no_ranges) return false;
+    if (cc_config.max_download_ranges < 2) return false;
+    if (fip->download_gzipped) return false;
+    if (fip->nbytes < 2*DOWNLOAD_RANGE_MIN_SIZE) return false;
+    get_pathname(fip, pathname, sizeof(pathname));
+    if (!file_size(pathname, size) && size > 0) return false;
+    return true;
+}
+
+// create the partial file at its full size, and divide it into ranges
+//
+int PERS_FILE_XFER::init_ranges() {
+    char path[MAXPATHLEN];
+    int retval;
+
+    retval = boinc_make_dirs(fip->project->project_dir(), fip->name);
+    if (retval) return retval;
+    get_part_pathname(path, sizeof(path));
+#ifdef _WIN32
+    retval = boinc_allocate_file(path, fip->nbytes);
+#else
+    FILE* f = boinc_fopen(path, "wb");
+    if (!f) return ERR_FOPEN;
+    fclose(f);
+    retval = boinc_truncate(path, fip->nbytes);
+#endif
+    if (retval) return retval;
+
+    int n = (int)(fip->nbytes/DOWNLOAD_RANGE_MIN_SIZE);
+    if (n > cc_config.max_download_ranges) n = cc_config.max_download_ranges;
+    double range_size = ceil(fip->nbytes/n);
+    ranges.clear();
+    for (int i=0; i<n; i++) {
+        DOWNLOAD_RANGE r;
+        r.start = i*range_size;
+        r.end = (i == n-1)?fip->nbytes:r.start+range_size;
+        ranges.push_back(r);
+    }
+    return 0;
+}
+
+// Start a FILE_XFER for each range that isn't done yet.
+// If the partial file is missing or has the wrong size,
+// start over.
+//
+int PERS_FILE_XFER::create_range_xfers() {
+    char path[MAXPATHLEN];
+    double size;
+    int retval = 0, n = 0;
+
+    get_part_pathname(path, sizeof(path));
+    if (ranges.size() && (file_size(path, size) || size != fip->nbytes)) {
+        ranges.clear();
+    }
+    if (ranges.empty()) {
+        retval = init_ranges();
+    }
+    for (unsigned int i=0; !retval && i<ranges.size(); i++) {
+        DOWNLOAD_RANGE& r = ranges[i];
+        if (r.is_done()) continue;
+        FILE_XFER* file_xfer = new FILE_XFER;
+        retval = file_xfer->init_download_range(
+            *fip, path, r.start + r.done, r.end
+        );
+        if (!retval) retval = gstate.file_xfers->insert(file_xfer);
+        if (retval) {
+            delete file_xfer;
+            break;
+        }
+        r.fxp = file_xfer;
+        n++;
+    }
+    if (!retval && !n) {
+        // the ranges were all done; just finish up
+        //
+        poll_ranges();
+        return 0;
+    }
+    if (retval) {
+        if (log_flags.http_debug) {
+            msg_printf(
+                fip->project, MSG_INFO, "[file_xfer] Couldn't start download of %s",
+                fip->name
+            );
+            msg_printf(
+                fip->project, MSG_INFO, "[file_xfer] URL %s: %s",
+                fip->download_urls.get_current_url(*fip), boincerror(retval)
+            );
+        }
+        stop_range_xfers();
+        if (retval == ERR_HTTP_PERMANENT) {
+            permanent_failure(retval);
+        } else {
+            transient_failure(retval);
+        }
+        return retval;
+    }
+    if (log_flags.file_xfer) {
+        msg_printf(
+            fip->project, MSG_INFO, "Started download of %s (%d ranges)",
+            fip->name, n
+        );
+    }
+    if (log_flags.file_xfer_debug) {
+        msg_printf(fip->project, MSG_INFO,
+            "[file_xfer] URL: %s\n",
+            fip->download_urls.get_current_url(*fip)
+        );
+    }
+    return 0;
+}
+
+// stop the range downloads, remembering how far they got
+//
+void PERS_FILE_XFER::stop_range_xfers() {
+    for (unsigned int i=0; i<ranges.size(); i++) {
+        DOWNLOAD_RANGE& r = ranges[i];
+        if (!r.fxp) continue;
+        if (r.fxp->fileOut) fflush(r.fxp->fileOut);
+        r.done = r.fxp->bytes_xferred - r.start;
+        gstate.file_xfers->remove(r.fxp);
+        delete r.fxp;
+        r.fxp = NULL;
+    }
+}
+
+// Poll a download in ranges.
+// If a range fails, stop the others;
+// they're all resumed on the next try.
+// If the server sent the whole file instead of a range,
+// download it in one piece instead.
+//
+bool PERS_FILE_XFER::poll_ranges() {
+    char path[MAXPATHLEN], pathname[MAXPATHLEN];
+    bool active = false, ignored = false;
+    int retval = 0;
+
+    last_bytes_xferred = 0;
+    for (unsigned int i=0; i<ranges.size(); i++) {
+        DOWNLOAD_RANGE& r = ranges[i];
+        if (r.fxp) {
+            // flush first, so that the state file
+            // doesn't claim more than is on disk
+            //
+            if (r.fxp->fileOut) fflush(r.fxp->fileOut);
+            r.done = r.fxp->bytes_xferred - r.start;
+            if (r.fxp->file_xfer_done) {
+                if (r.fxp->response == HTTP_STATUS_OK) {
+                    ignored = true;
+                } else if (r.fxp->file_xfer_retval) {
+                    retval = r.fxp->file_xfer_retval;
+                } else if (!r.is_done()) {
+                    retval = ERR_HTTP_TRANSIENT;
+                }
+                gstate.file_xfers->remove(r.fxp);
+                delete r.fxp;
+                r.fxp = NULL;
+            } else {
+                active = true;
+            }
+        }
+        last_bytes_xferred += r.done;
+    }
+
+    get_part_pathname(path, sizeof(path));
+    if (ignored) {
+        msg_printf(fip->project, MSG_INFO,
+            "Server doesn't support range requests; downloading %s in one piece",
+            fip->name
+        );
+        stop_range_xfers();
+        ranges.clear();
+        boinc_delete_file(path);
+        no_ranges = true;
+        last_bytes_xferred = 0;
+        return true;
+    }
+    if (retval) {
+        if (log_flags.file_xfer_debug) {
+            msg_printf(fip->project, MSG_INFO,
+                "[file_xfer] file transfer status %d (%s)",
+                retval, boincerror(retval)
+            );
+        }
+        stop_range_xfers();
+        if (retval == ERR_NOT_FOUND || retval == ERR_HTTP_PERMANENT) {
+            permanent_failure(retval);
+        } else {
+            if (log_flags.file_xfer) {
+                msg_printf(
+                    fip->project, MSG_INFO, "Temporarily failed download of %s: %s",
+                    fip->name, boincerror(retval)
+                );
+            }
+            transient_failure(retval);
+        }
+        return true;
+    }
+    if (active) return false;
+
+    // all ranges are done; move the file into place
+    //
+    ranges.clear();
+    get_pathname(fip, pathname, sizeof(pathname));
+    retval = boinc_rename(path, pathname);
+    if (retval) {
+        msg_printf(fip->project, MSG_INTERNAL_ERROR,
+            "Can't rename %s to %s: %s", path, pathname, boincerror(retval)
+        );
+        boinc_delete_file(path);
+        fip->status = retval;
+        fip->error_msg = "can't rename partial file";
+        pers_xfer_done = true;
+        return true;
+    }
+    fip->project->file_xfer_backoff(false).file_xfer_succeeded();
+    if (log_flags.file_xfer) {
+        msg_printf(fip->project, MSG_INFO, "Finished download of %s", fip->name);
+    }
+    pers_xfer_done = true;
+    return true;
+}
+
+// the FILE_XFER to show in the GUI and to count against transfer limits;
+// for a download in ranges, the first active range.
+// NULL if no transfer is in progress.
+//
+FILE_XFER* PERS_FILE_XFER::active_xfer() {
+    if (fxp) return fxp;
+    for (unsigned int i=0; i<ranges.size(); i++) {
+        if (ranges[i].fxp) return ranges[i].fxp;
+    }
+    return NULL;
+}
+
+// bytes transferred and transfer rate of the current transfer,
+// summed over ranges if needed
+//
+void PERS_FILE_XFER::get_xfer_status(double& bytes_xferred, double& xfer_speed) {
+    if (fxp) {
+        bytes_xferred = fxp->bytes_xferred;
+        xfer_speed = fxp->xfer_speed;
+        return;
+    }
+    bytes_xferred = 0;
+    xfer_speed = 0;
+    for (unsigned int i=0; i<ranges.size(); i++) {
+        DOWNLOAD_RANGE& r = ranges[i];
+        if (r.fxp) {
+            bytes_xferred += r.fxp->bytes_xferred - r.start;
+            xfer_speed += r.fxp->xfer_speed;
+        } else {
+            bytes_xferred += r.done;
+        }
+    }
+}
+
 // Poll the status of this persistent file transfer.
 // If it's time to start it, then attempt to start it.
 // If it has finished or failed:
@@ -181,7 +472,7 @@ bool PERS_FILE_XFER::poll() {
     if (pers_xfer_done) {
         return false;
     }
-    if (!fxp) {
+    if (!active_xfer()) {
         // No file xfer is active.
         // Either initial or resume after failure.
         // See if it's time to try again.
@@ -207,13 +498,6 @@ bool PERS_FILE_XFER::poll() {
         return false;
     }
 
-    // copy bytes_xferred for use in GUI
-    //
-    last_bytes_xferred = fxp->bytes_xferred;
-    if (is_upload) {
-        last_bytes_xferred += fxp->file_offset;
-    }
-
     // don't count suspended periods in total time
     //
     double diff = gstate.now - last_time;
@@ -222,6 +506,17 @@ bool PERS_FILE_XFER::poll() {
     }
     last_time = gstate.now;
 
+    if (ranges.size()) {
+        return poll_ranges();
+    }
+
+    // copy bytes_xferred for use in GUI
+    //
+    last_bytes_xferred = fxp->bytes_xferred;
+    if (is_upload) {
+        last_bytes_xferred += fxp->file_offset;
+    }
+
     if (fxp->file_xfer_done) {
         if (log_flags.file_xfer_debug) {
             msg_printf(fip->project, MSG_INFO,
@@ -309,9 +604,18 @@ void PERS_FILE_XFER::permanent_failure(int retval) {
     //
     URL_LIST& ul = fip->get_url_list(is_upload);
     if (!ul.get_next_url()) {
-        gstate.file_xfers->remove(fxp);
-        delete fxp;
-        fxp = NULL;
+        if (fxp) {
+            gstate.file_xfers->remove(fxp);
+            delete fxp;
+            fxp = NULL;
+        }
+        if (ranges.size()) {
+            char path[MAXPATHLEN];
+            stop_range_xfers();
+            ranges.clear();
+            get_part_pathname(path, sizeof(path));
+            boinc_delete_file(path);
+        }
         fip->status = retval;
         pers_xfer_done = true;
         if (log_flags.file_xfer) {
@@ -389,6 +693,13 @@ void PERS_FILE_XFER::abort() {
         delete fxp;
         fxp = NULL;
     }
+    if (ranges.size()) {
+        char path[MAXPATHLEN];
+        stop_range_xfers();
+        ranges.clear();
+        get_part_pathname(path, sizeof(path));
+        boinc_delete_file(path);
+    }
     fip->status = ERR_ABORTED_VIA_GUI;
     fip->error_msg = "user requested transfer abort";
     pers_xfer_done = true;
@@ -409,6 +720,13 @@ int PERS_FILE_XFER::parse(XML_PARSER& xp) {
         else if (xp.parse_double("time_so_far", time_so_far)) continue;
         else if (xp.parse_double("last_bytes_xferred", last_bytes_xferred)) continue;
         else if (xp.parse_bool("is_upload", is_upload)) continue;
+        else if (xp.parse_bool("no_ranges", no_ranges)) continue;
+        else if (xp.match_tag("download_range")) {
+            DOWNLOAD_RANGE r;
+            if (!r.parse(xp)) {
+                ranges.push_back(r);
+            }
+        }
         else {
             if (log_flags.unparsed_xml) {
                 msg_printf(NULL, MSG_INFO,
@@ -431,8 +749,7 @@ int PERS_FILE_XFER::write(MIOFILE& fout) {
         "        <next_request_time>%f</next_request_time>\n"
         "        <time_so_far>%f</time_so_far>\n"
         "        <last_bytes_xferred>%f</last_bytes_xferred>\n"
-        "        <is_upload>%d</is_upload>\n"
-        "    </persistent_file_xfer>\n",
+        "        <is_upload>%d</is_upload>\n",
         nretry,
         first_request_time,
         next_request_time,
@@ -440,10 +757,28 @@ int PERS_FILE_XFER::write(MIOFILE& fout) {
         last_bytes_xferred,
         is_upload?1:0
     );
+    if (no_ranges) {
+        fout.printf("        <no_ranges/>\n");
+    }
+    for (unsigned int i=0; i<ranges.size(); i++) {
+        DOWNLOAD_RANGE& r = ranges[i];
+        fout.printf(
+            "        <download_range>\n"
+            "            <start>%.0f</start>\n"
+            "            <end>%.0f</end>\n"
+            "            <done>%.0f</done>\n"
+            "        </download_range>\n",
+            r.start, r.end, r.done
+        );
+    }
+    fout.printf("    </persistent_file_xfer>\n");
 
     // the following is for GUI RPCs
     //
-    if (fxp) {
+    FILE_XFER* afxp = active_xfer();
+    if (afxp) {
+        double bytes_xferred, xfer_speed;
+        get_xfer_status(bytes_xferred, xfer_speed);
         fout.printf(
             "    <file_xfer>\n"
             "        <bytes_xferred>%f</bytes_xferred>\n"
@@ -451,10 +786,10 @@ int PERS_FILE_XFER::write(MIOFILE& fout) {
             "        <xfer_speed>%f</xfer_speed>\n"
             "        <url>%s</url>\n"
             "    </file_xfer>\n",
-            fxp->bytes_xferred,
-            fxp->file_offset,
-            fxp->xfer_speed,
-            fxp->m_url
+            bytes_xferred,
+            fxp?fxp->file_offset:0,
+            xfer_speed,
+            afxp->m_url
         );
     }
     return 0;
@@ -473,6 +808,7 @@ void PERS_FILE_XFER::suspend() {
         delete fxp;
         fxp = 0;
     }
+    stop_range_xfers();
     fip->upload_offset = -1;
 }
 
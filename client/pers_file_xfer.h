@@ -28,6 +28,9 @@
 #define PERS_RETRY_DELAY_MAX    (3600*6)
 #define PERS_GIVEUP             (SECONDS_PER_DAY*90)
     // give up on xfer if this time elapses since last byte xferred
+#define DOWNLOAD_RANGE_MIN_SIZE 16e6
+    // if <max_download_ranges> is set, download files in ranges
+    // of at least this size
 
 // PERS_FILE_XFER represents a "persistent file transfer",
 // i.e. a long-term effort to upload or download a file.
@@ -77,12 +80,43 @@
 //   set in FILE_INFO::parse(), CLIENT_STATE::handle_pers_file_xfers()
 //   zeroed in PERS_FILE_XFER destructor
 
+// Large downloads may be split into several byte ranges
+// (see <max_download_ranges>), each fetched by its own FILE_XFER
+// and written at its offset in a preallocated file "name.part".
+// That file is renamed when all ranges are done.
+// The ranges are saved in the state file so that they can be resumed.
+//
+struct DOWNLOAD_RANGE {
+    double start;
+    double end;
+        // bytes [start, end) of the file
+    double done;
+        // # of bytes of the range that are on disk
+    FILE_XFER* fxp;
+        // nonzero if the range is being downloaded
+
+    DOWNLOAD_RANGE() {
+        start = end = done = 0;
+        fxp = NULL;
+    }
+    bool is_done() {
+        return start + done >= end;
+    }
+    int parse(XML_PARSER&);
+};
+
 class PERS_FILE_XFER {
     int nretry;
         // # of retries so far
     double first_request_time;
         // time of first transfer request
     void do_backoff();
+    bool use_ranges();
+    int init_ranges();
+    int create_range_xfers();
+    bool poll_ranges();
+    void stop_range_xfers();
+    void get_part_pathname(char*, int);
 
 public:
     bool is_upload;
@@ -102,6 +136,10 @@ public:
     FILE_XFER* fxp;
         // nonzero if file xfer in progress
     FILE_INFO* fip;
+    std::vector<DOWNLOAD_RANGE> ranges;
+        // if nonempty, the file is being downloaded in ranges
+    bool no_ranges;
+        // the server ignored a Range request; use a single download
 
     PERS_FILE_XFER();
     ~PERS_FILE_XFER();
@@ -115,6 +153,8 @@ public:
     int create_xfer();
     int start_xfer();
     void suspend();
+    FILE_XFER* active_xfer();
+    void get_xfer_status(double& bytes_xferred, double& xfer_speed);
 };
 
 class PERS_FILE_XFER_SET {
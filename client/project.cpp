@@ -93,6 +93,8 @@ void PROJECT::init() {
     send_time_stats_log = 0;
     send_job_log = 0;
     send_full_workload = false;
+    sched_lists_acked.clear();
+    sched_lists_sent.clear();
     dont_use_dcf = false;
     suspended_via_gui = false;
     dont_request_more_work = false;
@@ -102,7 +104,6 @@ void PROJECT::init() {
     safe_strcpy(code_sign_key, "");
     user_files.clear();
     project_files.clear();
-    next_runnable_result = NULL;
     duration_correction_factor = 1;
     project_files_downloaded_time = 0;
     use_symlinks = false;
@@ -223,7 +224,7 @@ int PROJECT::parse_state(XML_PARSER& xp) {
         if (xp.parse_double("host_create_time", host_create_time)) continue;
         if (xp.match_tag("code_sign_key")) {
             retval = copy_element_contents(
-                xp.f->f,
+                *xp.f,
                 "</code_sign_key>",
                 code_sign_key,
                 sizeof(code_sign_key)
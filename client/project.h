@@ -18,9 +18,27 @@
 #ifndef BOINC_PROJECT_H
 #define BOINC_PROJECT_H
 
+#include <map>
+#include <string>
+
 #include "app_config.h"
 #include "client_types.h"
 
+// descriptions of sticky files and other results
+// sent in a scheduler request, keyed by "f:name" or "r:name",
+// and their digest.
+// Used to send only what has changed (see cs_scheduler.cpp)
+//
+struct SCHED_LISTS {
+    std::map<std::string, std::string> items;
+    std::string digest;
+
+    void clear() {
+        items.clear();
+        digest.clear();
+    }
+};
+
 // describes a project to which this client is attached
 //
 struct PROJECT : PROJ_AM {
@@ -188,6 +206,11 @@ struct PROJECT : PROJ_AM {
     int send_job_log;
         // if nonzero, send this project's job log from that point on
     bool send_full_workload;
+    SCHED_LISTS sched_lists_acked;
+        // the lists the scheduler has said it has; empty if none.
+        // Not saved; after a restart we send full lists
+    SCHED_LISTS sched_lists_sent;
+        // the lists in the current request
 
     bool dont_use_dcf;
 
@@ -247,8 +270,6 @@ struct PROJECT : PROJ_AM {
     int proj_n_concurrent;
         // used to enforce APP_CONFIGS::max_concurrent
 
-    struct RESULT *next_runnable_result;
-        // the next result to run for this project
     int nuploading_results;
         // number of results in UPLOADING state
         // Don't start new results if these exceeds 2*ncpus.
@@ -90,6 +90,10 @@ void RESULT::clear() {
     rrsim_finish_delay = 0;
     rrsim_flops = 0;
     rrsim_done = false;
+    rrsim_running = false;
+    rrsim_step = 0;
+    rrsim_since = 0;
+    rrsim_finish_time = 0;
     already_selected = false;
     rr_sim_misses_deadline = false;
     unfinished_time_slice = false;
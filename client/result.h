@@ -171,6 +171,14 @@ struct RESULT {
     double rrsim_finish_delay;
     double rrsim_flops;
     bool rrsim_done;
+    bool rrsim_running;
+        // in the simulation's set of running jobs
+    int rrsim_step;
+        // the last simulation step in which the job was picked to run
+    double rrsim_since;
+        // rrsim_flops_left is as of this (simulated) time
+    double rrsim_finish_time;
+        // if running, when it will finish
 
     bool already_selected;
         // used to keep cpu scheduler from scheduling a result twice
@@ -42,8 +42,12 @@
 #include "boinc_win.h"
 #else
 #include "config.h"
+#include <cmath>
+#include <queue>
 #endif
 
+#include "util.h"
+
 #include "client_msgs.h"
 #include "client_state.h"
 #include "coproc.h"
@@ -84,15 +88,45 @@ static inline void set_bits(
     }
 }
 
+// order the project heap in pick_jobs_to_run() by scheduling priority.
+// (PROJECT::operator< compares objects; the heap holds pointers)
+//
+static inline bool lower_sched_priority(PROJECT* p0, PROJECT* p1) {
+    return p0->sched_priority < p1->sched_priority;
+}
+
+// a job completion in the simulation.
+// Ordered so that a priority_queue gives the earliest first.
+//
+struct RR_SIM_EVENT {
+    double time;
+    RESULT* rp;
+
+    RR_SIM_EVENT(double t, RESULT* r) {
+        time = t;
+        rp = r;
+    }
+    bool operator<(const RR_SIM_EVENT& e) const {
+        return time > e.time;
+    }
+};
+
 // this is here (rather than rr_sim.h) because its inline functions
 // refer to RESULT
 //
 struct RR_SIM {
     vector<RESULT*> active;
+    vector<RESULT*> prev_active;
+    std::priority_queue<RR_SIM_EVENT> completions;
+        // finish times of running jobs.
+        // Entries for jobs that have since stopped are skipped.
+    double sim_now;
+    int step;
 
     inline void activate(RESULT* rp) {
         PROJECT* p = rp->project;
         active.push_back(rp);
+        rp->rrsim_step = step;
         int rt = rp->avp->gpu_usage.rsc_type;
 
         // if this is a GPU app and GPU computing is suspended,
@@ -135,9 +169,14 @@ struct RR_SIM {
 
     void init_pending_lists();
     void pick_jobs_to_run(double reltime);
+    void update_running();
+    RESULT* next_completion();
     void simulate();
 
-    RR_SIM() {}
+    RR_SIM() {
+        sim_now = 0;
+        step = 0;
+    }
     ~RR_SIM() {}
 
 };
@@ -203,6 +242,8 @@ void RR_SIM::init_pending_lists() {
         RESULT* rp = gstate.results[i];
         rp->rr_sim_misses_deadline = false;
         rp->already_selected = false;
+        rp->rrsim_running = false;
+        rp->rrsim_step = -1;
         if (!rp->nearly_runnable()) continue;
         if (rp->some_download_stalled()) continue;
         if (rp->project->non_cpu_intensive) continue;
@@ -275,7 +316,9 @@ void RR_SIM::pick_jobs_to_run(double reltime) {
             p->compute_sched_priority();
             project_heap.push_back(p);
         }
-        make_heap(project_heap.begin(), project_heap.end());
+        make_heap(
+            project_heap.begin(), project_heap.end(), lower_sched_priority
+        );
 
         // Loop over jobs.
         // Keep going until the resource is saturated or there are no more jobs.
@@ -327,7 +370,10 @@ void RR_SIM::pick_jobs_to_run(double reltime) {
                     // its max given exclusions, remove it from project heap
                     //
                     if (rsc_pwf.sim_nused >= coprocs.coprocs[rt].count - p->rsc_pwf[rt].ncoprocs_excluded) {
-                        pop_heap(project_heap.begin(), project_heap.end());
+                        pop_heap(
+                            project_heap.begin(), project_heap.end(),
+                            lower_sched_priority
+                        );
                         project_heap.pop_back();
                         continue;
                     }
@@ -369,12 +415,24 @@ void RR_SIM::pick_jobs_to_run(double reltime) {
                 // if this project now has no more jobs for the resource,
                 // remove it from the project heap
                 //
-                pop_heap(project_heap.begin(), project_heap.end());
+                pop_heap(
+                    project_heap.begin(), project_heap.end(),
+                    lower_sched_priority
+                );
                 project_heap.pop_back();
             } else if (!rp->rrsim_done) {
-                // Otherwise reshuffle the project heap
+                // Otherwise p's priority has dropped; move it down the heap.
+                // Only the top element changed,
+                // so pop and push it rather than rebuilding the heap.
                 //
-                make_heap(project_heap.begin(), project_heap.end());
+                pop_heap(
+                    project_heap.begin(), project_heap.end(),
+                    lower_sched_priority
+                );
+                push_heap(
+                    project_heap.begin(), project_heap.end(),
+                    lower_sched_priority
+                );
             }
         }
     }
@@ -385,6 +443,51 @@ void RR_SIM::pick_jobs_to_run(double reltime) {
     }
 }
 
+// Jobs picked to run that weren't running start now.
+// Jobs that were running but weren't picked stop;
+// record how much work they have left.
+// A job's speed is fixed for the simulation,
+// so jobs that keep running need no updates.
+//
+void RR_SIM::update_running() {
+    unsigned int i;
+    RESULT* rp;
+
+    for (i=0; i<active.size(); i++) {
+        rp = active[i];
+        if (rp->rrsim_running) continue;
+        rp->rrsim_running = true;
+        rp->rrsim_since = sim_now;
+        rp->rrsim_finish_time = sim_now + rp->rrsim_flops_left/rp->rrsim_flops;
+        completions.push(RR_SIM_EVENT(rp->rrsim_finish_time, rp));
+    }
+    for (i=0; i<prev_active.size(); i++) {
+        rp = prev_active[i];
+        if (!rp->rrsim_running) continue;
+        if (rp->rrsim_step == step) continue;
+        rp->rrsim_running = false;
+        rp->rrsim_flops_left -= rp->rrsim_flops*(sim_now - rp->rrsim_since);
+        if (rp->rrsim_flops_left < 0) {
+            rp->rrsim_flops_left = 0;
+        }
+        rp->rrsim_since = sim_now;
+    }
+}
+
+// return the running job that finishes first
+//
+RESULT* RR_SIM::next_completion() {
+    while (!completions.empty()) {
+        const RR_SIM_EVENT& e = completions.top();
+        RESULT* rp = e.rp;
+        if (rp->rrsim_running && rp->rrsim_finish_time == e.time) {
+            return rp;
+        }
+        completions.pop();
+    }
+    return NULL;
+}
+
 // compute the number of idle instances (count - nused)
 // Called at the start of RR simulation,
 // after the initial assignment of jobs
@@ -460,8 +563,7 @@ static void mc_update_stats(double sim_now, double dt, double buf_end) {
 //
 void RR_SIM::simulate() {
     PROJECT* pbest;
-    RESULT* rp, *rpbest;
-    unsigned int u;
+    RESULT* rpbest;
 
     double ar = gstate.available_ram();
 
@@ -490,12 +592,17 @@ void RR_SIM::simulate() {
         }
     }
 
-    // Simulation loop.  Keep going until all jobs done
+    // Simulation loop.  Keep going until all jobs done.
+    // Each step ends when a job finishes or a time slice ends.
+    // Jobs' finish times are kept in a priority queue,
+    // so a step costs only the re-picking of the running set.
     //
     double buf_end = gstate.now + gstate.work_buf_total();
-    double sim_now = gstate.now;
+    sim_now = gstate.now;
     bool first = true;
     while (1) {
+        prev_active.swap(active);
+        step++;
         pick_jobs_to_run(sim_now-gstate.now);
         if (first) {
             record_nidle_now();
@@ -503,17 +610,12 @@ void RR_SIM::simulate() {
         }
 
         if (!active.size()) break;
+        update_running();
 
-        // compute finish times and see which job finishes first
+        // see which job finishes first
         //
-        rpbest = NULL;
-        for (u=0; u<active.size(); u++) {
-            rp = active[u];
-            rp->rrsim_finish_delay = rp->rrsim_flops_left/rp->rrsim_flops;
-            if (!rpbest || rp->rrsim_finish_delay < rpbest->rrsim_finish_delay) {
-                rpbest = rp;
-            }
-        }
+        rpbest = next_completion();
+        rpbest->rrsim_finish_delay = rpbest->rrsim_finish_time - sim_now;
 
         // see if we finish a time slice before first job ends
         //
@@ -542,6 +644,9 @@ void RR_SIM::simulate() {
             }
         } else {
             rpbest->rrsim_done = true;
+            rpbest->rrsim_running = false;
+            rpbest->rrsim_flops_left = 0;
+            completions.pop();
             pbest = rpbest->project;
             if (log_flags.rr_simulation) {
                 char buf[256];
@@ -573,26 +678,6 @@ void RR_SIM::simulate() {
             }
         }
 
-        // adjust FLOPS left of other active jobs
-        //
-        for (unsigned int i=0; i<active.size(); i++) {
-            rp = active[i];
-            rp->rrsim_flops_left -= rp->rrsim_flops*delta_t;
-
-            // can be slightly less than 0 due to roundoff
-            //
-            if (rp->rrsim_flops_left < -1e6) {
-                if (log_flags.rr_simulation) {
-                    msg_printf(rp->project, MSG_INTERNAL_ERROR,
-                        "%s: negative FLOPs left %f", rp->name, rp->rrsim_flops_left
-                    );
-                }
-            }
-            if (rp->rrsim_flops_left < 0) {
-                rp->rrsim_flops_left = 0;
-            }
-        }
-
         // update shortfall and saturated time for each resource
         //
         for (int i=0; i<coprocs.n_rsc; i++) {
@@ -659,23 +744,116 @@ void RR_SIM::simulate() {
     }
 }
 
-void rr_simulation(const char* why) {
-    static double last_time=0;
+// If a simulation was done less than this long ago,
+// and its inputs haven't changed materially, reuse its results.
+//
+#define RR_SIM_REUSE_PERIOD 30
+
+// A fingerprint of the inputs to the simulation.
+// Runtime estimates are bucketed (about 5%) so that the steady progress
+// of running jobs doesn't count as a change;
+// RR_SIM_REUSE_PERIOD bounds the resulting drift.
+//
+struct RR_SIM_INPUTS {
+    unsigned long long h;
+    RR_SIM_INPUTS() {
+        h = 14695981039346656037ULL;
+    }
+    void add(const void* p, size_t n) {
+        const unsigned char* c = (const unsigned char*)p;
+        for (size_t i=0; i<n; i++) {
+            h ^= c[i];
+            h *= 1099511628211ULL;
+        }
+    }
+    void add(double x) {
+        add(&x, sizeof(x));
+    }
+    void add(int x) {
+        add(&x, sizeof(x));
+    }
+    void add_ptr(const void* p) {
+        add(&p, sizeof(p));
+    }
+    void add_bucket(double x, double scale) {
+        add((int)floor(x*scale + .5));
+    }
+    void compute();
+};
+
+void RR_SIM_INPUTS::compute() {
+    add(gstate.ncpus);
+    add(coprocs.n_rsc);
+    for (int i=1; i<coprocs.n_rsc; i++) {
+        add(coprocs.coprocs[i].count);
+    }
+    add(gstate.work_buf_min());
+    add(gstate.work_buf_additional());
+    add_bucket(gstate.overall_cpu_frac(), 100);
+    add_bucket(gstate.overall_gpu_frac(), 100);
+    add_bucket(gstate.available_ram()/MEGA, 1);
+    add((int)have_max_concurrent);
+    add((int)(gpu_suspend_reason != 0));
+    for (unsigned int i=0; i<gstate.projects.size(); i++) {
+        PROJECT* p = gstate.projects[i];
+        add_ptr(p);
+        add(p->resource_share);
+        add((int)p->non_cpu_intensive);
+    }
+    for (unsigned int i=0; i<gstate.results.size(); i++) {
+        RESULT* rp = gstate.results[i];
+
+        // a backoff that has expired is cleared by work_fetch.rr_init()
+        //
+        if (rp->schedule_backoff && rp->schedule_backoff <= gstate.now) {
+            add(-1);
+        }
+        if (!rp->nearly_runnable()) continue;
+        if (rp->some_download_stalled()) continue;
+        add_ptr(rp);
+        add_ptr(rp->avp);
+        add_bucket(log(1 + rp->avp->flops), 20);
+        add(rp->state());
+        add((int)(rp->schedule_backoff > gstate.now));
+        add_bucket(log(1 + rp->estimated_runtime_remaining()), 20);
+    }
+}
 
+static double rr_sim_last_time = 0;
+static unsigned long long rr_sim_last_inputs = 0;
+
+void rr_simulation(const char* why) {
     if (log_flags.rr_simulation) {
         msg_printf(0, MSG_INFO, "[rr_sim] doing sim: %s", why);
     }
 
-    // CPU sched and work fetch both call this.
-    // We only need to do one simulation per moment.
+    // CPU sched and work fetch both call this,
+    // often several times a minute with nothing new to simulate.
+    // Skip the simulation if its inputs are the same as last time.
     //
-    if (last_time == gstate.now) {
+    RR_SIM_INPUTS inputs;
+    inputs.compute();
+    if (rr_sim_last_time
+        && gstate.now >= rr_sim_last_time
+        && gstate.now < rr_sim_last_time + RR_SIM_REUSE_PERIOD
+        && inputs.h == rr_sim_last_inputs
+    ) {
         if (log_flags.rr_simulation) {
-            msg_printf(0, MSG_INFO, "[rr_sim] already did at this time");
+            msg_printf(0, MSG_INFO,
+                "[rr_sim] inputs unchanged; using sim from %.2f sec ago",
+                gstate.now - rr_sim_last_time
+            );
         }
         return;
     }
-    last_time = gstate.now;
+    rr_sim_last_time = gstate.now;
+    rr_sim_last_inputs = inputs.h;
+    do_rr_simulation();
+}
+
+// do the simulation, whether or not the last one could be reused
+//
+void do_rr_simulation() {
     RR_SIM rr_sim;
     rr_sim.simulate();
 }
@@ -687,6 +865,10 @@ void rr_simulation(const char* why) {
 // ?? why not use RR sim result?
 //
 void get_nidle() {
+    // this overwrites nidle_now, so the next rr_simulation() must redo it
+    //
+    rr_sim_last_time = 0;
+
     int nidle_rsc = coprocs.n_rsc;
     for (int i=1; i<coprocs.n_rsc; i++) {
         rsc_work_fetch[i].nidle_now = coprocs.coprocs[i].count;
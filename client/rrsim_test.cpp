@@ -19,9 +19,19 @@
 // To use it:
 // - cut and paste the current code from cpu_sched.C (see below)
 // - edit main() to set up your test case
+//
+// build with e.g.
+// g++ -O2 -I.. -I../lib -o rrsim_test rrsim_test.cpp ../lib/libboinc.a -lpthread
 
-#include <vector>
 #include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "str_replace.h"
+#include "str_util.h"
+#include "util.h"
 
 using std::vector;
 
@@ -39,7 +49,7 @@ struct PROJECT {
     double cpu_shortfall;
     double rrsim_proc_rate;
     int rr_sim_deadlines_missed;
-    PROJECT(char* n, double rs) {
+    PROJECT(const char* n, double rs) {
         safe_strcpy(name,  n);
         resource_share = rs;
         non_cpu_intensive = false;
@@ -62,7 +72,7 @@ struct RESULT {
     bool rr_sim_misses_deadline;
     bool last_rr_sim_missed_deadline;
     PROJECT* project;
-    RESULT(PROJECT* p, char* n, double e, double rd) {
+    RESULT(PROJECT* p, const char* n, double e, double rd) {
         project = p;
         safe_strcpy(name,  n);
         ectr = e;
@@ -84,6 +94,9 @@ struct PREFS {
     double work_buf_min_days;
     double work_buf_additional_days;
     double cpu_scheduling_period_minutes;
+    double cpu_scheduling_period() {
+        return cpu_scheduling_period_minutes*60;
+    }
 };
 
 struct CLIENT_STATE {
@@ -419,6 +432,7 @@ bool CLIENT_STATE::rr_simulation() {
 int main() {
     PROJECT* p;
     RESULT* r;
+
     log_flags.rr_simulation = true;
 
     gstate.global_prefs.work_buf_min_days = 1;
@@ -553,6 +553,8 @@ void SCHEDULER_REPLY::clear() {
     send_time_stats_log = 0;
     send_job_log = 0;
     scheduler_version = 0;
+    safe_strcpy(list_digest_ack, "");
+    send_full_lists = false;
     got_rss_feeds = false;
     too_recent = false;
 }
@@ -894,6 +896,10 @@ int SCHEDULER_REPLY::parse(FILE* in, PROJECT* project) {
             continue;
         } else if (xp.parse_int("scheduler_version", scheduler_version)) {
             continue;
+        } else if (xp.parse_str("list_digest_ack", list_digest_ack, sizeof(list_digest_ack))) {
+            continue;
+        } else if (xp.parse_bool("send_full_lists", send_full_lists)) {
+            continue;
         } else if (xp.match_tag("project_files")) {
             retval = parse_project_files(xp, project_files);
 #ifdef ENABLE_AUTO_UPDATE
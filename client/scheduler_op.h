@@ -127,6 +127,10 @@ struct SCHEDULER_REPLY {
     int send_time_stats_log;
     int send_job_log;
     int scheduler_version;
+    char list_digest_ack[64];
+    bool send_full_lists;
+        // the scheduler couldn't apply our list changes
+        // and didn't send jobs; send full lists next time
 #ifdef ENABLE_AUTO_UPDATE
     AUTO_UPDATE auto_update;
 #endif
@@ -54,6 +54,11 @@
 //      use only RR scheduling
 //  [--rec_half_life X]
 //      half-life of recent est credit
+//
+//  Benchmark:
+//  [--bench_rr_sim N]
+//      Instead of simulating, time N round-robin simulations
+//      of the jobs in the state file (with logging off)
 
 #include <cmath>
 
@@ -103,6 +108,7 @@ bool server_uses_workload = false;
 bool cpu_sched_rr_only = false;
 bool existing_jobs_only = false;
 bool include_empty_projects;
+int bench_rr_sim_iters = 0;
 
 RANDOM_PROCESS on_proc;
 RANDOM_PROCESS active_proc;
@@ -127,7 +133,8 @@ void usage(char* prog) {
         "[--delta X]\n"
         "[--server_uses_workload]\n"
         "[--cpu_sched_rr_only]\n"
-        "[--rec_half_life X]\n",
+        "[--rec_half_life X]\n"
+        "[--bench_rr_sim N]\n",
         prog
     );
     exit(1);
@@ -279,6 +286,7 @@ void CLIENT_STATE::handle_completed_results(PROJECT* p) {
                 spp->project_results.nresults_met_deadline++;
             }
             html_msg += buf;
+            result_index.remove(rp);
             delete rp;
             result_iter = results.erase(result_iter);
         } else {
@@ -441,6 +449,7 @@ bool CLIENT_STATE::simulate_rpc(PROJECT* p) {
         sent_something = true;
         rp->set_state(RESULT_FILES_DOWNLOADED, "simulate_rpc");
         results.push_back(rp);
+        result_index.add(rp);
         new_results.push_back(rp);
 #if 0
         sprintf(buf, "got job %s: CPU time %.2f, deadline %s<br>",
@@ -1391,6 +1400,7 @@ void cull_projects() {
     while (ri != gstate.results.end()) {
         RESULT* rp = *ri;
         if (rp->project->ignore) {
+            gstate.result_index.remove(rp);
             ri = gstate.results.erase(ri);
         } else {
             ++ri;
@@ -1408,6 +1418,23 @@ void cull_projects() {
     }
 }
 
+// time the round-robin simulation of the current job queue
+//
+static void bench_rr_sim(int niters) {
+    LOG_FLAGS saved_log_flags = log_flags;
+    log_flags.init();
+    double t = dtime();
+    for (int i=0; i<niters; i++) {
+        do_rr_simulation();
+    }
+    t = dtime() - t;
+    log_flags = saved_log_flags;
+    printf("%d projects, %d jobs: %.3f ms per round-robin simulation\n",
+        (int)gstate.projects.size(), (int)gstate.results.size(),
+        1000*t/niters
+    );
+}
+
 void do_client_simulation() {
     char buf[256], buf2[256];
     int retval;
@@ -1502,6 +1529,11 @@ void do_client_simulation() {
 
     rec_adjust_period = delta;
 
+    if (bench_rr_sim_iters) {
+        bench_rr_sim(bench_rr_sim_iters);
+        return;
+    }
+
     gstate.request_work_fetch("init");
     simulate();
 
@@ -1574,6 +1606,8 @@ int main(int argc, char** argv) {
             include_empty_projects = true;
         } else if (!strcmp(opt, "--rec_half_life")) {
             cc_config.rec_half_life = atof(argv[i++]);
+        } else if (!strcmp(opt, "--bench_rr_sim")) {
+            bench_rr_sim_iters = atoi(next_arg(argc, argv, i));
         } else {
             usage(argv[0]);
         }
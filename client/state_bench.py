@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+# This file is part of BOINC.
+# http://boinc.berkeley.edu
+# Copyright (C) 2024 University of California
+#
+# BOINC is free software; you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License
+# as published by the Free Software Foundation,
+# either version 3 of the License, or (at your option) any later version.
+#
+# BOINC is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+# See the GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+# Benchmark client startup with a large synthetic client_state.xml.
+#
+# usage: state_bench.py [--client path] [--dir path] [--projects N] [--jobs N]
+#
+# Creates a data directory with the given number of projects and jobs per project
+# (each job has a workunit, an input file and an output file),
+# then runs the client with --show_projects, which exits
+# right after the state file has been parsed.
+# <statefile_debug> is set, so the client reports the parse time.
+
+import argparse, os, shutil, subprocess, time
+
+URL = 'http://bench%d.example.com/'
+PLATFORM = 'x86_64-pc-linux-gnu'
+
+def write_project(f, i, njobs):
+    url = URL%i
+    f.write('''<project>
+    <master_url>%s</master_url>
+    <project_name>bench%d</project_name>
+</project>
+<app>
+    <name>app</name>
+</app>
+<file_info>
+    <name>app_%d</name>
+    <nbytes>1</nbytes>
+    <status>1</status>
+    <executable/>
+</file_info>
+<app_version>
+    <app_name>app</app_name>
+    <version_num>100</version_num>
+    <platform>%s</platform>
+    <file_ref>
+        <file_name>app_%d</file_name>
+        <main_program/>
+    </file_ref>
+</app_version>
+'''%(url, i, i, PLATFORM, i))
+    for j in range(njobs):
+        f.write('''<file_info>
+    <name>in_%d_%d</name>
+    <nbytes>1</nbytes>
+    <status>1</status>
+</file_info>
+<file_info>
+    <name>out_%d_%d</name>
+    <max_nbytes>1000000</max_nbytes>
+    <upload_url>%supload</upload_url>
+</file_info>
+<workunit>
+    <name>wu_%d_%d</name>
+    <app_name>app</app_name>
+    <version_num>100</version_num>
+    <rsc_fpops_est>1e12</rsc_fpops_est>
+    <file_ref>
+        <file_name>in_%d_%d</file_name>
+        <open_name>in</open_name>
+    </file_ref>
+</workunit>
+<result>
+    <name>wu_%d_%d_0</name>
+    <wu_name>wu_%d_%d</wu_name>
+    <platform>%s</platform>
+    <version_num>100</version_num>
+    <report_deadline>%f</report_deadline>
+    <state>2</state>
+    <file_ref>
+        <file_name>out_%d_%d</file_name>
+        <open_name>out</open_name>
+    </file_ref>
+</result>
+'''%(i, j, i, j, url, i, j, i, j, i, j, i, j, PLATFORM,
+            time.time() + 7*86400, i, j
+        ))
+
+def make_dir(dir, nprojects, njobs):
+    if os.path.exists(dir):
+        shutil.rmtree(dir)
+    os.makedirs(dir)
+    with open(os.path.join(dir, 'cc_config.xml'), 'w') as f:
+        f.write('<cc_config><log_flags><statefile_debug>1</statefile_debug></log_flags></cc_config>\n')
+    with open(os.path.join(dir, 'client_state.xml'), 'w') as f:
+        f.write('<client_state>\n')
+        for i in range(nprojects):
+            write_project(f, i, njobs)
+        f.write('</client_state>\n')
+    for i in range(nprojects):
+        url = URL%i
+        name = 'account_%s.xml'%url[len('http://'):].rstrip('/').replace('/', '_')
+        with open(os.path.join(dir, name), 'w') as f:
+            f.write('<account>\n<master_url>%s</master_url>\n<authenticator>x</authenticator>\n</account>\n'%url)
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--client', default='./boinc')
+    parser.add_argument('--dir', default='state_bench_dir')
+    parser.add_argument('--projects', type=int, default=10)
+    parser.add_argument('--jobs', type=int, default=2000)
+    args = parser.parse_args()
+
+    dir = os.path.abspath(args.dir)
+    make_dir(dir, args.projects, args.jobs)
+    t = time.time()
+    subprocess.call([
+        os.path.abspath(args.client), '--dir', dir, '--show_projects',
+        '--no_gpus', '--no_gui_rpc', '--no_info_fetch', '--skip_cpu_benchmarks',
+        '--allow_multiple_clients'
+    ])
+    print('total time: %.3f sec'%(time.time() - t))
+
+main()
@@ -19,20 +19,32 @@
 #include <boinc_win.h>
 #endif
 
+#include "error_numbers.h"
+
 #include "thread.h"
 
+// set arg before starting the thread; it may use it right away.
+// Threads are never joined, so create them detached.
+//
 #ifdef _WIN32
 int THREAD::run(LPTHREAD_START_ROUTINE func, void* _arg) {
-    CreateThread(NULL, 0, func, this, 0, NULL);
+    arg = _arg;
+    quit_flag = false;
+    HANDLE h = CreateThread(NULL, 0, func, this, 0, NULL);
+    if (!h) return ERR_THREAD;
+    CloseHandle(h);
 #else
 int THREAD::run(void*(*func)(void*), void* _arg) {
     pthread_t id;
     pthread_attr_t thread_attrs;
+    arg = _arg;
+    quit_flag = false;
     pthread_attr_init(&thread_attrs);
+    pthread_attr_setdetachstate(&thread_attrs, PTHREAD_CREATE_DETACHED);
     int retval = pthread_create(&id, &thread_attrs, func, this);
+    pthread_attr_destroy(&thread_attrs);
     if (retval) return retval;
 #endif
-    arg = _arg;
     return 0;
 }
 
@@ -227,6 +227,7 @@ void RSC_WORK_FETCH::set_request(PROJECT* p) {
     // if this project has max concurrent,
     // use the project-specific "MC shortfall" instead of global shortfall
     //
+    double sf = shortfall;
     if (p->app_configs.project_has_mc) {
         RSC_PROJECT_WORK_FETCH& rsc_pwf = p->rsc_pwf[rsc_type];
         if (log_flags.work_fetch_debug) {
@@ -235,17 +236,17 @@ void RSC_WORK_FETCH::set_request(PROJECT* p) {
                 rsc_pwf.mc_shortfall, shortfall
             );
         }
-        shortfall = rsc_pwf.mc_shortfall;
+        sf = rsc_pwf.mc_shortfall;
     }
 
-    if (shortfall) {
+    if (sf) {
         if (wacky_dcf(p)) {
             // if project's DCF is too big or small,
             // its completion time estimates are useless; just ask for 1 second
             //
             req_secs = 1;
         } else {
-            req_secs = shortfall;
+            req_secs = sf;
             if (w.ncoprocs_excluded) {
                 req_secs *= non_excl_inst/ninstances;
             }
@@ -987,7 +988,7 @@ void WORK_FETCH::write_request(FILE* f, PROJECT* p) {
 // we just got a scheduler reply with the given jobs; update backoffs
 //
 void WORK_FETCH::handle_reply(
-    PROJECT* p, SCHEDULER_REPLY*, vector<RESULT*> new_results
+    PROJECT* p, SCHEDULER_REPLY* srp, vector<RESULT*> new_results
 ) {
     bool got_work[MAX_RSC];
     bool requested_work_rsc[MAX_RSC];
@@ -1008,8 +1009,10 @@ void WORK_FETCH::handle_reply(
         //   (i.e. don't back off because of a piggyback request)
         // - the RPC was done for a reason that is automatic
         //   and potentially frequent
+        // - the scheduler didn't hold off only until
+        //   we send our full file and job lists
         //
-        if (requested_work_rsc[i] && !got_work[i]) {
+        if (requested_work_rsc[i] && !got_work[i] && !srp->send_full_lists) {
             if (p->rsc_pwf[i].backoff_time < gstate.now) {
                 switch (p->sched_rpc_pending) {
                 case RPC_REASON_RESULTS_DUE:
@@ -1470,6 +1470,70 @@ int DB_HOST_APP_VERSION::update_validator(DB_HOST_APP_VERSION& orig) {
     return update_fields_noid(query, clause);
 }
 
+// Write the difference between this record and "orig"
+// (the values as read from the DB) as a row for merge_batch().
+// consecutive_valid and n_jobs_today are counters that are either
+// incremented or reset to zero; if they were reset ("cv_reset", "njt_reset")
+// we send -(value+1), meaning "set to value".
+//
+void DB_HOST_APP_VERSION::db_print_delta(
+    char* buf, HOST_APP_VERSION& orig, bool cv_reset, bool njt_reset
+) {
+    sprintf(buf,
+        "(%lu, %ld, %.15e, %.15e, %.15e, %.15e, %.15e, %.15e, %d, %d, "
+        "%.15e, %.15e, %.15e, %.15e, %d)",
+        host_id,
+        app_version_id,
+        pfc.n - orig.pfc.n,
+        pfc.avg - orig.pfc.avg,
+        et.n - orig.et.n,
+        et.avg - orig.et.avg,
+        et.var - orig.et.var,
+        et.q - orig.et.q,
+        max_jobs_per_day - orig.max_jobs_per_day,
+        njt_reset?-(n_jobs_today+1):n_jobs_today - orig.n_jobs_today,
+        turnaround.n - orig.turnaround.n,
+        turnaround.avg - orig.turnaround.avg,
+        turnaround.var - orig.turnaround.var,
+        turnaround.q - orig.turnaround.q,
+        cv_reset?-(consecutive_valid+1):consecutive_valid - orig.consecutive_valid
+    );
+}
+
+// Apply a batch of rows written by db_print_delta()
+// ("(a, b, ...), (c, d, ...)") in one statement.
+// Deltas are added to the current DB values,
+// so updates made concurrently by other processes
+// (e.g. the scheduler changing max_jobs_per_day) aren't lost.
+// If a row doesn't exist it's created.
+//
+int DB_HOST_APP_VERSION::merge_batch(std::string& values) {
+    std::string query =
+        "insert into host_app_version (host_id, app_version_id, "
+        "pfc_n, pfc_avg, et_n, et_avg, et_var, et_q, "
+        "max_jobs_per_day, n_jobs_today, "
+        "turnaround_n, turnaround_avg, turnaround_var, turnaround_q, "
+        "consecutive_valid) values "
+        + values +
+        " on duplicate key update "
+        "pfc_n=pfc_n+values(pfc_n), "
+        "pfc_avg=pfc_avg+values(pfc_avg), "
+        "et_n=et_n+values(et_n), "
+        "et_avg=et_avg+values(et_avg), "
+        "et_var=et_var+values(et_var), "
+        "et_q=et_q+values(et_q), "
+        "max_jobs_per_day=greatest(0, max_jobs_per_day+values(max_jobs_per_day)), "
+        "n_jobs_today=if(values(n_jobs_today)<0, "
+            "-values(n_jobs_today)-1, n_jobs_today+values(n_jobs_today)), "
+        "turnaround_n=turnaround_n+values(turnaround_n), "
+        "turnaround_avg=turnaround_avg+values(turnaround_avg), "
+        "turnaround_var=turnaround_var+values(turnaround_var), "
+        "turnaround_q=turnaround_q+values(turnaround_q), "
+        "consecutive_valid=if(values(consecutive_valid)<0, "
+            "-values(consecutive_valid)-1, consecutive_valid+values(consecutive_valid))";
+    return db->do_query(query.c_str());
+}
+
 void DB_HOST_APP_VERSION::db_print(char* buf) {
     sprintf(buf,
         "host_id=%lu, "
@@ -86,6 +86,10 @@ struct DB_HOST_APP_VERSION : public DB_BASE, public HOST_APP_VERSION {
     void db_parse(MYSQL_ROW &row);
     int update_scheduler(DB_HOST_APP_VERSION&);
     int update_validator(DB_HOST_APP_VERSION&);
+    void db_print_delta(
+        char*, HOST_APP_VERSION& orig, bool cv_reset, bool njt_reset
+    );
+    int merge_batch(std::string& values);
 };
 
 struct DB_USER_SUBMIT : public DB_BASE, public USER_SUBMIT {
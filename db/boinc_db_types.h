@@ -432,12 +432,16 @@ struct HOST_DELETED {
 #define TRANSITION_NO_NEW_RESULTS   2
     // transition, but don't create results; used for targeted jobs
 
-struct WORKUNIT {
+// The fields of a workunit other than xml_doc.
+// The scheduler's job cache (sched_shmem.h) stores this part
+// of each job separately from the (large) XML doc,
+// so that scanning the cache touches less memory.
+//
+struct WORKUNIT_BASE {
     DB_ID_TYPE id;
     int create_time;
     DB_ID_TYPE appid;                  // associated app
     char name[256];
-    char xml_doc[BLOB_SIZE];
     int batch;
         // projects can use this for any of several purposes:
         // - group together related jobs so you can use a DB query
@@ -503,6 +507,10 @@ struct WORKUNIT {
         // keywords, as space-separated integers
     int app_version_num;
         // if nonzero, use only this version num
+};
+
+struct WORKUNIT : WORKUNIT_BASE {
+    char xml_doc[BLOB_SIZE];
 
     void clear();
     WORKUNIT(){clear();}
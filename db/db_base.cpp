@@ -24,6 +24,7 @@
 #include "error_numbers.h"
 #include "str_util.h"
 #include "str_replace.h"
+#include "util.h"
 #include "db_base.h"
 
 #ifdef _USING_FCGI_
@@ -32,9 +33,11 @@
 #endif
 
 bool g_print_queries = false;
+void (*g_query_hook)(const char*, double) = 0;
 
 DB_CONN::DB_CONN() {
     mysql = 0;
+    use_prepared_statements = false;
 }
 
 int DB_CONN::open(
@@ -102,9 +105,145 @@ int DB_CONN::open(
 }
 
 void DB_CONN::close() {
+    close_stmts();
     if (mysql) mysql_close(mysql);
 }
 
+////////// PREPARED STATEMENTS ///////////
+
+// initial size of result column buffers;
+// they're enlarged as needed
+//
+#define DB_STMT_BUF_SIZE    256
+#define DB_STMT_MAX_PARAMS  8
+
+DB_STMT::DB_STMT() {
+    stmt = 0;
+    nparams = 0;
+}
+
+DB_STMT::~DB_STMT() {
+    if (stmt) mysql_stmt_close(stmt);
+}
+
+int DB_STMT::prepare(MYSQL* mysql, const char* sql) {
+    stmt = mysql_stmt_init(mysql);
+    if (!stmt) return ERR_DB_CANT_INIT;
+    if (mysql_stmt_prepare(stmt, sql, strlen(sql))) return -1;
+    nparams = mysql_stmt_param_count(stmt);
+    if (nparams > DB_STMT_MAX_PARAMS) return -1;
+
+    unsigned int n = 0;
+    MYSQL_RES* meta = mysql_stmt_result_metadata(stmt);
+    if (meta) {
+        n = mysql_num_fields(meta);
+        mysql_free_result(meta);
+    }
+    result_bind.resize(n);
+    bufs.resize(n);
+    lengths.resize(n);
+    row.resize(n);
+    for (unsigned int i=0; i<n; i++) {
+        bufs[i].resize(DB_STMT_BUF_SIZE);
+        MYSQL_BIND& b = result_bind[i];
+        memset(&b, 0, sizeof(b));
+        b.buffer_type = MYSQL_TYPE_STRING;
+        b.buffer = &bufs[i][0];
+        b.buffer_length = bufs[i].size();
+        b.length = &lengths[i];
+    }
+    if (n && mysql_stmt_bind_result(stmt, &result_bind[0])) return -1;
+    return 0;
+}
+
+int DB_STMT::execute(DB_ID_TYPE* params, int n) {
+    MYSQL_BIND pb[DB_STMT_MAX_PARAMS];
+    long long vals[DB_STMT_MAX_PARAMS];
+
+    if ((unsigned int)n != nparams) return -1;
+    memset(pb, 0, sizeof(pb));
+    for (int i=0; i<n; i++) {
+        vals[i] = params[i];
+        pb[i].buffer_type = MYSQL_TYPE_LONGLONG;
+        pb[i].buffer = &vals[i];
+    }
+    if (n && mysql_stmt_bind_param(stmt, pb)) return -1;
+    if (mysql_stmt_execute(stmt)) return -1;
+
+    // buffer the result so that other queries can be done
+    // before free_result()
+    //
+    if (mysql_stmt_store_result(stmt)) return -1;
+    return 0;
+}
+
+int DB_STMT::fetch(MYSQL_ROW& r) {
+    int retval = mysql_stmt_fetch(stmt);
+    if (retval == MYSQL_NO_DATA) return ERR_DB_NOT_FOUND;
+    if (retval && retval != MYSQL_DATA_TRUNCATED) return -1;
+
+    // refetch truncated columns into larger buffers
+    //
+    bool rebind = false;
+    for (unsigned int i=0; i<bufs.size(); i++) {
+        if (lengths[i] >= bufs[i].size()) {
+            bufs[i].resize(lengths[i]+1);
+            result_bind[i].buffer = &bufs[i][0];
+            result_bind[i].buffer_length = bufs[i].size();
+            if (mysql_stmt_fetch_column(stmt, &result_bind[i], i, 0)) {
+                return -1;
+            }
+            rebind = true;
+        }
+        bufs[i][lengths[i]] = 0;
+        row[i] = &bufs[i][0];
+    }
+    if (rebind) {
+        mysql_stmt_bind_result(stmt, &result_bind[0]);
+    }
+    r = row.size()?&row[0]:NULL;
+    return 0;
+}
+
+void DB_STMT::free_result() {
+    mysql_stmt_free_result(stmt);
+}
+
+DB_STMT* DB_CONN::get_stmt(const char* sql) {
+    std::map<std::string, DB_STMT*>::iterator i = stmts.find(sql);
+    if (i != stmts.end()) return i->second;
+
+    DB_STMT* s = new DB_STMT;
+    if (s->prepare(mysql, sql)) {
+        // don't keep trying if the server doesn't support it
+        //
+        fprintf(stderr,
+            "Can't prepare statement: %s\nquery=%s\n",
+            s->stmt?mysql_stmt_error(s->stmt):error_string(), sql
+        );
+        delete s;
+        use_prepared_statements = false;
+        return NULL;
+    }
+    stmts[sql] = s;
+    return s;
+}
+
+void DB_CONN::drop_stmt(const char* sql) {
+    std::map<std::string, DB_STMT*>::iterator i = stmts.find(sql);
+    if (i == stmts.end()) return;
+    delete i->second;
+    stmts.erase(i);
+}
+
+void DB_CONN::close_stmts() {
+    std::map<std::string, DB_STMT*>::iterator i;
+    for (i = stmts.begin(); i != stmts.end(); ++i) {
+        delete i->second;
+    }
+    stmts.clear();
+}
+
 int DB_CONN::set_isolation_level(ISOLATION_LEVEL level) {
     const char* level_str;
     char query[256];
@@ -138,7 +277,13 @@ int DB_CONN::do_query(const char* p) {
         fprintf(stderr, "query: %s\n", p);
 #endif
     }
-    retval = mysql_query(mysql, p);
+    if (g_query_hook) {
+        double start = dtime();
+        retval = mysql_query(mysql, p);
+        g_query_hook(p, dtime()-start);
+    } else {
+        retval = mysql_query(mysql, p);
+    }
     if (retval) {
         fprintf(stderr, "Database error: %s\nquery=%s\n", error_string(), p);
     }
@@ -225,6 +370,10 @@ int DB_BASE::lookup_id(DB_ID_TYPE id) {
     MYSQL_ROW row;
     MYSQL_RES* rp;
 
+    if (db->use_prepared_statements) {
+        return lookup_prepared("id=?", &id, 1);
+    }
+
     sprintf(query, "select * from %s where id=%lu", table_name, id);
 
     retval = db->do_query(query);
@@ -356,6 +505,59 @@ int DB_BASE::lookup(const char* clause) {
     return 0;
 }
 
+int DB_BASE::lookup_prepared(
+    const char* where, DB_ID_TYPE* params, int nparams
+) {
+    char query[MAX_QUERY_LEN];
+    int retval;
+    MYSQL_ROW row;
+
+    if (db->use_prepared_statements) {
+        sprintf(query, "select * from %s where %s", table_name, where);
+        if (g_print_queries) {
+#ifdef _USING_FCGI_
+            log_messages.printf(MSG_NORMAL, "prepared query: %s\n", query);
+#else
+            fprintf(stderr, "prepared query: %s\n", query);
+#endif
+        }
+        DB_STMT* s = db->get_stmt(query);
+        if (s) {
+            double start = dtime();
+            retval = s->execute(params, nparams);
+            if (!retval) {
+                retval = s->fetch(row);
+                if (!retval) db_parse(row);
+                s->free_result();
+            }
+            if (g_query_hook) g_query_hook(query, dtime()-start);
+            if (!retval || retval == ERR_DB_NOT_FOUND) return retval;
+
+            // the statement may have become invalid,
+            // e.g. because of a reconnect.
+            // Drop it, and do a text query this time.
+            //
+            fprintf(stderr, "Database error: %s\nprepared query=%s\n",
+                mysql_stmt_error(s->stmt), query
+            );
+            db->drop_stmt(query);
+        }
+    }
+
+    std::string clause = "where ";
+    char buf[64];
+    int j = 0;
+    for (const char* p = where; *p; p++) {
+        if (*p == '?' && j < nparams) {
+            sprintf(buf, "%ld", params[j++]);
+            clause += buf;
+        } else {
+            clause += *p;
+        }
+    }
+    return lookup(clause.c_str());
+}
+
 int DB_BASE::update_fields_noid(const char* set_clause, const char* where_clause) {
     char query[MAX_QUERY_LEN];
     sprintf(query,
@@ -19,10 +19,14 @@
 #define _DB_BASE_
 
 #include <cstdlib>
+#include <map>
 #include <string>
+#include <vector>
 #include <mysql.h>
 
 extern bool g_print_queries;
+extern void (*g_query_hook)(const char* query, double elapsed);
+    // if set, called after each query with its elapsed time
 
 // if SQL columns are not 'not null', you must use these safe_atoi, safe_atof
 // instead of atoi, atof, since the strings returned by MySQL may be NULL.
@@ -61,6 +65,28 @@ enum ISOLATION_LEVEL {
 
 typedef long DB_ID_TYPE;
 
+// A prepared statement whose parameters are IDs.
+// Result columns are fetched as strings into buffers
+// that are kept between executions,
+// so that the usual db_parse() functions can be used.
+//
+struct DB_STMT {
+    MYSQL_STMT* stmt;
+    unsigned int nparams;
+    std::vector<MYSQL_BIND> result_bind;
+    std::vector<std::vector<char> > bufs;
+    std::vector<unsigned long> lengths;
+    std::vector<char*> row;
+
+    DB_STMT();
+    ~DB_STMT();
+    int prepare(MYSQL*, const char* sql);
+    int execute(DB_ID_TYPE* params, int nparams);
+    int fetch(MYSQL_ROW&);
+        // returns 0, ERR_DB_NOT_FOUND, or an error
+    void free_result();
+};
+
 // represents a connection to a database
 //
 class DB_CONN {
@@ -81,6 +107,15 @@ public:
     int get_double(const char* query, double&);
 
     MYSQL* mysql;
+
+    bool use_prepared_statements;
+        // use the binary protocol for lookups by ID
+    std::map<std::string, DB_STMT*> stmts;
+        // prepared statements, keyed by SQL
+    DB_STMT* get_stmt(const char* sql);
+        // return a prepared statement for the SQL, preparing it if needed
+    void drop_stmt(const char* sql);
+    void close_stmts();
 };
 
 // Base for derived classes that can access the DB
@@ -101,6 +136,10 @@ public:
     int get_field_str(const char*, char*, int);
     int lookup_id(DB_ID_TYPE id);
     int lookup(const char*);
+    int lookup_prepared(const char* where, DB_ID_TYPE* params, int nparams);
+        // "where" has a "?" for each param, e.g. "host_id=? and app_version_id=?".
+        // Uses a prepared statement if enabled for the connection;
+        // otherwise (or if that fails) a text query.
     int enumerate(const char* clause="", bool use_use_result=false);
     int end_enumerate();
     int count(long&, const char* clause="");
@@ -83,6 +83,7 @@ void APP_INIT_DATA::copy(const APP_INIT_DATA& a) {
     hostid                      = a.hostid;
     slot                        = a.slot;
     client_pid                  = a.client_pid;
+    msg_ring_version            = a.msg_ring_version;
     user_total_credit           = a.user_total_credit;
     user_expavg_credit          = a.user_expavg_credit;
     host_total_credit           = a.host_total_credit;
@@ -180,6 +181,9 @@ int write_init_data_file(FILE* f, APP_INIT_DATA& ai) {
 #else
     fprintf(f, "<shm_key>%d</shm_key>\n", ai.shmem_seg_name);
 #endif
+    if (ai.msg_ring_version) {
+        fprintf(f, "<msg_ring_version>%d</msg_ring_version>\n", ai.msg_ring_version);
+    }
     fprintf(f,
         "<slot>%d</slot>\n"
         "<client_pid>%d</client_pid>\n"
@@ -271,6 +275,7 @@ void APP_INIT_DATA::clear() {
     safe_strcpy(authenticator, "");
     slot = 0;
     client_pid = 0;
+    msg_ring_version = 0;
     user_total_credit = 0;
     user_expavg_credit = 0;
     host_total_credit = 0;
@@ -390,6 +395,7 @@ int parse_init_data_file(FILE* f, APP_INIT_DATA& ai) {
 #endif
         if (xp.parse_int("slot", ai.slot)) continue;
         if (xp.parse_int("client_pid", ai.client_pid)) continue;
+        if (xp.parse_int("msg_ring_version", ai.msg_ring_version)) continue;
         if (xp.parse_double("user_total_credit", ai.user_total_credit)) continue;
         if (xp.parse_double("user_expavg_credit", ai.user_expavg_credit)) continue;
         if (xp.parse_double("host_total_credit", ai.host_total_credit)) continue;
@@ -424,7 +430,7 @@ int parse_init_data_file(FILE* f, APP_INIT_DATA& ai) {
     return ERR_XML_PARSE;
 }
 
-APP_CLIENT_SHM::APP_CLIENT_SHM() : shm(NULL) {
+APP_CLIENT_SHM::APP_CLIENT_SHM() : shm(NULL), has_rings(false) {
 }
 
 bool MSG_CHANNEL::get_msg(char *msg) {
@@ -446,8 +452,84 @@ void MSG_CHANNEL::send_msg_overwrite(const char* msg) {
     buf[0] = 1;
 }
 
+// only the client (which creates the segment) calls this
+//
 void APP_CLIENT_SHM::reset_msgs() {
     memset(shm, 0, sizeof(SHARED_MEM));
+    shm->ring_header.client_ring_version = MSG_RING_VERSION;
+    has_rings = true;
+}
+
+// make sure a ring's contents are written before its pointers,
+// and read after them
+//
+#ifdef _WIN32
+#define MSG_RING_BARRIER()  MemoryBarrier()
+#else
+#define MSG_RING_BARRIER()  __sync_synchronize()
+#endif
+
+bool MSG_RING::put(const char* msg) {
+    size_t len = strlen(msg);
+    if (len > MSG_CHANNEL_SIZE-2) len = MSG_CHANNEL_SIZE-2;
+    unsigned int t = tail;
+    if (MSG_RING_SIZE - (t - head) < len + 2) return false;
+    buf[t++ % MSG_RING_SIZE] = (char)(len & 0xff);
+    buf[t++ % MSG_RING_SIZE] = (char)(len >> 8);
+    for (size_t i=0; i<len; i++) {
+        buf[t++ % MSG_RING_SIZE] = msg[i];
+    }
+    MSG_RING_BARRIER();
+    tail = t;
+    return true;
+}
+
+bool MSG_RING::get(char* msg) {
+    unsigned int h = head;
+    if (h == tail) return false;
+    MSG_RING_BARRIER();
+    size_t len = (unsigned char)buf[h++ % MSG_RING_SIZE];
+    len |= ((unsigned char)buf[h++ % MSG_RING_SIZE]) << 8;
+    if (len > MSG_CHANNEL_SIZE-2) len = MSG_CHANNEL_SIZE-2;
+    for (size_t i=0; i<len; i++) {
+        msg[i] = buf[h++ % MSG_RING_SIZE];
+    }
+    msg[len] = 0;
+    MSG_RING_BARRIER();
+    head = h;
+    return true;
+}
+
+MSG_RING* APP_CLIENT_SHM::ring(MSG_CHANNEL& channel) {
+    if (!has_rings) return NULL;
+    if (&channel == &shm->graphics_request) return NULL;
+    if (&channel == &shm->graphics_reply) return NULL;
+    return &shm->rings[&channel - &shm->process_control_request];
+}
+
+bool APP_CLIENT_SHM::send_msg(MSG_CHANNEL& channel, const char* msg) {
+    MSG_RING* r = ring(channel);
+    if (r
+        && shm->ring_header.client_ring_version >= MSG_RING_VERSION
+        && shm->ring_header.app_ring_version >= MSG_RING_VERSION
+    ) {
+        return r->put(msg);
+    }
+    return channel.send_msg(msg);
+}
+
+bool APP_CLIENT_SHM::get_msg(MSG_CHANNEL& channel, char* msg) {
+    if (channel.get_msg(msg)) return true;
+    MSG_RING* r = ring(channel);
+    if (r) return r->get(msg);
+    return false;
+}
+
+bool APP_CLIENT_SHM::has_msg(MSG_CHANNEL& channel) {
+    if (channel.has_msg()) return true;
+    MSG_RING* r = ring(channel);
+    if (r) return !r->empty();
+    return false;
 }
 
 // Resolve virtual name (in slot dir) to physical path (in project dir).
@@ -65,6 +65,52 @@ struct MSG_CHANNEL {
                             // write message, overwriting any msg already there
 };
 
+// Clients and apps that support it also use a ring buffer per channel,
+// which holds several messages, so that senders don't have to wait
+// until the previous message has been read.
+// Each message is a 2-byte length followed by the text
+// (at most MSG_CHANNEL_SIZE-2 bytes, no NUL).
+// head and tail are byte counts that wrap around;
+// head is written only by the receiver and tail only by the sender,
+// so no locking is needed.
+//
+// Protocol:
+// - The client creates a SHARED_MEM that includes the rings,
+//   sets MSG_RING_HEADER::client_ring_version,
+//   and passes the same version in APP_INIT_DATA::msg_ring_version.
+//   Old clients don't pass it, and their segment has no rings.
+// - An app that sees msg_ring_version sets app_ring_version.
+// - From then on both sides send on the rings.
+//   Receivers check the one-slot channel first and then the ring,
+//   so messages sent before the switch are received in order.
+// - The graphics channels are always one-slot.
+//
+#define MSG_RING_VERSION    1
+#define MSG_RING_SIZE       8192
+    // must be a power of 2
+
+struct MSG_RING {
+    volatile unsigned int head;
+    volatile unsigned int tail;
+    char buf[MSG_RING_SIZE];
+
+    bool put(const char*);
+        // add a message; return false if there's no room
+    bool get(char*);
+        // get the next message (buffer of MSG_CHANNEL_SIZE);
+        // return false if none
+    inline bool empty() {
+        return head == tail;
+    }
+};
+
+struct MSG_RING_HEADER {
+    volatile int client_ring_version;
+    volatile int app_ring_version;
+};
+
+#define NUM_MSG_CHANNELS    8
+
 struct SHARED_MEM {
     MSG_CHANNEL process_control_request;
         // core->app
@@ -98,8 +144,16 @@ struct SHARED_MEM {
     MSG_CHANNEL trickle_down;
         // core->app
         // <have_new_trickle_down/>
+
+    // the following exist only if client_ring_version is nonzero
+    //
+    MSG_RING_HEADER ring_header;
+    MSG_RING rings[NUM_MSG_CHANNELS];
+        // in the same order as the channels above
 };
 
+class APP_CLIENT_SHM;
+
 // MSG_QUEUE provides a queuing mechanism for shared-mem messages
 // (which don't have one otherwise)
 //
@@ -108,8 +162,8 @@ struct MSG_QUEUE {
     char name[256];
 	double last_block;	// last time we found message channel full
 	void init(char*);
-    void msg_queue_send(const char*, MSG_CHANNEL& channel);
-    void msg_queue_poll(MSG_CHANNEL& channel);
+    void msg_queue_send(const char*, APP_CLIENT_SHM&, MSG_CHANNEL& channel);
+    void msg_queue_poll(APP_CLIENT_SHM&, MSG_CHANNEL& channel);
 	int msg_queue_purge(const char*);
 	bool timeout(double);
 };
@@ -122,8 +176,19 @@ struct MSG_QUEUE {
 class APP_CLIENT_SHM {
 public:
     SHARED_MEM *shm;
+    bool has_rings;
+        // the segment includes message rings
 
     void reset_msgs();        // resets all messages and clears their flags
+        // and, in the client, sets up the rings
+
+    // Use the following rather than the MSG_CHANNEL functions;
+    // they use the ring if both sides support it
+    //
+    MSG_RING* ring(MSG_CHANNEL&);
+    bool send_msg(MSG_CHANNEL&, const char*);
+    bool get_msg(MSG_CHANNEL&, char*);
+    bool has_msg(MSG_CHANNEL&);
 
     APP_CLIENT_SHM();
 };
@@ -217,6 +282,8 @@ struct APP_INIT_DATA {
     //
     double checkpoint_period;     // recommended checkpoint period
     SHMEM_SEG_NAME shmem_seg_name;
+    int msg_ring_version;
+        // shared mem has message rings of this version (0 if none)
     double wu_cpu_time;       // cpu time from previous episodes
 
     APP_INIT_DATA();
@@ -222,12 +222,15 @@ void CC_CONFIG::defaults() {
     fetch_minimal_work = false;
     fetch_on_update = false;
     force_auth = "default";
+    hard_link_input_files = false;
     http_1_0 = false;
     http_transfer_timeout = 300;
     http_transfer_timeout_bps = 10;
     for (int i=1; i<NPROC_TYPES; i++) {
         ignore_gpu_instance[i].clear();
     }
+    max_async_verifies = 2;
+    max_download_ranges = 0;
     max_event_log_lines = DEFAULT_MAX_EVENT_LOG_LINES;
     max_file_xfers = 8;
     max_file_xfers_per_project = 2;
@@ -240,7 +243,9 @@ void CC_CONFIG::defaults() {
     no_info_fetch = false;
     no_opencl = false;
     no_priority_change = false;
+    numa_placement = false;
     os_random_only = false;
+    proc_tree_scan = false;
     process_priority = CONFIG_PRIORITY_UNSPECIFIED;
     process_priority_special = CONFIG_PRIORITY_UNSPECIFIED;
     proxy_info.clear();
@@ -261,6 +266,8 @@ void CC_CONFIG::defaults() {
     use_all_gpus = false;
     use_certs = false;
     use_certs_only = false;
+    use_cgroups = false;
+    use_content_store = false;
     vbox_window = false;
     ignore_tty.clear();
 }
@@ -373,6 +380,7 @@ int CC_CONFIG::parse_options(XML_PARSER& xp) {
             downcase_string(force_auth);
             continue;
         }
+        if (xp.parse_bool("hard_link_input_files", hard_link_input_files)) continue;
         if (xp.parse_bool("http_1_0", http_1_0)) continue;
         if (xp.parse_int("http_transfer_timeout", http_transfer_timeout)) continue;
         if (xp.parse_int("http_transfer_timeout_bps", http_transfer_timeout_bps)) continue;
@@ -388,6 +396,8 @@ int CC_CONFIG::parse_options(XML_PARSER& xp) {
             ignore_gpu_instance[PROC_TYPE_INTEL_GPU].push_back(n);
             continue;
         }
+        if (xp.parse_int("max_async_verifies", max_async_verifies)) continue;
+        if (xp.parse_int("max_download_ranges", max_download_ranges)) continue;
         if (xp.parse_int("max_event_log_lines", max_event_log_lines)) continue;
         if (xp.parse_int("max_file_xfers", max_file_xfers)) continue;
         if (xp.parse_int("max_file_xfers_per_project", max_file_xfers_per_project)) continue;
@@ -400,7 +410,9 @@ int CC_CONFIG::parse_options(XML_PARSER& xp) {
         if (xp.parse_bool("no_info_fetch", no_info_fetch)) continue;
         if (xp.parse_bool("no_opencl", no_opencl)) continue;
         if (xp.parse_bool("no_priority_change", no_priority_change)) continue;
+        if (xp.parse_bool("numa_placement", numa_placement)) continue;
         if (xp.parse_bool("os_random_only", os_random_only)) continue;
+        if (xp.parse_bool("proc_tree_scan", proc_tree_scan)) continue;
         if (xp.parse_int("process_priority", process_priority)) continue;
         if (xp.parse_int("process_priority_special", process_priority_special)) continue;
 #ifndef SIM
@@ -426,6 +438,8 @@ int CC_CONFIG::parse_options(XML_PARSER& xp) {
         if (xp.parse_bool("use_all_gpus", use_all_gpus)) continue;
         if (xp.parse_bool("use_certs", use_certs)) continue;
         if (xp.parse_bool("use_certs_only", use_certs_only)) continue;
+        if (xp.parse_bool("use_cgroups", use_cgroups)) continue;
+        if (xp.parse_bool("use_content_store", use_content_store)) continue;
         if (xp.parse_bool("vbox_window", vbox_window)) continue;
         if (xp.parse_string("ignore_tty", s)) {
             ignore_tty.push_back(s);
@@ -586,6 +600,7 @@ int CC_CONFIG::write(MIOFILE& out, LOG_FLAGS& log_flags) {
         "        <fetch_minimal_work>%d</fetch_minimal_work>\n"
         "        <fetch_on_update>%d</fetch_on_update>\n"
         "        <force_auth>%s</force_auth>\n"
+        "        <hard_link_input_files>%d</hard_link_input_files>\n"
         "        <http_1_0>%d</http_1_0>\n"
         "        <http_transfer_timeout>%d</http_transfer_timeout>\n"
         "        <http_transfer_timeout_bps>%d</http_transfer_timeout_bps>\n",
@@ -595,6 +610,7 @@ int CC_CONFIG::write(MIOFILE& out, LOG_FLAGS& log_flags) {
         fetch_minimal_work,
         fetch_on_update,
         force_auth.c_str(),
+        hard_link_input_files,
         http_1_0,
         http_transfer_timeout,
         http_transfer_timeout_bps
@@ -622,6 +638,8 @@ int CC_CONFIG::write(MIOFILE& out, LOG_FLAGS& log_flags) {
     }
 
     out.printf(
+        "        <max_async_verifies>%d</max_async_verifies>\n"
+        "        <max_download_ranges>%d</max_download_ranges>\n"
         "        <max_event_log_lines>%d</max_event_log_lines>\n"
         "        <max_file_xfers>%d</max_file_xfers>\n"
         "        <max_file_xfers_per_project>%d</max_file_xfers_per_project>\n"
@@ -634,9 +652,13 @@ int CC_CONFIG::write(MIOFILE& out, LOG_FLAGS& log_flags) {
         "        <no_info_fetch>%d</no_info_fetch>\n"
         "        <no_opencl>%d</no_opencl>\n"
         "        <no_priority_change>%d</no_priority_change>\n"
+        "        <numa_placement>%d</numa_placement>\n"
         "        <os_random_only>%d</os_random_only>\n"
+        "        <proc_tree_scan>%d</proc_tree_scan>\n"
         "        <process_priority>%d</process_priority>\n"
         "        <process_priority_special>%d</process_priority_special>\n",
+        max_async_verifies,
+        max_download_ranges,
         max_event_log_lines,
         max_file_xfers,
         max_file_xfers_per_project,
@@ -649,7 +671,9 @@ int CC_CONFIG::write(MIOFILE& out, LOG_FLAGS& log_flags) {
         no_info_fetch,
         no_opencl,
         no_priority_change,
+        numa_placement,
         os_random_only,
+        proc_tree_scan,
         process_priority,
         process_priority_special
     );
@@ -670,6 +694,8 @@ int CC_CONFIG::write(MIOFILE& out, LOG_FLAGS& log_flags) {
         "        <use_all_gpus>%d</use_all_gpus>\n"
         "        <use_certs>%d</use_certs>\n"
         "        <use_certs_only>%d</use_certs_only>\n"
+        "        <use_cgroups>%d</use_cgroups>\n"
+        "        <use_content_store>%d</use_content_store>\n"
         "        <vbox_window>%d</vbox_window>\n",
         rec_half_life/86400,
         report_results_immediately,
@@ -684,6 +710,8 @@ int CC_CONFIG::write(MIOFILE& out, LOG_FLAGS& log_flags) {
         use_all_gpus,
         use_certs,
         use_certs_only,
+        use_cgroups,
+        use_content_store,
         vbox_window
     );
     for (i=0; i<ignore_tty.size(); ++i) {
@@ -168,11 +168,20 @@ struct CC_CONFIG {
     bool fetch_minimal_work;
     bool fetch_on_update;
     std::string force_auth;
+    bool hard_link_input_files;
+        // hard-link (rather than copy) input files that are to be copied
+        // to the slot dir, and make them read-only
     bool http_1_0;
     int http_transfer_timeout_bps;
     int http_transfer_timeout;
     std::vector<int> ignore_gpu_instance[NPROC_TYPES];
     bool lower_client_priority;
+    int max_async_verifies;
+        // max # of downloaded files verified in parallel by worker threads;
+        // 0 means verify in the main loop
+    int max_download_ranges;
+        // download large files using up to this many concurrent
+        // HTTP Range requests; 0 or 1 means use a single request
     int max_event_log_lines;
     int max_file_xfers;
     int max_file_xfers_per_project;
@@ -185,7 +194,13 @@ struct CC_CONFIG {
     bool no_info_fetch;
     bool no_opencl;
     bool no_priority_change;
+    bool numa_placement;
+        // (Linux) bind each CPU task to CPUs and memory in one NUMA node
     bool os_random_only;
+    bool proc_tree_scan;
+        // (Linux) to get task memory and CPU usage,
+        // read /proc only for the client's process tree,
+        // rather than for every process on the host
     int process_priority;       // values in common_defs.h
     int process_priority_special;
     PROXY_INFO proxy_info;
@@ -203,6 +218,11 @@ struct CC_CONFIG {
     bool use_certs;
     bool use_certs_only;
         // overrides use_certs
+    bool use_cgroups;
+        // (Linux) run each task in its own cgroup (see client/cgroup.h)
+    bool use_content_store;
+        // (Unix) share identical downloaded files between projects
+        // and jobs (see client/content_store.h)
     bool vbox_window;
     std::vector<std::string> ignore_tty;
     std::string device_name;
@@ -40,6 +40,11 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <dirent.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
 
 #if HAVE_SYS_RESOURCE_H
 #include <sys/resource.h>
@@ -687,6 +692,77 @@ int boinc_touch_file(const char *path) {
     return -1;
 }
 
+#ifdef __linux__
+// have the kernel copy a file.
+// A reflink (FICLONE) shares the data blocks,
+// on filesystems that support it (Btrfs, XFS).
+// Otherwise copy_file_range() copies without going through user space,
+// and may do a reflink or a server-side copy (NFS, SMB) itself.
+// Returns ERR_NOT_IMPLEMENTED if neither works for these files.
+//
+static int kernel_copy(const char* orig, const char* newf, bool reflink_only) {
+    int in = open(orig, O_RDONLY|O_CLOEXEC);
+    if (in < 0) return ERR_FOPEN;
+    int out = open(newf, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0666);
+    if (out < 0) {
+        close(in);
+        return ERR_FOPEN;
+    }
+    int retval = ERR_NOT_IMPLEMENTED;
+#ifdef FICLONE
+    if (!ioctl(out, FICLONE, in)) {
+        retval = 0;
+    }
+#endif
+#ifdef SYS_copy_file_range
+    struct stat sbuf;
+    if (retval && !reflink_only && !fstat(in, &sbuf)) {
+        double nbytes = 0;
+        while (1) {
+            ssize_t n = syscall(SYS_copy_file_range,
+                in, NULL, out, NULL, BOINC_COPY_RANGE_SIZE, 0
+            );
+            if (n > 0) {
+                nbytes += n;
+                continue;
+            }
+            if (n == 0) {
+                // some filesystems (e.g. /proc) report EOF right away
+                //
+                if (nbytes || !sbuf.st_size) retval = 0;
+                break;
+            }
+            if (errno == EINTR) continue;
+            if (!nbytes && (errno == EXDEV || errno == ENOSYS
+                || errno == EINVAL || errno == EOPNOTSUPP || errno == EBADF)
+            ) {
+                break;
+            }
+            retval = ERR_FWRITE;
+            break;
+        }
+    }
+#endif
+    if (close(out) && !retval) retval = ERR_FCLOSE;
+    close(in);
+    return retval;
+}
+#endif
+
+// make a copy of a file that shares its data blocks (a "reflink").
+// This takes no time and no space.
+// Returns ERR_NOT_IMPLEMENTED if the OS or filesystem can't do this.
+//
+int boinc_reflink(const char* orig, const char* newf) {
+#if defined(__linux__) && defined(FICLONE)
+    int retval = kernel_copy(orig, newf, true);
+    if (retval == ERR_NOT_IMPLEMENTED) unlink(newf);
+    return retval;
+#else
+    return ERR_NOT_IMPLEMENTED;
+#endif
+}
+
 int boinc_copy(const char* orig, const char* newf) {
 #ifdef _WIN32
     if (!CopyFileA(orig, newf, FALSE)) {     // FALSE means overwrite OK
@@ -708,16 +784,26 @@ int boinc_copy(const char* orig, const char* newf) {
     FILE *src, *dst;
     int m, n;
     int retval = 0;
-    unsigned char buf[65536];
+#ifdef __linux__
+    retval = kernel_copy(orig, newf, false);
+    if (retval != ERR_NOT_IMPLEMENTED) return retval;
+    retval = 0;
+#endif
+    unsigned char* buf = (unsigned char*)malloc(BOINC_COPY_BUFSIZE);
+    if (!buf) return ERR_MALLOC;
     src = boinc_fopen(orig, "r");
-    if (!src) return ERR_FOPEN;
+    if (!src) {
+        free(buf);
+        return ERR_FOPEN;
+    }
     dst = boinc_fopen(newf, "w");
     if (!dst) {
         fclose(src);
+        free(buf);
         return ERR_FOPEN;
     }
     while (1) {
-        n = fread(buf, 1, sizeof(buf), src);
+        n = fread(buf, 1, BOINC_COPY_BUFSIZE, src);
         if (n <= 0) {
             // could be either EOF or an error.
             // Check for error case.
@@ -733,6 +819,7 @@ int boinc_copy(const char* orig, const char* newf) {
             break;
         }
     }
+    free(buf);
     if (fclose(src)){
        fclose(dst);
        return ERR_FCLOSE;
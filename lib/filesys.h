@@ -45,6 +45,11 @@
     // On Windows, retry for this period of time, since some other program
     // (virus scan, defrag, index) may have the file open.
 
+#define BOINC_COPY_BUFSIZE      (1024*1024)
+    // buffer size for boinc_copy() if the kernel can't do the copy
+#define BOINC_COPY_RANGE_SIZE   (64*1024*1024)
+    // max bytes per copy_file_range() call
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -55,6 +60,9 @@ extern "C" {
         // retry a few times on failure
         // Unix: set close-on-exec flag
     extern int boinc_copy(const char* orig, const char* newf);
+        // Linux: try a reflink, then copy_file_range(),
+        // then copy through a buffer
+    extern int boinc_reflink(const char* orig, const char* newf);
     extern int boinc_rename(const char* old, const char* newf);
     extern int boinc_mkdir(const char*);
 #ifdef _WIN32
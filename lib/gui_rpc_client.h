@@ -490,6 +490,47 @@ struct NOTICES {
     void clear();
 };
 
+// identifies a task or file transfer that no longer exists
+//
+struct STATE_CHANGE_KEY {
+    std::string project_url;
+    std::string name;
+};
+
+// The reply to get_state_changes():
+// the tasks and file transfers that were added or changed
+// since a given sequence number, and those that were removed.
+//
+struct CC_STATE_CHANGES {
+    double epoch;
+    int seqno;
+        // Pass these to the next call (get_state_changes() does this).
+        // Sequence numbers are valid only within an epoch,
+        // which changes when the client restarts.
+    bool full;
+        // results and file_transfers are complete lists,
+        // not just changes.  This happens on the first call,
+        // after a client restart, or if seqno is too old.
+    int msg_seqno;
+    int notice_seqno;
+        // highest message and public notice seqnos;
+        // call get_messages() or get_notices() if these increase
+    std::vector<RESULT*> results;
+    std::vector<FILE_TRANSFER*> file_transfers;
+    std::vector<STATE_CHANGE_KEY> deleted_results;
+    std::vector<STATE_CHANGE_KEY> deleted_file_transfers;
+
+    CC_STATE_CHANGES();
+    ~CC_STATE_CHANGES();
+
+    void clear();
+        // clear the change lists; keep epoch and seqno
+    void apply(RESULTS&, FILE_TRANSFERS&);
+        // merge the changes into lists obtained from
+        // get_results() and get_file_transfers() or earlier apply()s.
+        // The changed RESULTs and FILE_TRANSFERs are moved to the lists.
+};
+
 struct ACCT_MGR_INFO {
     std::string acct_mgr_name;
     std::string acct_mgr_url;
@@ -693,6 +734,10 @@ struct RPC_CLIENT {
     int get_results(RESULTS&, bool active_only = false);
     int get_old_results(std::vector<OLD_RESULT>&);
     int get_file_transfers(FILE_TRANSFERS&);
+    int get_state_changes(CC_STATE_CHANGES&);
+        // get changes since the epoch and seqno in the argument
+        // (zero the first time), and update them.
+        // Use this instead of polling get_results() and get_file_transfers()
     int get_simple_gui_info(SIMPLE_GUI_INFO&);
     int get_project_status(PROJECTS&);
     int get_all_projects_list(ALL_PROJECTS_LIST&);
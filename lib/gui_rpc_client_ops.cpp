@@ -57,6 +57,8 @@
 #include <algorithm>
 #endif
 
+#include <map>
+
 #include "diagnostics.h"
 #include "parse.h"
 #include "str_util.h"
@@ -1200,6 +1202,117 @@ void NOTICES::clear() {
     notices.clear();
 }
 
+CC_STATE_CHANGES::CC_STATE_CHANGES() {
+    epoch = 0;
+    seqno = 0;
+    clear();
+}
+
+CC_STATE_CHANGES::~CC_STATE_CHANGES() {
+    clear();
+}
+
+void CC_STATE_CHANGES::clear() {
+    unsigned int i;
+    full = false;
+    msg_seqno = 0;
+    notice_seqno = 0;
+    for (i=0; i<results.size(); i++) {
+        delete results[i];
+    }
+    results.clear();
+    for (i=0; i<file_transfers.size(); i++) {
+        delete file_transfers[i];
+    }
+    file_transfers.clear();
+    deleted_results.clear();
+    deleted_file_transfers.clear();
+}
+
+static string change_key(const char* project_url, const char* name) {
+    string s = project_url;
+    s += "\n";
+    s += name;
+    return s;
+}
+
+void CC_STATE_CHANGES::apply(RESULTS& rs, FILE_TRANSFERS& fts) {
+    unsigned int i;
+    std::map<string, unsigned int> index;
+    std::map<string, unsigned int>::iterator it;
+
+    if (full) {
+        rs.clear();
+        fts.clear();
+    }
+
+    // results: remove deleted ones, then replace or append.
+    // Do removals first; an item can be removed and then added again.
+    //
+    for (i=0; i<rs.results.size(); i++) {
+        index[change_key(rs.results[i]->project_url, rs.results[i]->name)] = i;
+    }
+    for (i=0; i<deleted_results.size(); i++) {
+        STATE_CHANGE_KEY& k = deleted_results[i];
+        it = index.find(change_key(k.project_url.c_str(), k.name.c_str()));
+        if (it == index.end()) continue;
+        delete rs.results[it->second];
+        rs.results[it->second] = NULL;
+    }
+    for (i=0; i<results.size(); i++) {
+        RESULT* rp = results[i];
+        string key = change_key(rp->project_url, rp->name);
+        it = index.find(key);
+        if (it == index.end()) {
+            index[key] = (unsigned int)rs.results.size();
+            rs.results.push_back(rp);
+        } else {
+            delete rs.results[it->second];
+            rs.results[it->second] = rp;
+        }
+    }
+    results.clear();
+    rs.results.erase(
+        std::remove(rs.results.begin(), rs.results.end(), (RESULT*)NULL),
+        rs.results.end()
+    );
+
+    // same for file transfers
+    //
+    index.clear();
+    for (i=0; i<fts.file_transfers.size(); i++) {
+        FILE_TRANSFER* ftp = fts.file_transfers[i];
+        index[change_key(ftp->project_url.c_str(), ftp->name.c_str())] = i;
+    }
+    for (i=0; i<deleted_file_transfers.size(); i++) {
+        STATE_CHANGE_KEY& k = deleted_file_transfers[i];
+        it = index.find(change_key(k.project_url.c_str(), k.name.c_str()));
+        if (it == index.end()) continue;
+        delete fts.file_transfers[it->second];
+        fts.file_transfers[it->second] = NULL;
+    }
+    for (i=0; i<file_transfers.size(); i++) {
+        FILE_TRANSFER* ftp = file_transfers[i];
+        string key = change_key(ftp->project_url.c_str(), ftp->name.c_str());
+        it = index.find(key);
+        if (it == index.end()) {
+            index[key] = (unsigned int)fts.file_transfers.size();
+            fts.file_transfers.push_back(ftp);
+        } else {
+            delete fts.file_transfers[it->second];
+            fts.file_transfers[it->second] = ftp;
+        }
+    }
+    file_transfers.clear();
+    fts.file_transfers.erase(
+        std::remove(
+            fts.file_transfers.begin(), fts.file_transfers.end(),
+            (FILE_TRANSFER*)NULL
+        ),
+        fts.file_transfers.end()
+    );
+}
+
 ACCT_MGR_INFO::ACCT_MGR_INFO() {
     clear();
 }
@@ -1559,6 +1672,75 @@ int RPC_CLIENT::get_file_transfers(FILE_TRANSFERS& t) {
     return retval;
 }
 
+static int parse_change_key(
+    XML_PARSER& xp, const char* end_tag, STATE_CHANGE_KEY& k
+) {
+    while (!xp.get_tag()) {
+        if (xp.match_tag(end_tag)) return 0;
+        if (xp.parse_string("project_url", k.project_url)) continue;
+        if (xp.parse_string("name", k.name)) continue;
+    }
+    return ERR_XML_PARSE;
+}
+
+int RPC_CLIENT::get_state_changes(CC_STATE_CHANGES& sc) {
+    int retval;
+    SET_LOCALE sl;
+    char buf[256];
+    RPC rpc(this);
+
+    sc.clear();
+    snprintf(buf, sizeof(buf),
+        "<get_state_changes>\n"
+        "  <epoch>%.0f</epoch>\n"
+        "  <seqno>%d</seqno>\n"
+        "</get_state_changes>\n",
+        sc.epoch, sc.seqno
+    );
+    retval = rpc.do_rpc(buf);
+    if (retval) return retval;
+    while (!rpc.xp.get_tag()) {
+        if (rpc.xp.match_tag("/state_changes")) return 0;
+        if (rpc.xp.parse_double("epoch", sc.epoch)) continue;
+        if (rpc.xp.parse_int("seqno", sc.seqno)) continue;
+        if (rpc.xp.parse_bool("full", sc.full)) continue;
+        if (rpc.xp.parse_int("msg_seqno", sc.msg_seqno)) continue;
+        if (rpc.xp.parse_int("notice_seqno", sc.notice_seqno)) continue;
+        if (rpc.xp.match_tag("result")) {
+            RESULT* rp = new RESULT();
+            rp->parse(rpc.xp);
+            sc.results.push_back(rp);
+            continue;
+        }
+        if (rpc.xp.match_tag("file_transfer")) {
+            FILE_TRANSFER* ftp = new FILE_TRANSFER();
+            ftp->parse(rpc.xp);
+            sc.file_transfers.push_back(ftp);
+            continue;
+        }
+        if (rpc.xp.match_tag("deleted_result")) {
+            STATE_CHANGE_KEY k;
+            if (!parse_change_key(rpc.xp, "/deleted_result", k)) {
+                sc.deleted_results.push_back(k);
+            }
+            continue;
+        }
+        if (rpc.xp.match_tag("deleted_file_transfer")) {
+            STATE_CHANGE_KEY k;
+            if (!parse_change_key(rpc.xp, "/deleted_file_transfer", k)) {
+                sc.deleted_file_transfers.push_back(k);
+            }
+            continue;
+        }
+        if (rpc.xp.match_tag("error")) {
+            // older clients don't have this RPC
+            //
+            return ERR_NOT_IMPLEMENTED;
+        }
+    }
+    return ERR_XML_PARSE;
+}
+
 int RPC_CLIENT::get_simple_gui_info(SIMPLE_GUI_INFO& info) {
     int retval;
     SET_LOCALE sl;
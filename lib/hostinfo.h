@@ -102,6 +102,12 @@ public:
 #ifdef _WIN32
     int n_processor_groups;
 #endif
+#ifdef __linux__
+    std::vector<std::vector<int> > numa_nodes;
+        // the CPUs in each NUMA node,
+        // one per physical core first.
+        // Not saved or reported; see get_numa_topology().
+#endif
 
     void clear_host_info();
     HOST_INFO();
@@ -145,6 +151,9 @@ public:
 #ifdef _WIN32
     void win_get_processor_info();
 #endif
+#ifdef __linux__
+    int get_numa_topology();
+#endif
 };
 
 extern void make_secure_random_string(char*);
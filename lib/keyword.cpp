@@ -80,8 +80,10 @@ int USER_KEYWORDS::parse(XML_PARSER& xp) {
         }
         if (xp.parse_int("yes", x)) {
             yes.push_back(x);
+            yes_bits.set(x);
         } else if (xp.parse_int("no", x)) {
             no.push_back(x);
+            no_bits.set(x);
         }
     }
     return ERR_XML_PARSE;
@@ -113,6 +115,53 @@ void JOB_KEYWORD_IDS::parse_str(char* buf) {
     }
 }
 
+void KEYWORD_BITSET::parse_str(const char* buf) {
+    clear();
+    const char* p = buf;
+    while (*p) {
+        char* q;
+        long x = strtol(p, &q, 10);
+        if (q == p) {
+            p++;
+            continue;
+        }
+        set((int)x);
+        p = q;
+    }
+}
+
+static inline int popcount64(unsigned long long x) {
+#ifdef __GNUC__
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    while (x) {
+        x &= x-1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Score a job's keywords against a user's preferences:
+// -1 if the job has a keyword the user doesn't want
+// (and didn't also ask for), else the number of wanted keywords.
+// Same as looping over the job's IDs, but a few ANDs per word.
+// Neither set may have overflow; the caller checks this.
+//
+double keyword_score_bits(USER_KEYWORDS& uks, KEYWORD_BITSET& jks) {
+    int score = 0;
+    for (int i=0; i<KEYWORD_BITSET_WORDS; i++) {
+        unsigned long long j = jks.bits[i];
+        unsigned long long y = j & uks.yes_bits.bits[i];
+        if (j & uks.no_bits.bits[i] & ~y) {
+            return -1;
+        }
+        score += popcount64(y);
+    }
+    return score;
+}
+
 #ifndef _USING_FCGI_
 
 // write list of full keywords
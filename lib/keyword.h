@@ -24,6 +24,42 @@
 #include <map>
 #include "parse.h"
 
+// Keyword IDs below this are represented in KEYWORD_BITSET.
+// Larger IDs are flagged as overflow and handled by the slow path.
+//
+#define KEYWORD_BITSET_WORDS    4
+#define KEYWORD_BITSET_MAX_ID   (KEYWORD_BITSET_WORDS*64)
+
+// a set of keyword IDs as a fixed-width bitmap.
+// This is a POD type so that it can live in the scheduler's shared memory.
+//
+struct KEYWORD_BITSET {
+    unsigned long long bits[KEYWORD_BITSET_WORDS];
+    bool overflow;
+        // some ID was too large to represent
+
+    inline void clear() {
+        memset(bits, 0, sizeof(bits));
+        overflow = false;
+    }
+    inline void set(int id) {
+        if (id < 0 || id >= KEYWORD_BITSET_MAX_ID) {
+            overflow = true;
+            return;
+        }
+        bits[id/64] |= 1ULL << (id%64);
+    }
+    inline bool empty() const {
+        if (overflow) return false;
+        for (int i=0; i<KEYWORD_BITSET_WORDS; i++) {
+            if (bits[i]) return false;
+        }
+        return true;
+    }
+    void parse_str(const char*);
+        // parse space-separated list; doesn't modify the string
+};
+
 // a keyword
 //
 struct KEYWORD {
@@ -55,10 +91,18 @@ struct KEYWORDS {
 struct USER_KEYWORDS {
     std::vector<int> yes;
     std::vector<int> no;
+    KEYWORD_BITSET yes_bits;
+    KEYWORD_BITSET no_bits;
+        // the above, encoded by parse()
+    USER_KEYWORDS() {
+        clear();
+    }
     int parse(XML_PARSER&);
     inline void clear() {
         yes.clear();
         no.clear();
+        yes_bits.clear();
+        no_bits.clear();
     }
     void write(FILE*);
     inline bool empty() {
@@ -66,6 +110,8 @@ struct USER_KEYWORDS {
     }
 };
 
+extern double keyword_score_bits(USER_KEYWORDS&, KEYWORD_BITSET&);
+
 // the keywords IDs associated with a job (workunit)
 //
 struct JOB_KEYWORD_IDS {
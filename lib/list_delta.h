@@ -0,0 +1,91 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOINC_LIST_DELTA_H
+#define BOINC_LIST_DELTA_H
+
+// Sending only the changes to a list
+// (e.g. the file and job lists in scheduler requests).
+// A list is a map from name to entry.
+// The sender finds the entries added or changed
+// since a list the receiver has (the base),
+// and the names of the entries removed;
+// the receiver applies these to its copy of the base.
+// Lists are labeled with a digest,
+// so that the two sides can tell whether they have the same base.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "md5_file.h"
+
+// the digest of a list whose entries are text
+//
+inline std::string list_digest(
+    const std::map<std::string, std::string>& items
+) {
+    std::string s;
+    std::map<std::string, std::string>::const_iterator i;
+    for (i = items.begin(); i != items.end(); ++i) {
+        s += i->first;
+        s += i->second;
+    }
+    return md5_string(s);
+}
+
+// find the changes from base to cur
+//
+template <class T>
+void make_list_delta(
+    const std::map<std::string, T>& base,
+    const std::map<std::string, T>& cur,
+    std::map<std::string, T>& changed,
+    std::vector<std::string>& removed
+) {
+    typename std::map<std::string, T>::const_iterator i, j;
+    changed.clear();
+    removed.clear();
+    for (i = cur.begin(); i != cur.end(); ++i) {
+        j = base.find(i->first);
+        if (j != base.end() && j->second == i->second) continue;
+        changed.insert(*i);
+    }
+    for (i = base.begin(); i != base.end(); ++i) {
+        if (cur.count(i->first)) continue;
+        removed.push_back(i->first);
+    }
+}
+
+// apply changes to a copy of the base
+//
+template <class T>
+void apply_list_delta(
+    std::map<std::string, T>& items,
+    const std::map<std::string, T>& changed,
+    const std::vector<std::string>& removed
+) {
+    typename std::map<std::string, T>::const_iterator i;
+    for (unsigned int k=0; k<removed.size(); k++) {
+        items.erase(removed[k]);
+    }
+    for (i = changed.begin(); i != changed.end(); ++i) {
+        items[i->first] = i->second;
+    }
+}
+
+#endif
@@ -128,36 +128,42 @@ int MIOFILE::_ungetc(int c) {
     return c;
 }
 
-// copy from a file to static buffer
+// copy input up to but not including end tag, to a char array.
+// Same as the FILE* versions in parse.cpp.
 //
 int copy_element_contents(MIOFILE& in, const char* end_tag, char* p, int len) {
-    char buf[256];
-    int n;
-
-    strlcpy(p, "", len);
-    while (in.fgets(buf, 256)) {
-        if (strstr(buf, end_tag)) {
-            return 0;
-        }
-        n = (int)strlen(buf);
-        if (n >= len-1) return ERR_XML_PARSE;
-        strlcat(p, buf, len);
-        len -= n;
+    string buf;
+    int retval = copy_element_contents(in, end_tag, buf);
+    if (retval) return retval;
+    if ((int)buf.size() > len-1) {
+        return ERR_BUFFER_OVERFLOW;
     }
-    return ERR_XML_PARSE;
+    strlcpy(p, buf.c_str(), len);
+    return 0;
 }
 
+// copy input up to but not including end tag, to a string
+//
 int copy_element_contents(MIOFILE& in, const char* end_tag, string& str) {
-    char buf[256];
+    int c;
+    size_t end_tag_len = strlen(end_tag);
+    size_t n = 0;
 
     str = "";
-    while (in.fgets(buf, 256)) {
-        if (strstr(buf, end_tag)) {
+    while (1) {
+        c = in._getc();
+        if (c == EOF) break;
+        str += c;
+        n++;
+        if (n < end_tag_len) {
+            continue;
+        }
+        const char* p = str.c_str() + n - end_tag_len;
+        if (!strcmp(p, end_tag)) {
+            str.erase(n-end_tag_len, end_tag_len);
             return 0;
         }
-        str += buf;
     }
-    fprintf(stderr, "copy_element_contents(): no end tag\n");
     return ERR_XML_PARSE;
 }
 
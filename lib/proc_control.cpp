@@ -69,7 +69,17 @@ void get_descendants(int pid, vector<int>& pids) {
     int retval;
     PROC_MAP pm;
     pids.clear();
+#ifdef __linux__
+    // we only need this process's subtree
+    //
+    vector<int> roots(1, pid);
+    retval = procinfo_setup_tree(pm, roots);
+    if (retval) {
+        retval = procinfo_setup(pm);
+    }
+#else
     retval = procinfo_setup(pm);
+#endif
     if (retval) return;
     get_descendants_aux(pm, pid, pids);
 #ifdef DEBUG
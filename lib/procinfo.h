@@ -33,6 +33,8 @@ struct PROCINFO {
     bool is_boinc_app;
     bool is_low_priority;
         // running at or below priority of BOINC apps
+    bool is_niced;
+        // (Linux) nice > 0; user time is counted as "nice" in /proc/stat
     char command[256];
     bool scanned;
 
@@ -55,6 +57,7 @@ struct PROCINFO {
         kernel_time = 0;
         is_boinc_app = false;
         is_low_priority = false;
+        is_niced = false;
         command[0] = 0;
         scanned = false;
         page_fault_rate = 0;
@@ -70,6 +73,15 @@ extern void find_children(PROC_MAP&);
 extern int procinfo_setup(PROC_MAP&);
     // call this first to get data structure
 
+extern int procinfo_setup_tree(PROC_MAP&, std::vector<int>& roots);
+    // (Linux) like procinfo_setup(), but only for the given processes
+    // and their descendants.
+    // Returns ERR_NOT_IMPLEMENTED if not supported;
+    // use procinfo_setup() in that case.
+
+extern int procinfo_host_cpu_time(double&);
+    // (Linux) total CPU time of non-niced processes since boot
+
 extern void procinfo_app(
     PROCINFO&, std::vector<int>* other_pids, PROC_MAP&, char* graphics_exec_file
 );
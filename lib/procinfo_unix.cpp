@@ -31,6 +31,7 @@
 #endif
 
 #include <cstdio>
+#include <cstdlib>
 #include <string.h>
 #include <sys/param.h>
 #include <ctype.h>
@@ -166,17 +167,62 @@ int PROC_STAT::parse(char* buf) {
     return 1;
 }
 
+#if !defined(HAVE_PROCFS_H) || !defined(HAVE__PROC_SELF_PSINFO)
+// get info for one process from /proc/PID/stat.
+// client_pid is the caller's PID (it's counted as a BOINC process)
+//
+static int get_proc_stat(int id, PROCINFO& p, int client_pid) {
+    char pidpath[MAXPATHLEN];
+    char buf[1024];
+    PROC_STAT ps;
+    int retval;
+
+    snprintf(pidpath, sizeof(pidpath), "/proc/%d/stat", id);
+    FILE* fd = fopen(pidpath, "r");
+    if (!fd) return ERR_FOPEN;
+    if (fgets(buf, sizeof(buf), fd) == NULL) {
+        retval = ERR_NULL;
+    } else {
+        retval = ps.parse(buf);
+    }
+    fclose(fd);
+
+    if (retval) {
+        // ps.parse() returns an error if the executable name contains ).
+        // In that case skip this process.
+        //
+        return retval;
+    }
+    p.clear();
+    p.id = ps.pid;
+    p.parentid = ps.ppid;
+    p.swap_size = ps.vsize;
+    // rss = pages, need bytes
+    // assumes page size = 4k
+    p.working_set_size = ps.rss * (float)getpagesize();
+    // page faults: I/O + non I/O
+    p.page_fault_count = ps.majflt + ps.minflt;
+    // times are in jiffies, need seconds
+    // assumes 100 jiffies per second
+    p.user_time = ps.utime / 100.;
+    p.kernel_time = ps.stime / 100.;
+    strlcpy(p.command, ps.comm, sizeof(p.command));
+    p.is_boinc_app = (p.id == client_pid || strcasestr(p.command, "boinc"));
+    p.is_low_priority = (ps.priority == 39);
+        // Internally Linux stores the process priority as nice + 20
+        // as -ve values are error codes. Thus this generally gives
+        // a process priority range of 39..0
+    p.is_niced = (ps.nice > 0);
+    return 0;
+}
+#endif
+
 // build table of all processes in system
 //
 int procinfo_setup(PROC_MAP& pm) {
     DIR *dir;
     dirent *piddir;
-    FILE* fd;
-    PROC_STAT ps;
-    char pidpath[MAXPATHLEN];
-    char buf[1024];
     int pid = getpid();
-    int retval;
 
     dir = opendir("/proc");
     if (!dir) {
@@ -191,6 +237,8 @@ int procinfo_setup(PROC_MAP& pm) {
 
 #if defined(HAVE_PROCFS_H) && defined(HAVE__PROC_SELF_PSINFO)  // solaris
         psinfo_t psinfo;
+        char pidpath[MAXPATHLEN];
+        FILE* fd;
         sprintf(pidpath, "/proc/%s/psinfo", piddir->d_name);
         fd = fopen(pidpath, "r");
         if (!fd) continue;
@@ -220,42 +268,8 @@ int procinfo_setup(PROC_MAP& pm) {
         p.is_boinc_app = (p.id == pid || strcasestr(p.command, "boinc"));
         pm.insert(std::pair<int, PROCINFO>(p.id, p));
 #else  // linux
-        sprintf(pidpath, "/proc/%s/stat", piddir->d_name);
-        fd = fopen(pidpath, "r");
-        if (!fd) continue;
-        if (fgets(buf, sizeof(buf), fd) == NULL) {
-            retval = ERR_NULL;
-        } else {
-            retval = ps.parse(buf);
-        }
-        fclose(fd);
-
-        if (retval) {
-            // ps.parse() returns an error if the executable name contains ).
-            // In that case skip this process.
-            //
-            continue;
-        }
         PROCINFO p;
-        p.clear();
-        p.id = ps.pid;
-        p.parentid = ps.ppid;
-        p.swap_size = ps.vsize;
-        // rss = pages, need bytes
-        // assumes page size = 4k
-        p.working_set_size = ps.rss * (float)getpagesize();
-        // page faults: I/O + non I/O
-        p.page_fault_count = ps.majflt + ps.minflt;
-        // times are in jiffies, need seconds
-        // assumes 100 jiffies per second
-        p.user_time = ps.utime / 100.;
-        p.kernel_time = ps.stime / 100.;
-        strlcpy(p.command, ps.comm, sizeof(p.command));
-        p.is_boinc_app = (p.id == pid || strcasestr(p.command, "boinc"));
-        p.is_low_priority = (ps.priority == 39);
-            // Internally Linux stores the process priority as nice + 20
-            // as -ve values are error codes. Thus this generally gives
-            // a process priority range of 39..0
+        if (get_proc_stat(atoi(piddir->d_name), p, pid)) continue;
         pm.insert(std::pair<int, PROCINFO>(p.id, p));
 #endif
     }
@@ -263,3 +277,92 @@ int procinfo_setup(PROC_MAP& pm) {
     find_children(pm);
     return 0;
 }
+
+#if !defined(HAVE_PROCFS_H) || !defined(HAVE__PROC_SELF_PSINFO)
+
+// add the IDs of the children of the given process to the list.
+// A process's children are listed per thread,
+// in /proc/PID/task/TID/children.
+//
+static void get_children(int id, vector<int>& pids) {
+    char path[MAXPATHLEN];
+    snprintf(path, sizeof(path), "/proc/%d/task", id);
+    DIR* dir = opendir(path);
+    if (!dir) return;
+    while (1) {
+        dirent* tdir = readdir(dir);
+        if (!tdir) break;
+        if (!isdigit(tdir->d_name[0])) continue;
+        snprintf(path, sizeof(path), "/proc/%d/task/%s/children", id, tdir->d_name);
+        FILE* f = fopen(path, "r");
+        if (!f) continue;
+        int child;
+        while (fscanf(f, "%d", &child) == 1) {
+            pids.push_back(child);
+        }
+        fclose(f);
+    }
+    closedir(dir);
+}
+
+// build a table of the given processes and their descendants.
+// This reads /proc only for those processes,
+// so it's much cheaper than procinfo_setup() on a host with many processes.
+// Needs /proc/PID/task/TID/children (Linux 3.5+ with CONFIG_PROC_CHILDREN);
+// returns ERR_NOT_IMPLEMENTED if that's missing.
+//
+int procinfo_setup_tree(PROC_MAP& pm, vector<int>& roots) {
+    static int have_children_files = -1;
+    int pid = getpid();
+
+    if (have_children_files < 0) {
+        char path[MAXPATHLEN];
+        snprintf(path, sizeof(path), "/proc/%d/task/%d/children", pid, pid);
+        have_children_files = (access(path, R_OK) == 0);
+    }
+    if (!have_children_files) return ERR_NOT_IMPLEMENTED;
+
+    vector<int> todo = roots;
+    while (todo.size()) {
+        int id = todo.back();
+        todo.pop_back();
+        if (pm.count(id)) continue;
+        PROCINFO p;
+        if (get_proc_stat(id, p, pid)) continue;
+        pm.insert(std::pair<int, PROCINFO>(p.id, p));
+        get_children(id, todo);
+    }
+    find_children(pm);
+    return 0;
+}
+
+// get the CPU time (user, system and interrupt) used by all processes
+// since boot, from /proc/stat.
+// This doesn't include the time of niced processes
+// (see PROCINFO::is_niced).
+//
+int procinfo_host_cpu_time(double& t) {
+    unsigned long long user, nice, system, idle, iowait, irq, softirq;
+    FILE* f = fopen("/proc/stat", "r");
+    if (!f) return ERR_FOPEN;
+    int n = fscanf(f, "cpu %llu %llu %llu %llu %llu %llu %llu",
+        &user, &nice, &system, &idle, &iowait, &irq, &softirq
+    );
+    fclose(f);
+    if (n != 7) return ERR_XML_PARSE;
+    // assumes 100 jiffies per second
+    t = (user + system + irq + softirq)/100.;
+    return 0;
+}
+
+#else
+
+int procinfo_setup_tree(PROC_MAP&, vector<int>&) {
+    return ERR_NOT_IMPLEMENTED;
+}
+
+int procinfo_host_cpu_time(double&) {
+    return ERR_NOT_IMPLEMENTED;
+}
+
+#endif
@@ -51,6 +51,9 @@ extern "C" int debug_printf(const char *fmt, ...);
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
 
 #include "error_numbers.h"
 
@@ -302,6 +305,39 @@ int detach_shmem(void* p) {
 
 #else
 
+#ifdef __linux__
+#ifndef HUGETLBFS_MAGIC
+#define HUGETLBFS_MAGIC 0x958458f6
+#endif
+
+// return the system's huge page size, from /proc/meminfo
+//
+static size_t huge_page_size() {
+    char buf[256];
+    unsigned long kb = 0;
+    FILE* f = fopen("/proc/meminfo", "r");
+    if (f) {
+        while (fgets(buf, sizeof(buf), f)) {
+            if (sscanf(buf, "Hugepagesize: %lu kB", &kb) == 1) break;
+        }
+        fclose(f);
+    }
+    if (!kb) kb = 2048;
+    return kb*1024;
+}
+
+static size_t round_to_huge_page(size_t size) {
+    size_t hps = huge_page_size();
+    return ((size + hps - 1)/hps)*hps;
+}
+
+static bool is_hugetlbfs(int fd) {
+    struct statfs sfs;
+    if (fstatfs(fd, &sfs)) return false;
+    return (unsigned long)sfs.f_type == (unsigned long)HUGETLBFS_MAGIC;
+}
+#endif
+
 // V6 mmap() shared memory for Unix/Linux/Mac
 //
 int create_shmem_mmap(const char *path, size_t size, void** pp) {
@@ -328,6 +364,21 @@ int create_shmem_mmap(const char *path, size_t size, void** pp) {
         close(fd);
         return ERR_SHMGET;
     }
+#ifdef __linux__
+    // files in hugetlbfs can't be written, only truncated,
+    // and their size must be a multiple of the huge page size
+    //
+    if (is_hugetlbfs(fd)) {
+        size = round_to_huge_page(size);
+        if (sbuf.st_size < (long)size) {
+            if (ftruncate(fd, size)) {
+                perror("ftruncate");
+                close(fd);
+                return ERR_SHMGET;
+            }
+        }
+    } else
+#endif
     if (sbuf.st_size < (long)size) {
         // The following 2 lines extend the file and clear its new 
         // area to all zeros because they write beyond the old EOF. 
@@ -396,8 +447,8 @@ int detach_shmem_mmap(void* p, size_t size) {
 
 // Compatibility routines for Unix/Linux/Mac V5 applications 
 //
-int create_shmem(key_t key, int size, gid_t gid, void** pp) {
-    int id;
+int create_shmem(key_t key, int size, gid_t gid, void** pp, bool huge_pages) {
+    int id = -1;
     
     // try 0666, then SHM_R|SHM_W
     // seems like some platforms require one or the other
@@ -411,7 +462,23 @@ int create_shmem(key_t key, int size, gid_t gid, void** pp) {
     // it's a big headache for anyone it affects,
     // and it's not a significant security issue.
     //
-    id = shmget(key, size, IPC_CREAT|0666);
+#if defined(__linux__) && defined(SHM_HUGETLB)
+    if (huge_pages) {
+        int hsize = (int)round_to_huge_page(size);
+        id = shmget(key, hsize, IPC_CREAT|SHM_HUGETLB|0666);
+        if (id < 0) {
+            perror("shmget SHM_HUGETLB");
+            fprintf(stderr, "shmem size: %d; using normal pages\n", hsize);
+        }
+    }
+#else
+    if (huge_pages) {
+        fprintf(stderr, "create_shmem: huge pages not supported\n");
+    }
+#endif
+    if (id < 0) {
+        id = shmget(key, size, IPC_CREAT|0666);
+    }
     if (id < 0) {
         id = shmget(key, size, IPC_CREAT|SHM_R|SHM_W);
     }
@@ -516,7 +583,7 @@ int print_shmem_info(key_t key) {
 // Platforms that don't have sys/shm.h will need stubs,
 // or alternate implementations
 
-int create_shmem(key_t, int size, gid_t gid, void**) {
+int create_shmem(key_t, int size, gid_t gid, void**, bool) {
    perror("create_shmem: not supported on this platform");
    return ERR_SHMGET;
 }
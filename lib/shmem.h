@@ -32,6 +32,13 @@
 // detach_shmem(): detach from a shared-mem segment.
 //    Once all processes have detached, the segment is destroyed
 // The above with _mmap: V6 mmap() shared memory for Unix/Linux/Mac
+//
+// Large segments can be backed by huge pages (Linux only),
+// which reduces TLB misses when the segment is scanned:
+// - create_shmem() with huge_pages=true uses SHM_HUGETLB,
+//   falling back to normal pages if none are available.
+// - create_shmem_mmap() on a file in a hugetlbfs mount
+//   rounds the size up to a multiple of the huge page size.
 
 #ifdef _WIN32
 HANDLE create_shmem(
@@ -46,7 +53,9 @@ extern int create_shmem_mmap(const char *path, size_t size, void** pp);
 extern int attach_shmem_mmap(const char *path, void** pp);
 extern int detach_shmem_mmap(void* p, size_t size);
 #endif
-extern int create_shmem(key_t, int size, gid_t gid, void**);
+extern int create_shmem(
+    key_t, int size, gid_t gid, void**, bool huge_pages=false
+);
 extern int attach_shmem(key_t, void**);
 extern int detach_shmem(void*);
 extern int shmem_info(key_t key);
@@ -391,8 +391,8 @@ int hav_lookup(
 ) {
     int retval;
     char buf[256];
-    sprintf(buf, "where host_id=%lu and app_version_id=%ld", hostid, gen_avid);
-    retval = hav.lookup(buf);
+    DB_ID_TYPE ids[2] = {hostid, gen_avid};
+    retval = hav.lookup_prepared("host_id=? and app_version_id=?", ids, 2);
     if (retval != ERR_DB_NOT_FOUND) return retval;
 
     // Here no HOST_APP_VERSION currently exists.
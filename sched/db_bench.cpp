@@ -0,0 +1,150 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2020 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+// db_bench [--n N]
+//
+// Compare text queries and prepared statements
+// for lookups of result, workunit, host and host_app_version records.
+// Does N lookups of random existing records of each type, both ways,
+// and shows elapsed and client CPU time.
+// Server CPU time can be compared using e.g. "top" on the DB server.
+// Doesn't modify anything.
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+#include "boinc_db.h"
+#include "error_numbers.h"
+#include "util.h"
+
+#include "sched_config.h"
+
+using std::vector;
+
+static double cpu_time() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec/1e6
+        + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec/1e6;
+}
+
+// get up to n IDs from a table
+//
+static int get_ids(DB_BASE& db, const char* field, int n, vector<DB_ID_TYPE>& ids) {
+    char query[256];
+    MYSQL_RES* rp;
+    MYSQL_ROW row;
+
+    sprintf(query, "select %s from %s order by rand() limit %d",
+        field, db.table_name, n
+    );
+    int retval = boinc_db.do_query(query);
+    if (retval) return retval;
+    rp = mysql_store_result(boinc_db.mysql);
+    if (!rp) return ERR_DB_NOT_FOUND;
+    while ((row = mysql_fetch_row(rp))) {
+        ids.push_back(atol(row[0]));
+    }
+    mysql_free_result(rp);
+    return 0;
+}
+
+static void bench(const char* name, DB_BASE& db, int n) {
+    vector<DB_ID_TYPE> ids;
+    int retval = get_ids(db, "id", n, ids);
+    if (retval || !ids.size()) {
+        printf("%s: no records\n", name);
+        return;
+    }
+    for (int p=0; p<2; p++) {
+        boinc_db.use_prepared_statements = (p == 1);
+        double t0 = dtime(), c0 = cpu_time();
+        for (unsigned int i=0; i<ids.size(); i++) {
+            db.lookup_id(ids[i]);
+        }
+        double dt = dtime()-t0, dc = cpu_time()-c0;
+        printf("%-12s %-9s %7d lookups: %8.3f sec elapsed, %8.3f sec CPU\n",
+            name, p?"prepared":"text", (int)ids.size(), dt, dc
+        );
+    }
+}
+
+static void bench_hav(int n) {
+    DB_HOST_APP_VERSION hav;
+    vector<DB_ID_TYPE> host_ids, av_ids;
+    int retval = get_ids(hav, "host_id", n, host_ids);
+    if (retval || !host_ids.size()) {
+        printf("host_app_version: no records\n");
+        return;
+    }
+    for (unsigned int i=0; i<host_ids.size(); i++) {
+        char buf[256];
+        sprintf(buf, "where host_id=%ld", host_ids[i]);
+        hav.lookup(buf);
+        av_ids.push_back(hav.app_version_id);
+    }
+    for (int p=0; p<2; p++) {
+        boinc_db.use_prepared_statements = (p == 1);
+        double t0 = dtime(), c0 = cpu_time();
+        for (unsigned int i=0; i<host_ids.size(); i++) {
+            DB_ID_TYPE x[2] = {host_ids[i], av_ids[i]};
+            hav.lookup_prepared("host_id=? and app_version_id=?", x, 2);
+        }
+        double dt = dtime()-t0, dc = cpu_time()-c0;
+        printf("%-12s %-9s %7d lookups: %8.3f sec elapsed, %8.3f sec CPU\n",
+            "hav", p?"prepared":"text", (int)host_ids.size(), dt, dc
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    int n = 10000;
+    for (int i=1; i<argc; i++) {
+        if (!strcmp(argv[i], "--n") && i+1 < argc) {
+            n = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: db_bench [--n N]\n");
+            exit(1);
+        }
+    }
+    int retval = config.parse_file();
+    if (retval) {
+        fprintf(stderr, "Can't parse config.xml: %s\n", boincerror(retval));
+        exit(1);
+    }
+    retval = boinc_db.open(
+        config.db_name, config.db_host, config.db_user, config.db_passwd
+    );
+    if (retval) {
+        fprintf(stderr, "can't open DB: %s\n", boinc_db.error_string());
+        exit(1);
+    }
+
+    DB_RESULT result;
+    DB_WORKUNIT wu;
+    DB_HOST host;
+    bench("result", result, n);
+    bench("workunit", wu, n);
+    bench("host", host, n);
+    bench_hav(n);
+    boinc_db.close();
+}
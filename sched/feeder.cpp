@@ -168,8 +168,8 @@ void signal_handler(int) {
 
 void cleanup_shmem() {
     ssp->ready = false;
-    detach_shmem((void*)ssp);
-    destroy_shmem(config.shmem_key);
+    detach_sched_shmem(ssp);
+    destroy_sched_shmem();
 }
 
 int check_reread_trigger() {
@@ -503,7 +503,8 @@ static bool scan_work_array(vector<DB_WORK_ITEM> &work_items) {
                 wu_result.res_priority = wi.res_priority;
                 wu_result.res_server_state = wi.res_server_state;
                 wu_result.res_report_deadline = wi.res_report_deadline;
-                wu_result.workunit = wi.wu;
+                ssp->set_wu(i, wi.wu);
+                wu_result.keyword_bits.parse_str(wi.wu.keywords);
                 wu_result.state = WR_STATE_PRESENT;
                 // If the workunit has already been allocated to a certain
                 // OS then it should be assigned quickly,
@@ -841,14 +842,14 @@ int main(int argc, char** argv) {
     destroy_semaphore(sema_key);
     create_semaphore(sema_key);
 
-    retval = destroy_shmem(config.shmem_key);
+    retval = destroy_sched_shmem();
     if (retval) {
         log_messages.printf(MSG_CRITICAL, "can't destroy shmem\n");
         exit(1);
     }
 
-    int shmem_size = sizeof(SCHED_SHMEM) + num_work_items*sizeof(WU_RESULT);
-    retval = create_shmem(config.shmem_key, shmem_size, 0 /* don't set GID */, &p);
+    int shmem_size = SCHED_SHMEM::size(num_work_items);
+    retval = create_sched_shmem(shmem_size, &p);
     if (retval) {
         log_messages.printf(MSG_CRITICAL, "can't create shmem\n");
         exit(1);
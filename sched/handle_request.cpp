@@ -59,6 +59,8 @@
 #include "sched_resend.h"
 #include "sched_send.h"
 #include "sched_config.h"
+#include "sched_latency.h"
+#include "sched_lists.h"
 #include "sched_locality.h"
 #include "sched_result.h"
 #include "sched_customize.h"
@@ -415,6 +417,7 @@ lookup_user_and_make_new_host:
                 } else {
                     if ((g_request->allow_multiple_clients != 1)
                         && (g_request->other_results.size() == 0)
+                        && !g_request->have_list_delta
                     ) {
                         mark_results_over(host);
                     }
@@ -440,7 +443,9 @@ make_new_host:
                 "[HOST#%lu] [USER#%lu] Found similar existing host for this user - assigned.\n",
                 host.id, host.userid
             );
-            if (g_request->other_results.size() == 0) {
+            if (g_request->other_results.size() == 0
+                && !g_request->have_list_delta
+            ) {
                 // mark host's jobs as abandoned
                 // if client has no jobs in progress
                 //
@@ -1179,12 +1184,17 @@ void process_request(char* code_sign_key) {
     HOST initial_host;
     unsigned int i;
     time_t t;
+    double phase_start;
+        // can't use LATENCY_TIMER here because of the gotos
 
     memset(&g_reply->wreq, 0, sizeof(g_reply->wreq));
 
-    // if client has sticky files we don't need any more, tell it
+    // if client has sticky files we don't need any more, tell it.
+    // If it sent only changes to its list, wait until we have the list.
     //
-    do_file_delete_regex();
+    if (!g_request->have_list_delta) {
+        do_file_delete_regex();
+    }
 
     // if different major version of BOINC, just send a message
     //
@@ -1252,7 +1262,9 @@ void process_request(char* code_sign_key) {
         goto leave;
     }
 
+    phase_start = dtime();
     retval = authenticate_user();
+    if (g_latency) g_latency->add(LAT_AUTHENTICATE, dtime()-phase_start);
     if (retval) goto leave;
     if (g_reply->user.id == 0) {
         log_messages.printf(MSG_CRITICAL, "No user ID!\n");
@@ -1261,6 +1273,13 @@ void process_request(char* code_sign_key) {
     initial_host = g_reply->host;
     g_reply->host.rpc_seqno = g_request->rpc_seqno;
 
+    handle_list_digest();
+    if (g_reply->send_full_lists) {
+        ok_to_send_work = false;
+    } else if (g_request->have_list_delta) {
+        do_file_delete_regex();
+    }
+
     g_reply->nucleus_only = false;
 
     log_request();
@@ -1362,7 +1381,9 @@ void process_request(char* code_sign_key) {
     read_host_app_versions();
     update_n_jobs_today();
 
+    phase_start = dtime();
     handle_results();
+    if (g_latency) g_latency->add(LAT_HANDLE_RESULTS, dtime()-phase_start);
     handle_file_xfer_results();
     if (config.enable_vda) {
         handle_vda();
@@ -1383,7 +1404,12 @@ void process_request(char* code_sign_key) {
             && (config.resend_lost_results || g_wreq->resend_lost_results)
             && !g_request->results_truncated
         ) {
-            if (resend_lost_work()) {
+            phase_start = dtime();
+            bool resent = resend_lost_work();
+            if (g_latency) {
+                g_latency->add(LAT_RESEND_LOST_WORK, dtime()-phase_start);
+            }
+            if (resent) {
                 if (config.debug_send) {
                     log_messages.printf(MSG_NORMAL,
                         "[send] Resent lost jobs, don't send more\n"
@@ -1513,6 +1539,7 @@ void handle_request(FILE* fin, FILE* fout, char* code_sign_key) {
     mf.init_file(fin);
     const char* p = sreq.parse(xp);
     double start_time = dtime();
+    LATENCY_TIMER request_timer(LAT_REQUEST);
     if (!p){
         process_request(code_sign_key);
 
@@ -1529,7 +1556,10 @@ void handle_request(FILE* fin, FILE* fout, char* code_sign_key) {
         log_user_messages();
     }
 
-    sreply.write(fout, sreq);
+    {
+        LATENCY_TIMER timer(LAT_WRITE_REPLY);
+        sreply.write(fout, sreq);
+    }
     log_messages.printf(MSG_NORMAL,
         "Scheduler ran %.3f seconds\n", dtime()-start_time
     );
@@ -0,0 +1,178 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2020 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+// Write-behind cache for host_app_version records.
+//
+// The validator, transitioner and scheduler read and update
+// the same host_app_version rows over and over
+// (pfc and elapsed time averages, turnaround, consecutive_valid,
+// max_jobs_per_day, n_jobs_today).
+// Each of these is a small write, and together they make up
+// a large share of DB write traffic.
+//
+// If <hav_cache_period> is set in config.xml,
+// lookups go through this cache,
+// and updates are kept in memory and written every hav_cache_period seconds
+// using one statement per HAV_CACHE_BATCH_SIZE records.
+// Updates are written as deltas relative to the values originally read,
+// so that concurrent updates from other processes are merged
+// rather than overwritten.
+
+#include <cstdlib>
+#include <string>
+
+#include "error_numbers.h"
+#include "util.h"
+
+#include "credit.h"
+#include "sched_config.h"
+#include "sched_msgs.h"
+
+#include "hav_cache.h"
+
+#define HAV_CACHE_BATCH_SIZE 500
+
+HAV_CACHE hav_cache;
+
+static void flush_at_exit() {
+    hav_cache.flush();
+}
+
+void HAV_CACHE::init(double p) {
+    period = p;
+    last_flush_time = dtime();
+    if (enabled()) {
+        atexit(flush_at_exit);
+    }
+}
+
+int HAV_CACHE::lookup(
+    DB_HOST_APP_VERSION& hav, DB_ID_TYPE hostid, DB_ID_TYPE gen_avid
+) {
+    nlookups++;
+    if (!enabled()) {
+        return hav_lookup(hav, hostid, gen_avid);
+    }
+    std::map<std::pair<DB_ID_TYPE, DB_ID_TYPE>, HAV_CACHE_ITEM>::iterator i;
+    i = items.find(std::make_pair(hostid, gen_avid));
+    if (i != items.end()) {
+        nhits++;
+        hav = i->second.hav;
+        return 0;
+    }
+    int retval = hav_lookup(hav, hostid, gen_avid);
+    if (retval) return retval;
+    add(hav);
+    return 0;
+}
+
+void HAV_CACHE::add(DB_HOST_APP_VERSION& hav) {
+    std::pair<DB_ID_TYPE, DB_ID_TYPE> key(hav.host_id, hav.app_version_id);
+    if (items.count(key)) return;
+    HAV_CACHE_ITEM& item = items[key];
+    item.hav = hav;
+    item.orig = hav;
+    item.dirty = false;
+    item.cv_reset = false;
+    item.njt_reset = false;
+}
+
+int HAV_CACHE::update(DB_HOST_APP_VERSION& hav, DB_HOST_APP_VERSION& orig) {
+    nupdates++;
+    if (!enabled()) {
+        return hav.update_validator(orig);
+    }
+
+    // if the record was flushed since the caller looked it up,
+    // "orig" is the baseline for the delta
+    //
+    add(orig);
+    HAV_CACHE_ITEM& item = items[std::make_pair(hav.host_id, hav.app_version_id)];
+
+    // these counters only decrease when they're reset to zero
+    //
+    if (hav.consecutive_valid < item.hav.consecutive_valid) {
+        item.cv_reset = true;
+    }
+    if (hav.n_jobs_today < item.hav.n_jobs_today) {
+        item.njt_reset = true;
+    }
+    item.hav = hav;
+    item.dirty = true;
+    return 0;
+}
+
+int HAV_CACHE::flush() {
+    std::map<std::pair<DB_ID_TYPE, DB_ID_TYPE>, HAV_CACHE_ITEM>::iterator i;
+    DB_HOST_APP_VERSION hav;
+    std::string values;
+    char buf[1024];
+    int n = 0, retval;
+
+    last_flush_time = dtime();
+    for (i = items.begin(); i != items.end(); ++i) {
+        HAV_CACHE_ITEM& item = i->second;
+        if (!item.dirty) continue;
+        item.hav.db_print_delta(buf, item.orig, item.cv_reset, item.njt_reset);
+        if (n) values += ", ";
+        values += buf;
+        n++;
+        if (n == HAV_CACHE_BATCH_SIZE) {
+            retval = hav.merge_batch(values);
+            if (retval) goto error;
+            nrecords_written += n;
+            nbatches++;
+            values.clear();
+            n = 0;
+        }
+    }
+    if (n) {
+        retval = hav.merge_batch(values);
+        if (retval) goto error;
+        nrecords_written += n;
+        nbatches++;
+    }
+    nflushes++;
+    items.clear();
+    return 0;
+
+error:
+    // Records in earlier batches have been written;
+    // drop everything rather than risk writing their deltas twice.
+    //
+    log_messages.printf(MSG_CRITICAL,
+        "HAV cache flush failed: %s\n", boincerror(retval)
+    );
+    items.clear();
+    return retval;
+}
+
+void HAV_CACHE::poll() {
+    if (!enabled()) return;
+    if (dtime() < last_flush_time + period) return;
+    flush();
+    print_stats();
+}
+
+void HAV_CACHE::print_stats() {
+    log_messages.printf(MSG_NORMAL,
+        "HAV cache: %d lookups, %.1f%% hits, %d updates; wrote %d records in %d batches\n",
+        nlookups, nlookups?(100.*nhits)/nlookups:0., nupdates,
+        nrecords_written, nbatches
+    );
+    clear_stats();
+}
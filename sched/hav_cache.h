@@ -0,0 +1,93 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2020 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOINC_HAV_CACHE_H
+#define BOINC_HAV_CACHE_H
+
+#include <map>
+#include <utility>
+
+#include "boinc_db.h"
+
+// a cached host_app_version record
+//
+struct HAV_CACHE_ITEM {
+    DB_HOST_APP_VERSION hav;
+        // current value
+    HOST_APP_VERSION orig;
+        // value when read from DB (or last written)
+    bool dirty;
+    bool cv_reset;
+        // consecutive_valid was reset since orig
+    bool njt_reset;
+        // n_jobs_today was reset since orig
+};
+
+// Write-behind cache of host_app_version records.
+// Lookups are served from memory;
+// updates are accumulated and written periodically in batches,
+// as deltas that are merged with the current DB values
+// (see DB_HOST_APP_VERSION::merge_batch()).
+//
+// The cache is emptied after each flush,
+// so records are never more than one period out of date.
+//
+struct HAV_CACHE {
+    std::map<std::pair<DB_ID_TYPE, DB_ID_TYPE>, HAV_CACHE_ITEM> items;
+    double period;
+        // flush this often; 0 means write through
+    double last_flush_time;
+
+    // statistics
+    int nlookups;
+    int nhits;
+    int nupdates;
+    int nflushes;
+    int nrecords_written;
+    int nbatches;
+
+    HAV_CACHE() {
+        period = 0;
+        last_flush_time = 0;
+        clear_stats();
+    }
+    void init(double period);
+    void clear_stats() {
+        nlookups = nhits = nupdates = 0;
+        nflushes = nrecords_written = nbatches = 0;
+    }
+    inline bool enabled() {
+        return period > 0;
+    }
+
+    int lookup(DB_HOST_APP_VERSION&, DB_ID_TYPE hostid, DB_ID_TYPE gen_avid);
+        // like hav_lookup()
+    void add(DB_HOST_APP_VERSION&);
+        // add a record that's already been read from the DB
+    int update(DB_HOST_APP_VERSION& hav, DB_HOST_APP_VERSION& orig);
+        // record an update.
+        // If write-through, same as hav.update_validator(orig)
+    int flush();
+        // write all dirty records
+    void poll();
+        // flush if it's time
+    void print_stats();
+};
+
+extern HAV_CACHE hav_cache;
+
+#endif
@@ -28,6 +28,7 @@
 #include "sched_check.h"
 #include "sched_config.h"
 #include "sched_hr.h"
+#include "sched_keyword.h"
 #include "sched_main.h"
 #include "sched_msgs.h"
 #include "sched_send.h"
@@ -46,6 +47,7 @@
 // if any check fails, return false
 //
 static bool quick_check(
+    int index,                  // index of wu_result in job array
     WU_RESULT& wu_result,
     WORKUNIT& wu,       // a mutable copy of wu_result.workunit.
         // We may modify its delay_bound, rsc_fpops_est, and rsc_fpops_bound
@@ -132,7 +134,7 @@ static bool quick_check(
         if (app->locality_scheduling == LOCALITY_SCHED_LITE
             && g_request->file_infos.size()
         ) {
-            int n = nfiles_on_host(wu_result.workunit);
+            int n = nfiles_on_host(ssp->wu_xml_doc(index));
             if (config.debug_locality_lite) {
                 log_messages.printf(MSG_NORMAL,
                     "[loc_lite] job %s has %d files on this host\n",
@@ -226,6 +228,7 @@ static bool scan_work_array() {
     BEST_APP_VERSION* bavp;
     bool no_more_needed = false;
     SCHED_DB_RESULT result;
+    WORKUNIT wu;
 
     // To minimize the amount of time we lock the array,
     // we initially scan without holding the lock.
@@ -252,9 +255,10 @@ recheck:
         }
 
         // make a copy of the WORKUNIT part,
-        // which we can modify without affecting the cache
+        // which we can modify without affecting the cache.
+        // Don't copy the XML doc unless we send the job
         //
-        WORKUNIT wu = wu_result.workunit;
+        ssp->get_wu(i, wu, false);
 
         app = ssp->lookup_app(wu_result.workunit.appid);
         if (app == NULL) {
@@ -267,10 +271,21 @@ recheck:
 
         if (app->non_cpu_intensive) continue;
 
+        // skip jobs with keywords the user doesn't want
+        //
+        if (config.keyword_sched && keyword_score(i) < 0) {
+            if (config.debug_send_job) {
+                log_messages.printf(MSG_NORMAL,
+                    "[send_job] slot %d has unwanted keywords\n", i
+                );
+            }
+            continue;
+        }
+
         // do fast (non-DB) checks.
         // This may modify wu.rsc_fpops_est
         //
-        if (!quick_check(wu_result, wu, bavp, app, last_retval)) {
+        if (!quick_check(i, wu_result, wu, bavp, app, last_retval)) {
             if (config.debug_send_job) {
                 log_messages.printf(MSG_NORMAL,
                     "[send_job] slot %d failed quick check\n", i
@@ -315,6 +330,7 @@ recheck:
             //
             wu.hr_class = wu_result.workunit.hr_class;
             wu.app_version_id = wu_result.workunit.app_version_id;
+            ssp->get_wu_xml_doc(i, wu);
 
             // mark slot as empty AFTER we've copied out of it
             // (since otherwise feeder might overwrite it)
@@ -353,6 +369,7 @@ recheck:
 // with different selection criteria on each scan.
 //
 void send_work_old() {
+    LATENCY_TIMER timer(LAT_SEND_OLD);
     g_wreq->beta_only = false;
     g_wreq->user_apps_only = true;
     g_wreq->infeasible_only = false;
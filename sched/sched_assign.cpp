@@ -173,6 +173,7 @@ static int send_assigned_job(ASSIGNMENT& asg) {
 // Return true iff we sent anything
 //
 bool send_broadcast_jobs() {
+    LATENCY_TIMER timer(LAT_SEND_ASSIGNED);
     DB_RESULT result;
     int retval;
     char buf[256];
@@ -309,6 +310,7 @@ bool send_jobs(int assign_type) {
 // send targeted jobs
 //
 bool send_targeted_jobs() {
+    LATENCY_TIMER timer(LAT_SEND_ASSIGNED);
     bool sent_something = false;
     if (config.debug_send) {
         log_messages.printf(MSG_NORMAL, "checking for targeted jobs\n");
@@ -390,7 +390,7 @@ int slow_check(
     long n;
     DB_RESULT result;
     char buf[256];
-    WORKUNIT& wu = wu_result.workunit;
+    WORKUNIT_BASE& wu = wu_result.workunit;
 
     // Don't send if we've already sent a result of this WU to this user.
     //
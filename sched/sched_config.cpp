@@ -138,6 +138,7 @@ int SCHED_CONFIG::parse(FILE* f) {
         if (xp.parse_str("replica_db_host", replica_db_host, sizeof(replica_db_host))) continue;
         if (xp.parse_str("project_dir", project_dir, sizeof(project_dir))) continue;
         if (xp.parse_int("shmem_key", shmem_key)) continue;
+        if (xp.parse_bool("db_prepared_statements", db_prepared_statements)) continue;
         if (xp.parse_str("key_dir", key_dir, sizeof(key_dir))) continue;
         if (xp.parse_str("download_url", download_url, sizeof(download_url))) continue;
         if (xp.parse_str("download_dir", download_dir, sizeof(download_dir))) continue;
@@ -187,12 +188,15 @@ int SCHED_CONFIG::parse(FILE* f) {
         if (xp.parse_bool("distinct_beta_apps", distinct_beta_apps)) continue;
         if (xp.parse_bool("ended", ended)) continue;
         if (xp.parse_int("shmem_work_items", shmem_work_items)) continue;
+        if (xp.parse_bool("shmem_huge_pages", shmem_huge_pages)) continue;
+        if (xp.parse_str("shmem_mmap_file", shmem_mmap_file, sizeof(shmem_mmap_file))) continue;
         if (xp.parse_int("feeder_query_size", feeder_query_size)) continue;
         if (xp.parse_str("httpd_user", httpd_user, sizeof(httpd_user))) continue;
         if (xp.parse_bool("enable_vda", enable_vda)) continue;
         if (xp.parse_double("vda_host_timeout", vda_host_timeout)) continue;
         if (xp.parse_bool("enable_assignment", enable_assignment)) continue;
         if (xp.parse_bool("enable_assignment_multi", enable_assignment_multi)) continue;
+        if (xp.parse_bool("enable_list_deltas", enable_list_deltas)) continue;
         if (xp.parse_bool("job_size_matching", job_size_matching)) continue;
         if (xp.parse_bool("dont_send_jobs", dont_send_jobs)) continue;
         if (xp.parse_bool("estimate_flops_from_hav_pfc", estimate_flops_from_hav_pfc)) continue;
@@ -321,6 +325,7 @@ int SCHED_CONFIG::parse(FILE* f) {
         if (xp.parse_bool("prefer_primary_platform", prefer_primary_platform)) continue;
         if (xp.parse_double("version_select_random_factor", version_select_random_factor)) continue;
         if (xp.parse_double("maintenance_delay", maintenance_delay)) continue;
+        if (xp.parse_double("hav_cache_period", hav_cache_period)) continue;
         if (xp.parse_bool("credit_by_app", credit_by_app)) continue;
         if (xp.parse_bool("keyword_sched", keyword_sched)) continue;
         if (xp.parse_bool("rte_no_stats", rte_no_stats)) continue;
@@ -52,6 +52,8 @@ struct SCHED_CONFIG {
     char replica_db_passwd[256];
     char replica_db_host[256];
     int shmem_key;
+    bool db_prepared_statements;
+        // use prepared statements for lookups by ID
     char project_dir[256];
     char key_dir[256];
     char download_url[256];
@@ -91,6 +93,11 @@ struct SCHED_CONFIG {
         // Project has ended - tell clients to detach
     int shmem_work_items;
         // number of work items in shared memory
+    bool shmem_huge_pages;
+        // back the shared-memory segment with huge pages (Linux)
+    char shmem_mmap_file[256];
+        // if set, use a memory-mapped file (e.g. in hugetlbfs)
+        // rather than a SysV shared-memory segment
     int feeder_query_size;
         // number of work items to request in each feeder query
     char httpd_user[256];
@@ -99,6 +106,9 @@ struct SCHED_CONFIG {
     bool enable_vda;
     double vda_host_timeout;
     bool enable_assignment_multi;
+    bool enable_list_deltas;
+        // store hosts' lists of sticky files and in-progress jobs,
+        // so that clients can send only changes (see sched_lists.h)
     bool job_size_matching;
     bool dont_send_jobs;
     bool user_url;          // whether to export user.url in db dump
@@ -192,6 +202,10 @@ struct SCHED_CONFIG {
     // time intervals
     double maintenance_delay;
         // if stop_sched is set, tell clients to delay this much
+    double hav_cache_period;
+        // if nonzero, validators and transitioner cache host_app_version
+        // records and write changes in batches this often (seconds).
+        // See hav_cache.cpp
 
     // scheduler log flags
     //
@@ -18,7 +18,7 @@
 #ifndef BOINC_SCHED_HR_H
 #define BOINC_SCHED_HR_H
 
-extern bool already_sent_to_different_hr_class(WORKUNIT& workunit, APP&);
+extern bool already_sent_to_different_hr_class(WORKUNIT_BASE& workunit, APP&);
 
 extern bool hr_unknown_platform(HOST&);
 
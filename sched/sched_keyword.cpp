@@ -19,7 +19,13 @@
 //
 // A job's keywords are stored in workunit.keywords as a char string.
 // We don't want to parse that every time we score the job,
-// so we maintain a list of JOB_KEYWORD_IDS paralleling the job array.
+// so the feeder encodes it as a bitmap (WU_RESULT::keyword_bits),
+// and the user's yes/no keywords are encoded when the request is parsed.
+// Scoring is then a few ANDs and popcounts.
+//
+// If either side has keyword IDs too large for the bitmap,
+// we fall back to parsing the job's keywords into a list of JOB_KEYWORD_IDS
+// paralleling the job array.
 
 #include <algorithm>
 #include <iterator>
@@ -59,20 +65,31 @@ double keyword_score(int i) {
         return 0;
     }
 
-    // parse job keywords if not already done
-    //
-    JOB_KEYWORD_IDS& jk = job_keywords_array[i];
-    if (jk.empty()) {
-        WU_RESULT& wr = ssp->wu_results[i];
-        if (empty(wr.workunit.keywords)) {
-            if (config.debug_keyword) {
-                log_messages.printf(MSG_NORMAL, "[keyword] job has no keywords; returning 0\n");
-            }
-            return 0;
+    WU_RESULT& wr = ssp->wu_results[i];
+    if (wr.keyword_bits.empty()) {
+        if (config.debug_keyword) {
+            log_messages.printf(MSG_NORMAL, "[keyword] job has no keywords; returning 0\n");
+        }
+        return 0;
+    }
+
+    double s;
+    if (!wr.keyword_bits.overflow
+        && !uk.yes_bits.overflow && !uk.no_bits.overflow
+    ) {
+        s = keyword_score_bits(uk, wr.keyword_bits);
+    } else {
+        // parse job keywords if not already done.
+        // parse_str() modifies its argument, so use a copy
+        //
+        JOB_KEYWORD_IDS& jk = job_keywords_array[i];
+        if (jk.empty()) {
+            char buf[256];
+            safe_strcpy(buf, wr.workunit.keywords);
+            jk.parse_str(buf);
         }
-        jk.parse_str(wr.workunit.keywords);
+        s = keyword_score_aux(uk, jk);
     }
-    double s = keyword_score_aux(uk, jk);
     if (config.debug_keyword) {
         log_messages.printf(MSG_NORMAL, "[keyword] keyword score: %f\n", s);
     }
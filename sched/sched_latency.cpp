@@ -0,0 +1,145 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2020 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "config.h"
+#include <cstring>
+#include <strings.h>
+
+#include "sched_latency.h"
+
+SCHED_LATENCY* g_latency = 0;
+
+static const char* phase_names[NLATENCY_PHASES] = {
+    "request",
+    "authenticate",
+    "handle_results",
+    "resend_lost_work",
+    "send_assigned",
+    "send_nci",
+    "send_locality",
+    "send_old",
+    "send_score",
+    "write_reply",
+    "db_select",
+    "db_insert",
+    "db_update",
+    "db_delete",
+    "db_other"
+};
+
+const char* latency_phase_name(int i) {
+    if (i < 0 || i >= NLATENCY_PHASES) return "unknown";
+    return phase_names[i];
+}
+
+void LATENCY_HIST::add(double dt) {
+    unsigned long long usec = (dt > 0)?(unsigned long long)(dt*1e6):0;
+    unsigned long long x = usec;
+    int i = 0;
+    while (x >= 2 && i < LATENCY_NBUCKETS-1) {
+        x >>= 1;
+        i++;
+    }
+    __sync_fetch_and_add(&count[i], 1ULL);
+    __sync_fetch_and_add(&n, 1ULL);
+    __sync_fetch_and_add(&total_usec, usec);
+}
+
+void SCHED_LATENCY::clear() {
+    memset(this, 0, sizeof(*this));
+}
+
+// upper bound of bucket i, in seconds
+//
+static double bucket_limit(int i) {
+    return (double)(1ULL<<(i+1))/1e6;
+}
+
+// estimate a percentile from the histogram
+//
+static double hist_percentile(LATENCY_HIST& h, double frac) {
+    if (!h.n) return 0;
+    unsigned long long target = (unsigned long long)(frac*h.n);
+    unsigned long long sum = 0;
+    for (int i=0; i<LATENCY_NBUCKETS; i++) {
+        sum += h.count[i];
+        if (sum > target) return bucket_limit(i);
+    }
+    return bucket_limit(LATENCY_NBUCKETS-1);
+}
+
+void SCHED_LATENCY::print(FILE* f) {
+    fprintf(f, "%-18s %10s %10s %10s %10s\n",
+        "phase", "count", "mean", "p50<", "p99<"
+    );
+    for (int i=0; i<NLATENCY_PHASES; i++) {
+        LATENCY_HIST& h = hist[i];
+        if (!h.n) continue;
+        fprintf(f, "%-18s %10llu %9.4fs %9.4fs %9.4fs\n",
+            phase_names[i], h.n, (h.total_usec/1e6)/h.n,
+            hist_percentile(h, .5), hist_percentile(h, .99)
+        );
+    }
+}
+
+// Prometheus text exposition format
+//
+void SCHED_LATENCY::print_prometheus(FILE* f) {
+    fprintf(f,
+        "# HELP boinc_sched_latency_seconds Time spent in scheduler phases.\n"
+        "# TYPE boinc_sched_latency_seconds histogram\n"
+    );
+    for (int i=0; i<NLATENCY_PHASES; i++) {
+        LATENCY_HIST& h = hist[i];
+        unsigned long long sum = 0;
+        for (int j=0; j<LATENCY_NBUCKETS-1; j++) {
+            sum += h.count[j];
+            fprintf(f,
+                "boinc_sched_latency_seconds_bucket{phase=\"%s\",le=\"%g\"} %llu\n",
+                phase_names[i], bucket_limit(j), sum
+            );
+        }
+        fprintf(f,
+            "boinc_sched_latency_seconds_bucket{phase=\"%s\",le=\"+Inf\"} %llu\n",
+            phase_names[i], h.n
+        );
+        fprintf(f, "boinc_sched_latency_seconds_sum{phase=\"%s\"} %f\n",
+            phase_names[i], h.total_usec/1e6
+        );
+        fprintf(f, "boinc_sched_latency_seconds_count{phase=\"%s\"} %llu\n",
+            phase_names[i], h.n
+        );
+    }
+}
+
+void latency_query_hook(const char* query, double dt) {
+    if (!g_latency) return;
+    while (*query == ' ' || *query == '(') query++;
+    int phase;
+    if (!strncasecmp(query, "select", 6)) {
+        phase = LAT_DB_SELECT;
+    } else if (!strncasecmp(query, "insert", 6)) {
+        phase = LAT_DB_INSERT;
+    } else if (!strncasecmp(query, "update", 6)) {
+        phase = LAT_DB_UPDATE;
+    } else if (!strncasecmp(query, "delete", 6)) {
+        phase = LAT_DB_DELETE;
+    } else {
+        phase = LAT_DB_OTHER;
+    }
+    g_latency->add(phase, dt);
+}
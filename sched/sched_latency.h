@@ -0,0 +1,97 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2020 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+// Latency histograms for the phases of scheduler request handling.
+// These live in the shared-memory segment,
+// so they aggregate over all scheduler processes.
+// Updates use atomic adds; no locking is needed.
+// Use "show_shmem --latency" or "show_shmem --prometheus" to see them.
+
+#ifndef BOINC_SCHED_LATENCY_H
+#define BOINC_SCHED_LATENCY_H
+
+#include <cstdio>
+
+#include "util.h"
+
+enum LATENCY_PHASE {
+    LAT_REQUEST,
+        // all of handle_request()
+    LAT_AUTHENTICATE,
+    LAT_HANDLE_RESULTS,
+    LAT_RESEND_LOST_WORK,
+    LAT_SEND_ASSIGNED,
+    LAT_SEND_NCI,
+    LAT_SEND_LOCALITY,
+    LAT_SEND_OLD,
+    LAT_SEND_SCORE,
+    LAT_WRITE_REPLY,
+    LAT_DB_SELECT,
+    LAT_DB_INSERT,
+    LAT_DB_UPDATE,
+    LAT_DB_DELETE,
+    LAT_DB_OTHER,
+    NLATENCY_PHASES
+};
+
+// bucket i counts durations in [2^i, 2^(i+1)) microseconds;
+// the last bucket also counts anything longer
+//
+#define LATENCY_NBUCKETS 26
+
+struct LATENCY_HIST {
+    unsigned long long count[LATENCY_NBUCKETS];
+    unsigned long long n;
+    unsigned long long total_usec;
+
+    void add(double dt);
+};
+
+struct SCHED_LATENCY {
+    LATENCY_HIST hist[NLATENCY_PHASES];
+
+    void clear();
+    inline void add(int phase, double dt) {
+        hist[phase].add(dt);
+    }
+    void print(FILE*);
+    void print_prometheus(FILE*);
+};
+
+// where to record latencies; null (the default) means don't
+//
+extern SCHED_LATENCY* g_latency;
+
+extern const char* latency_phase_name(int);
+extern void latency_query_hook(const char* query, double dt);
+    // DB_CONN query hook; records by statement type
+
+// times the enclosing scope
+//
+struct LATENCY_TIMER {
+    int phase;
+    double start;
+    LATENCY_TIMER(int p) {
+        phase = p;
+        start = g_latency?dtime():0;
+    }
+    ~LATENCY_TIMER() {
+        if (g_latency) g_latency->add(phase, dtime()-start);
+    }
+};
+
+#endif
@@ -0,0 +1,259 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+// Per-host copies of the lists of sticky files and other results;
+// see sched_lists.h
+
+#include "config.h"
+#include "boinc_fcgi.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unistd.h>
+
+#include "error_numbers.h"
+#include "filesys.h"
+#include "list_delta.h"
+#include "miofile.h"
+#include "parse.h"
+#include "str_replace.h"
+
+#include "sched_config.h"
+#include "sched_main.h"
+#include "sched_msgs.h"
+#include "sched_types.h"
+
+#include "sched_lists.h"
+
+using std::map;
+using std::string;
+using std::vector;
+
+static const char* lists_dir(DB_ID_TYPE hostid) {
+    return config.project_path("sched_lists/%d", (int)(hostid % 1000));
+}
+
+// read the stored lists for a host
+//
+static int read_lists(
+    DB_ID_TYPE hostid, char* digest, int len,
+    vector<FILE_INFO>& fis, vector<OTHER_RESULT>& ors
+) {
+    char path[MAXPATHLEN];
+    int retval = ERR_XML_PARSE;
+
+    snprintf(path, sizeof(path), "%s/%lu", lists_dir(hostid), hostid);
+#ifndef _USING_FCGI_
+    FILE* f = fopen(path, "r");
+#else
+    FCGI_FILE* f = FCGI::fopen(path, "r");
+#endif
+    if (!f) return ERR_FOPEN;
+    MIOFILE mf;
+    XML_PARSER xp(&mf);
+    mf.init_file(f);
+    strcpy(digest, "");
+    if (!xp.parse_start("sched_lists")) {
+        fclose(f);
+        return ERR_XML_PARSE;
+    }
+    while (!xp.get_tag()) {
+        if (xp.match_tag("/sched_lists")) {
+            retval = 0;
+            break;
+        }
+        if (xp.parse_str("digest", digest, len)) continue;
+        if (xp.match_tag("file_info")) {
+            FILE_INFO fi;
+            if (!fi.parse(xp)) fis.push_back(fi);
+            continue;
+        }
+        if (xp.match_tag("other_result")) {
+            OTHER_RESULT o_r;
+            if (!o_r.parse(xp)) ors.push_back(o_r);
+            continue;
+        }
+    }
+    fclose(f);
+    return retval;
+}
+
+// store the lists in the request, labeled with their digest.
+// Write a temp file and rename it,
+// so that a failure leaves either the old lists or none.
+//
+static int write_lists(DB_ID_TYPE hostid) {
+    char dir[MAXPATHLEN], path[MAXPATHLEN], tmp_path[MAXPATHLEN];
+    unsigned int i;
+
+    safe_strcpy(dir, lists_dir(hostid));
+    if (!is_dir(dir)) {
+        boinc_mkdir(config.project_path("sched_lists"));
+        int retval = boinc_mkdir(dir);
+        if (retval) return retval;
+    }
+    snprintf(path, sizeof(path), "%s/%lu", dir, hostid);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+#ifndef _USING_FCGI_
+    FILE* f = fopen(tmp_path, "w");
+#else
+    FCGI_FILE* f = FCGI::fopen(tmp_path, "w");
+#endif
+    if (!f) return ERR_FOPEN;
+    fprintf(f,
+        "<sched_lists>\n"
+        "<digest>%s</digest>\n",
+        g_request->list_digest
+    );
+    for (i=0; i<g_request->file_infos.size(); i++) {
+        FILE_INFO& fi = g_request->file_infos[i];
+        fprintf(f,
+            "<file_info>\n"
+            "    <name>%s</name>\n"
+            "    <nbytes>%f</nbytes>\n"
+            "    <status>%d</status>\n"
+            "%s"
+            "</file_info>\n",
+            fi.name, fi.nbytes, fi.status,
+            fi.sticky?"    <sticky/>\n":""
+        );
+    }
+    for (i=0; i<g_request->other_results.size(); i++) {
+        OTHER_RESULT& o_r = g_request->other_results[i];
+        fprintf(f,
+            "<other_result>\n"
+            "    <name>%s</name>\n"
+            "    <app_version>%d</app_version>\n",
+            o_r.name, o_r.app_version
+        );
+        if (o_r.have_plan_class) {
+            fprintf(f, "    <plan_class>%s</plan_class>\n", o_r.plan_class);
+        }
+        fprintf(f, "</other_result>\n");
+    }
+    fprintf(f, "</sched_lists>\n");
+    if (fclose(f)) {
+        unlink(tmp_path);
+        return ERR_FWRITE;
+    }
+    if (rename(tmp_path, path)) {
+        unlink(tmp_path);
+        return ERR_RENAME;
+    }
+    return 0;
+}
+
+// replace the changes in the request with the full lists:
+// the stored lists, minus the entries removed,
+// with the entries added or changed.
+//
+static int rebuild_lists(DB_ID_TYPE hostid) {
+    char digest[MD5_LEN];
+    vector<FILE_INFO> fis;
+    vector<OTHER_RESULT> ors;
+    map<string, FILE_INFO> fi_map, fi_changed;
+    map<string, OTHER_RESULT> or_map, or_changed;
+    unsigned int i;
+
+    int retval = read_lists(hostid, digest, sizeof(digest), fis, ors);
+    if (retval) return retval;
+    if (strcmp(digest, g_request->list_base_digest)) {
+        return ERR_NOT_FOUND;
+    }
+    for (i=0; i<fis.size(); i++) {
+        fi_map[fis[i].name] = fis[i];
+    }
+    for (i=0; i<ors.size(); i++) {
+        or_map[ors[i].name] = ors[i];
+    }
+    for (i=0; i<g_request->file_infos.size(); i++) {
+        fi_changed[g_request->file_infos[i].name] = g_request->file_infos[i];
+    }
+    for (i=0; i<g_request->other_results.size(); i++) {
+        or_changed[g_request->other_results[i].name] = g_request->other_results[i];
+    }
+    apply_list_delta(fi_map, fi_changed, g_request->file_info_removes);
+    apply_list_delta(or_map, or_changed, g_request->other_result_removes);
+
+    g_request->file_infos.clear();
+    map<string, FILE_INFO>::iterator fi_iter;
+    for (fi_iter = fi_map.begin(); fi_iter != fi_map.end(); ++fi_iter) {
+        g_request->file_infos.push_back(fi_iter->second);
+    }
+    g_request->other_results.clear();
+    map<string, OTHER_RESULT>::iterator or_iter;
+    for (or_iter = or_map.begin(); or_iter != or_map.end(); ++or_iter) {
+        g_request->other_results.push_back(or_iter->second);
+    }
+    g_request->have_other_results_list = true;
+    return 0;
+}
+
+// Called after the host is authenticated,
+// before anything looks at file_infos or other_results.
+// If the client sent changes we can't apply
+// (e.g. we stored newer lists but our reply was lost)
+// act as if it sent no lists,
+// and tell it to send full lists soon.
+// Don't send it jobs until then: without the lists
+// we can't resend lost jobs or do locality scheduling.
+//
+void handle_list_digest() {
+    int retval;
+    DB_ID_TYPE hostid = g_reply->host.id;
+
+    if (g_request->have_list_delta) {
+        if (config.enable_list_deltas) {
+            retval = rebuild_lists(hostid);
+        } else {
+            retval = ERR_NOT_IMPLEMENTED;
+        }
+        if (retval) {
+            if (config.debug_send) {
+                log_messages.printf(MSG_NORMAL,
+                    "[send] [HOST#%lu] can't apply list changes (%s); will get full lists\n",
+                    hostid, boincerror(retval)
+                );
+            }
+            g_request->file_infos.clear();
+            g_request->other_results.clear();
+            g_request->have_other_results_list = false;
+            g_reply->send_full_lists = true;
+            g_reply->set_delay(DELAY_SEND_FULL_LISTS);
+            return;
+        }
+        if (config.debug_send) {
+            log_messages.printf(MSG_NORMAL,
+                "[send] [HOST#%lu] applied list changes: %d files, %d other results\n",
+                hostid, (int)g_request->file_infos.size(),
+                (int)g_request->other_results.size()
+            );
+        }
+    }
+    if (!config.enable_list_deltas) return;
+    if (!strlen(g_request->list_digest)) return;
+    retval = write_lists(hostid);
+    if (retval) {
+        log_messages.printf(MSG_CRITICAL,
+            "[HOST#%lu] can't store lists: %s\n", hostid, boincerror(retval)
+        );
+        return;
+    }
+    safe_strcpy(g_reply->list_digest_ack, g_request->list_digest);
+}
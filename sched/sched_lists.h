@@ -0,0 +1,39 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BOINC_SCHED_LISTS_H
+#define BOINC_SCHED_LISTS_H
+
+// Support for clients that send only the changes
+// to their lists of sticky files and other results
+// (<enable_list_deltas> in config.xml).
+//
+// A client that supports this sends <list_digest>,
+// a digest of the two lists, with the full lists.
+// We store the lists in sched_lists/<hostid%1000>/<hostid>
+// and send the digest back in <list_digest_ack>.
+// In later requests the client sends a <list_delta>:
+// the entries added or changed since the lists with a given digest,
+// and the names of the entries removed.
+// If that's what we have stored, we rebuild the full lists
+// in g_request and store them with the new digest.
+// Otherwise we send <send_full_lists/> and a short request delay,
+// don't send jobs, and the client sends full lists next time.
+
+extern void handle_list_digest();
+
+#endif
@@ -1134,6 +1134,7 @@ bool is_workunit_file(char*fname) {
 }
 
 void send_work_locality() {
+    LATENCY_TIMER timer(LAT_SEND_LOCALITY);
     int i, nsent, nfiles, j;
 
     // seed the random number generator
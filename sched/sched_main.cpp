@@ -59,9 +59,11 @@
 #include "util.h"
 
 #include "handle_request.h"
+#include "hav_cache.h"
 #include "sched_config.h"
 #include "sched_files.h"
 #include "sched_keyword.h"
+#include "sched_latency.h"
 #include "sched_msgs.h"
 #include "sched_types.h"
 #include "sched_util.h"
@@ -205,6 +207,7 @@ int open_database() {
         );
         return retval;
     }
+    boinc_db.use_prepared_statements = config.db_prepared_statements;
     db_opened = true;
     return 0;
 }
@@ -302,7 +305,7 @@ void attach_to_feeder_shmem() {
     int i, retval;
     void* p;
 
-    retval = attach_shmem(config.shmem_key, &p);
+    retval = attach_sched_shmem(&p);
     if (retval || p==0) {
         log_messages.printf(MSG_CRITICAL,
             "Can't attach shmem: %d (feeder not running?)\n",
@@ -345,6 +348,11 @@ void attach_to_feeder_shmem() {
         }
     }
 
+    // record phase and DB latencies in shared memory
+    //
+    g_latency = &ssp->latency;
+    g_query_hook = latency_query_hook;
+
     all_apps_use_hr = true;
     for (i=0; i<ssp->napps; i++) {
         if (!ssp->apps[i].homogeneous_redundancy) {
@@ -507,6 +515,7 @@ int main(int argc, char** argv) {
     gui_urls.init();
     project_files.init();
     init_file_delete_regex();
+    hav_cache.init(config.hav_cache_period);
 
     sprintf(path, "%s/code_sign_public", config.key_dir);
     retval = read_file_malloc(path, code_sign_key);
@@ -54,6 +54,9 @@
     // client asked for work but we didn't send any,
     // because user had too many results in cache.
     // Rely on client's exponential backoff
+#define DELAY_SEND_FULL_LISTS       60
+    // client sent changes to file and job lists we don't have;
+    // it will send full lists in its next request
 #define DELAY_MAX (2*86400)
     // maximum delay request
 
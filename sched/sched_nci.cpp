@@ -63,6 +63,7 @@ static bool can_send_nci(
 static int send_job_for_app(APP& app) {
     BEST_APP_VERSION* bavp;
     SCHED_DB_RESULT result;
+    WORKUNIT wu;
 
     lock_sema();
     for (int i=0; i<ssp->max_wu_results; i++) {
@@ -70,9 +71,8 @@ static int send_job_for_app(APP& app) {
         if (wu_result.state != WR_STATE_PRESENT && wu_result.state != g_pid) {
             continue;
         }
-        WORKUNIT wu = wu_result.workunit;
-
-        if (wu.appid != app.id) continue;
+        if (wu_result.workunit.appid != app.id) continue;
+        ssp->get_wu(i, wu, false);
 
         if (!can_send_nci(wu_result, wu, bavp, &app)) {
             // All jobs for a given NCI app are identical.
@@ -87,6 +87,7 @@ static int send_job_for_app(APP& app) {
         wu_result.state = g_pid;
         unlock_sema();
         result.id = wu_result.resultid;
+        ssp->get_wu_xml_doc(i, wu);
         wu_result.state = WR_STATE_EMPTY;
         if (result_still_sendable(result, wu)) {
             if (config.debug_send) {
@@ -113,6 +114,7 @@ static int send_job_for_app(APP& app) {
 // for which the host doesn't have a job in progress
 //
 int send_nci() {
+    LATENCY_TIMER timer(LAT_SEND_NCI);
     int retval;
     vector<APP> nci_apps;
     char buf[1024];
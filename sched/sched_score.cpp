@@ -100,7 +100,7 @@ bool JOB::get_score(int array_index) {
     if (app->locality_scheduling == LOCALITY_SCHED_LITE
         && g_request->file_infos.size()
     ) {
-        int n = nfiles_on_host(wu_result.workunit);
+        int n = nfiles_on_host(ssp->wu_xml_doc(array_index));
         if (config.debug_locality_lite) {
             log_messages.printf(MSG_NORMAL,
                 "[loc_lite] job %s has %d files on this host\n",
@@ -178,6 +178,7 @@ static void restore_others(int rt) {
 //
 void send_work_score_type(int rt) {
     vector<JOB> jobs;
+    WORKUNIT wu;
 
     if (config.debug_send_scan) {
         log_messages.printf(MSG_NORMAL,
@@ -200,7 +201,7 @@ void send_work_score_type(int rt) {
         if (wu_result.state != WR_STATE_PRESENT  && wu_result.state != g_pid) {
             continue;
         }
-        WORKUNIT wu = wu_result.workunit;
+        ssp->get_wu(i, wu, false);
         JOB job;
         job.app = ssp->lookup_app(wu.appid);
         if (job.app->non_cpu_intensive) {
@@ -298,7 +299,7 @@ void send_work_score_type(int rt) {
         if (wu_result.resultid != job.result_id) {
             continue;
         }
-        WORKUNIT wu = wu_result.workunit;
+        ssp->get_wu(job.index, wu, false);
         int retval = wu_is_infeasible_fast(
             wu,
             wu_result.res_server_state, wu_result.res_priority,
@@ -334,6 +335,7 @@ void send_work_score_type(int rt) {
             //
             wu.hr_class = wu_result.workunit.hr_class;
             wu.app_version_id = wu_result.workunit.app_version_id;
+            ssp->get_wu_xml_doc(job.index, wu);
 
             // mark slot as empty AFTER we've copied out of it
             // (since otherwise feeder might overwrite it)
@@ -371,6 +373,7 @@ void send_work_score_type(int rt) {
 }
 
 void send_work_score() {
+    LATENCY_TIMER timer(LAT_SEND_SCORE);
     for (int i=NPROC_TYPES-1; i>= 0; i--) {
         if (g_wreq->need_proc_type(i)) {
             send_work_score_type(i);
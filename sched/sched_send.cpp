@@ -37,6 +37,7 @@
 #include "synch.h"
 
 #include "credit.h"
+#include "hav_cache.h"
 #include "hr.h"
 #include "sched_array.h"
 #include "sched_assign.h"
@@ -78,9 +79,9 @@ static inline bool file_present_on_host(const char* name) {
 
 // return the number of sticky files present on host, used by job
 //
-int nfiles_on_host(WORKUNIT& wu) {
+int nfiles_on_host(const char* wu_xml_doc) {
     MIOFILE mf;
-    mf.init_buf_read(wu.xml_doc);
+    mf.init_buf_read(wu_xml_doc);
     XML_PARSER xp(&mf);
     int n=0;
     while (!xp.get_tag()) {
@@ -1575,6 +1576,17 @@ int update_host_app_versions(vector<SCHED_DB_RESULT>& results, int hostid) {
     for (i=0; i<new_havs.size(); i++) {
         DB_HOST_APP_VERSION& hav = new_havs[i];
 
+        // with the HAV cache, the record is created
+        // when write_host_app_versions() flushes the cache
+        //
+        if (hav_cache.enabled()) {
+            DB_HOST_APP_VERSION hav_orig;
+            hav_orig.clear();
+            hav_orig.host_id = hav.host_id;
+            hav_orig.app_version_id = hav.app_version_id;
+            hav_cache.update(hav, hav_orig);
+            continue;
+        }
         retval = hav.insert();
         if (retval) {
             log_messages.printf(MSG_CRITICAL,
@@ -58,6 +58,6 @@ extern void send_work_setup();
 extern int effective_ncpus();
 extern int selected_app_message_index;
 extern void update_n_jobs_today();
-extern int nfiles_on_host(WORKUNIT&);
+extern int nfiles_on_host(const char* wu_xml_doc);
 
 #endif
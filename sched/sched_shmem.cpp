@@ -26,12 +26,15 @@
 #include <string>
 #include <vector>
 #include <sys/param.h>
+#include <unistd.h>
 
 using std::vector;
 
 #include "boinc_db.h"
 #include "error_numbers.h"
 #include "filesys.h"
+#include "shmem.h"
+#include "str_util.h"
 
 #ifdef _USING_FCGI_
 #include "boinc_fcgi.h"
@@ -46,9 +49,9 @@ using std::vector;
 
 
 void SCHED_SHMEM::init(int nwu_results) {
-    int size = sizeof(SCHED_SHMEM) + nwu_results*sizeof(WU_RESULT);
-    memset(this, 0, size);
-    ss_size = size;
+    int n = size(nwu_results);
+    memset(this, 0, n);
+    ss_size = n;
     platform_size = sizeof(PLATFORM);
     app_size = sizeof(APP);
     app_version_size = sizeof(APP_VERSION);
@@ -94,13 +97,38 @@ int SCHED_SHMEM::verify() {
     if (max_assignments != MAX_ASSIGNMENTS) {
         return error_return("max assignments", MAX_ASSIGNMENTS, max_assignments);
     }
-    int size = sizeof(SCHED_SHMEM) + max_wu_results*sizeof(WU_RESULT);
-    if (ss_size != size) {
-        return error_return("shmem segment", size, ss_size);
+    int n = size(max_wu_results);
+    if (ss_size != n) {
+        return error_return("shmem segment", n, ss_size);
     }
     return 0;
 }
 
+// copy a job into slot i of the job array
+//
+void SCHED_SHMEM::set_wu(int i, WORKUNIT& wu) {
+    wu_results[i].workunit = wu;
+    strlcpy(wu_xml_doc(i), wu.xml_doc, BLOB_SIZE);
+}
+
+// copy the workunit in slot i.
+// When scanning the array, use get_xml_doc=false
+// and call get_wu_xml_doc() only when the job is actually sent
+// (but before the slot is marked empty).
+//
+void SCHED_SHMEM::get_wu(int i, WORKUNIT& wu, bool get_xml_doc) {
+    static_cast<WORKUNIT_BASE&>(wu) = wu_results[i].workunit;
+    if (get_xml_doc) {
+        get_wu_xml_doc(i, wu);
+    } else {
+        wu.xml_doc[0] = 0;
+    }
+}
+
+void SCHED_SHMEM::get_wu_xml_doc(int i, WORKUNIT& wu) {
+    strlcpy(wu.xml_doc, wu_xml_doc(i), BLOB_SIZE);
+}
+
 static void overflow(const char* table, const char* param_name) {
     log_messages.printf(MSG_CRITICAL,
         "The SCHED_SHMEM structure is too small for the %s table.\n"
@@ -443,3 +471,37 @@ void SCHED_SHMEM::show(FILE* f) {
         }
     }
 }
+
+int create_sched_shmem(int size, void** pp) {
+    if (strlen(config.shmem_mmap_file)) {
+        return create_shmem_mmap(config.shmem_mmap_file, size, pp);
+    }
+    return create_shmem(
+        config.shmem_key, size, 0 /* don't set GID */, pp,
+        config.shmem_huge_pages
+    );
+}
+
+int attach_sched_shmem(void** pp) {
+    if (strlen(config.shmem_mmap_file)) {
+        return attach_shmem_mmap(config.shmem_mmap_file, pp);
+    }
+    return attach_shmem(config.shmem_key, pp);
+}
+
+int detach_sched_shmem(SCHED_SHMEM* p) {
+    if (strlen(config.shmem_mmap_file)) {
+        return detach_shmem_mmap(p, p->ss_size);
+    }
+    return detach_shmem(p);
+}
+
+int destroy_sched_shmem() {
+    if (strlen(config.shmem_mmap_file)) {
+        // schedulers that are still attached keep their mapping
+        //
+        unlink(config.shmem_mmap_file);
+        return 0;
+    }
+    return destroy_shmem(config.shmem_key);
+}
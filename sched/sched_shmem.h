@@ -29,6 +29,7 @@
 #include "sched_types.h"
 #include "hr_info.h"
 #include "sched_customize.h"
+#include "sched_latency.h"
 
 // the following must be at least as large as DB tables
 // (counting only non-deprecated entries for the current major version)
@@ -63,22 +64,30 @@
 // If neither of the above, the value is the PID of a scheduler process
 // that has this item reserved
 
-// a workunit/result pair
+// a workunit/result pair.
+// The workunit's xml_doc is stored in a separate area
+// following the WU_RESULT array; see SCHED_SHMEM::wu_xml_doc()
+//
 struct WU_RESULT {
     int state;
         // EMPTY, PRESENT, or PID of locking process
     int infeasible_count;
     bool need_reliable;        // try to send to a reliable host
-    WORKUNIT workunit;
+    WORKUNIT_BASE workunit;
     DB_ID_TYPE resultid;
     int time_added_to_shared_memory;
     int res_priority;
     int res_server_state;
     double res_report_deadline;
     double fpops_size;      // measured in stdevs
+    KEYWORD_BITSET keyword_bits;
+        // workunit.keywords, encoded by the feeder
 };
 
-// this struct is followed in memory by an array of WU_RESULTS
+// this struct is followed in memory by an array of WU_RESULTS,
+// then by the xml_docs of the corresponding workunits
+// (BLOB_SIZE bytes each).
+// Scanning the job array touches only the first part.
 //
 struct SCHED_SHMEM {
     bool ready;             // feeder sets to true when init done
@@ -104,6 +113,8 @@ struct SCHED_SHMEM {
     bool have_nci_app;
     bool have_apps_for_proc_type[NPROC_TYPES];
     PERF_INFO perf_info;
+    SCHED_LATENCY latency;
+        // cleared when the feeder starts
     PLATFORM platforms[MAX_PLATFORMS];
     APP apps[MAX_APPS];
     APP_VERSION app_versions[MAX_APP_VERSIONS];
@@ -115,8 +126,18 @@ struct SCHED_SHMEM {
     WU_RESULT wu_results[0];
 #endif
 
+    static inline int size(int nwu_results) {
+        return sizeof(SCHED_SHMEM) + nwu_results*(sizeof(WU_RESULT) + BLOB_SIZE);
+    }
     void init(int nwu_results);
     int verify();
+
+    inline char* wu_xml_doc(int i) {
+        return (char*)(wu_results + max_wu_results) + (size_t)i*BLOB_SIZE;
+    }
+    void set_wu(int i, WORKUNIT&);
+    void get_wu(int i, WORKUNIT&, bool get_xml_doc=true);
+    void get_wu_xml_doc(int i, WORKUNIT&);
     int scan_tables();
     bool no_work(int pid);
     void restore_work(int pid);
@@ -143,4 +164,13 @@ struct SCHED_SHMEM {
     PLATFORM* lookup_platform(char*);
 };
 
+// Create, attach to, detach from and destroy the segment.
+// Depending on config.xml, this is either a SysV shared-memory segment
+// (optionally using huge pages) or a memory-mapped file.
+//
+extern int create_sched_shmem(int size, void** pp);
+extern int attach_sched_shmem(void** pp);
+extern int detach_sched_shmem(SCHED_SHMEM*);
+extern int destroy_sched_shmem();
+
 #endif
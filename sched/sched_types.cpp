@@ -30,6 +30,7 @@
 #include "util.h"
 #include "boinc_db.h"
 
+#include "hav_cache.h"
 #include "sched_main.h"
 #include "sched_util.h"
 #include "sched_msgs.h"
@@ -270,6 +271,9 @@ void SCHEDULER_REQUEST::clear() {
     results_truncated = false;
     have_other_results_list = false;
     have_ip_results_list = false;
+    strcpy(list_digest, "");
+    have_list_delta = false;
+    strcpy(list_base_digest, "");
     have_time_stats_log = false;
     client_cap_plan_class = false;
     sandbox = -1;
@@ -311,6 +315,9 @@ const char* SCHEDULER_REQUEST::parse(XML_PARSER& xp) {
     memset(&host, 0, sizeof(host));
     have_other_results_list = false;
     have_ip_results_list = false;
+    strcpy(list_digest, "");
+    have_list_delta = false;
+    strcpy(list_base_digest, "");
     have_time_stats_log = false;
     client_cap_plan_class = false;
     sandbox = -1;
@@ -512,6 +519,41 @@ const char* SCHEDULER_REQUEST::parse(XML_PARSER& xp) {
             }
             continue;
         }
+        if (xp.parse_str("list_digest", list_digest, sizeof(list_digest))) continue;
+        if (xp.match_tag("list_delta")) {
+            char buf[256];
+            have_list_delta = true;
+            while (!xp.get_tag()) {
+                if (xp.match_tag("/list_delta")) break;
+                if (xp.parse_str("base_digest", list_base_digest, sizeof(list_base_digest))) continue;
+                if (xp.parse_str("digest", list_digest, sizeof(list_digest))) continue;
+                if (xp.match_tag("file_info")) {
+                    FILE_INFO fi;
+                    retval = fi.parse(xp);
+                    if (!retval) {
+                        file_infos.push_back(fi);
+                    }
+                    continue;
+                }
+                if (xp.match_tag("other_result")) {
+                    OTHER_RESULT o_r;
+                    retval = o_r.parse(xp);
+                    if (!retval) {
+                        other_results.push_back(o_r);
+                    }
+                    continue;
+                }
+                if (xp.parse_str("remove_file_info", buf, sizeof(buf))) {
+                    file_info_removes.push_back(buf);
+                    continue;
+                }
+                if (xp.parse_str("remove_other_result", buf, sizeof(buf))) {
+                    other_result_removes.push_back(buf);
+                    continue;
+                }
+            }
+            continue;
+        }
         if (xp.match_tag("in_progress_results")) {
             have_ip_results_list = true;
             int i = 0;
@@ -739,6 +781,8 @@ SCHEDULER_REPLY::SCHEDULER_REPLY() {
     nucleus_only = false;
     project_is_down = false;
     send_msg_ack = false;
+    strcpy(list_digest_ack, "");
+    send_full_lists = false;
     strcpy(email_hash, "");
 }
 
@@ -860,6 +904,13 @@ int SCHEDULER_REPLY::write(FILE* fout, SCHEDULER_REQUEST& sreq) {
         }
     }
 
+    if (strlen(list_digest_ack)) {
+        fprintf(fout, "<list_digest_ack>%s</list_digest_ack>\n", list_digest_ack);
+    }
+    if (send_full_lists) {
+        fprintf(fout, "<send_full_lists/>\n");
+    }
+
     if (project_is_down) {
         fprintf(fout,"<project_is_down/>\n");
         goto end;
@@ -1612,18 +1663,44 @@ DB_HOST_APP_VERSION* gavid_to_havp(DB_ID_TYPE gavid) {
     return NULL;
 }
 
+// If the HAV cache is enabled, changes (and any records
+// created by update_host_app_versions()) are merged into the DB
+// in a single statement; otherwise each changed record is written.
+//
 void write_host_app_versions() {
+    int retval;
     for (unsigned int i=0; i<g_wreq->host_app_versions.size(); i++) {
         DB_HOST_APP_VERSION& hav = g_wreq->host_app_versions[i];
         DB_HOST_APP_VERSION& hav_orig = g_wreq->host_app_versions_orig[i];
 
-        int retval = hav.update_scheduler(hav_orig);
+        if (hav_cache.enabled()) {
+            if (hav.consecutive_valid == hav_orig.consecutive_valid
+                && hav.max_jobs_per_day == hav_orig.max_jobs_per_day
+                && hav.n_jobs_today == hav_orig.n_jobs_today
+            ) {
+                continue;
+            }
+            hav_cache.update(hav, hav_orig);
+            continue;
+        }
+        retval = hav.update_scheduler(hav_orig);
         if (retval) {
             log_messages.printf(MSG_CRITICAL,
                 "CRITICAL: hav.update_sched() error: %s\n", boincerror(retval)
             );
         }
     }
+    if (hav_cache.enabled()) {
+        retval = hav_cache.flush();
+        if (retval) {
+            log_messages.printf(MSG_CRITICAL,
+                "CRITICAL: hav_cache.flush() error: %s\n", boincerror(retval)
+            );
+        }
+        if (config.debug_quota) {
+            hav_cache.print_stats();
+        }
+    }
 }
 
 DB_HOST_APP_VERSION* BEST_APP_VERSION::host_app_version() {
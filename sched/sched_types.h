@@ -332,6 +332,16 @@ struct SCHEDULER_REQUEST {
         // in-progress results from all projects
     bool have_other_results_list;
     bool have_ip_results_list;
+    char list_digest[MD5_LEN];
+        // digest of the file_infos and other_results lists,
+        // if client can send changes to them (see sched_lists.h)
+    bool have_list_delta;
+        // file_infos and other_results are changes
+        // since the lists with digest list_base_digest
+    char list_base_digest[MD5_LEN];
+    std::vector<std::string> file_info_removes;
+    std::vector<std::string> other_result_removes;
+        // names of entries removed since those lists
     bool have_time_stats_log;
     bool client_cap_plan_class;
     int sandbox;
@@ -547,6 +557,11 @@ struct SCHEDULER_REPLY {
     char code_sign_key_signature[4096];
     bool send_msg_ack;
     bool project_is_down;
+    char list_digest_ack[MD5_LEN];
+        // we've stored the client's lists with this digest
+    bool send_full_lists;
+        // we couldn't apply the client's list changes;
+        // it should send full lists in its next request
     std::vector<APP_VERSION>old_app_versions;
         // superceded app versions that we consider using because of
         // homogeneous app version.
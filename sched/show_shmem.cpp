@@ -16,6 +16,9 @@
 // along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
 
 // show_shmem: display work_item part of shared-memory structure
+// show_shmem --latency: display scheduler latency histograms
+// show_shmem --prometheus: same, in Prometheus text format
+//      (e.g. for the node_exporter textfile collector)
 
 #include "config.h"
 #include <cstdio>
@@ -34,6 +37,9 @@ void usage(char *name) {
         "Displays the work_item part of shared-memory structure.\n\n"
         "Usage: %s [OPTION]\n\n"
         "Options:\n"
+        "  [ --latency ]          Show scheduler latency summary.\n"
+        "  [ --prometheus ]       Show scheduler latency histograms\n"
+        "                         in Prometheus text format.\n"
         "  [ -h | --help ]        Show this help text.\n"
         "  [ -v | --version ]     Shows version information.\n",
         name
@@ -44,12 +50,17 @@ int main(int argc, char *argv[]) {
     SCHED_SHMEM* ssp;
     int retval;
     void* p;
+    bool latency = false, prometheus = false;
 
     for (int c = 1; c < argc; c++) {
         std::string option(argv[c]);
         if(option == "-h" || option == "--help") {
             usage(argv[0]);
             exit(0);
+        } else if (option == "--latency") {
+            latency = true;
+        } else if (option == "--prometheus") {
+            prometheus = true;
         } else if(option == "-v" || option == "--version") {
             printf("%s\n", SVN_VERSION);
             exit(0);
@@ -65,12 +76,22 @@ int main(int argc, char *argv[]) {
         printf("Can't parse config.xml: %s\n", boincerror(retval));
         exit(1);
     }
-    retval = attach_shmem(config.shmem_key, &p);
+    retval = attach_sched_shmem(&p);
     if (retval) {
         printf("can't attach shmem: key %x\n", config.shmem_key);
         exit(1);
     }
     ssp = (SCHED_SHMEM*)p;
     retval = ssp->verify();
-    ssp->show(stdout);
+    if (retval) {
+        fprintf(stderr, "shmem has wrong struct sizes - recompile\n");
+        exit(1);
+    }
+    if (prometheus) {
+        ssp->latency.print_prometheus(stdout);
+    } else if (latency) {
+        ssp->latency.print(stdout);
+    } else {
+        ssp->show(stdout);
+    }
 }
@@ -49,6 +49,7 @@
 
 #include "sched_config.h"
 #include "credit.h"
+#include "hav_cache.h"
 #include "sched_util.h"
 #include "sched_msgs.h"
 #ifdef GCL_SIMULATOR
@@ -86,18 +87,18 @@ static int result_timed_out(
     TRANSITIONER_ITEM res_item, TRANSITIONER_ITEM& wu_item
 ) {
     DB_HOST_APP_VERSION hav;
-    char query[512], clause[512];
 
     DB_ID_TYPE gavid = generalized_app_version_id(
         res_item.res_app_version_id, wu_item.appid
     );
-    int retval = hav_lookup(hav, res_item.res_hostid, gavid);
+    int retval = hav_cache.lookup(hav, res_item.res_hostid, gavid);
     if (retval) {
         log_messages.printf(MSG_NORMAL,
             "result_timed_out(): hav_lookup failed: %s\n", boincerror(retval)
         );
         return 0;
     }
+    DB_HOST_APP_VERSION hav_orig = hav;
     hav.turnaround.update_var(
         (double)wu_item.delay_bound,
         HAV_AVG_THRESH, HAV_AVG_WEIGHT, HAV_AVG_LIMIT
@@ -123,20 +124,7 @@ static int result_timed_out(
 
     hav.consecutive_valid = 0;
 
-    sprintf(query,
-        "turnaround_n=%.15e, turnaround_avg=%.15e, turnaround_var=%.15e, turnaround_q=%.15e, max_jobs_per_day=%d, consecutive_valid=%d",
-        hav.turnaround.n,
-        hav.turnaround.avg,
-        hav.turnaround.var,
-        hav.turnaround.q,
-        hav.max_jobs_per_day,
-        hav.consecutive_valid
-    );
-    sprintf(clause,
-        "host_id=%lu and app_version_id=%lu",
-        hav.host_id, hav.app_version_id
-    );
-    retval = hav.update_fields_noid(query, clause);
+    retval = hav_cache.update(hav, hav_orig);
     if (retval) {
         log_messages.printf(MSG_CRITICAL,
             "CRITICAL result_timed_out(): hav updated failed: %s\n",
@@ -726,6 +714,7 @@ bool do_pass() {
             exit(1);
         }
 
+        hav_cache.poll();
         if (!one_pass) check_stop_daemons();
         if (wu_id) break;
     }
@@ -742,11 +731,13 @@ void main_loop() {
         );
         exit(1);
     }
+    boinc_db.use_prepared_statements = config.db_prepared_statements;
 
     while (1) {
         log_messages.printf(MSG_DEBUG, "doing a pass\n");
         if (1) {
             bool did_something = do_pass();
+            hav_cache.poll();
             if (one_pass) break;
             if (did_something) continue;
 #ifdef GCL_SIMULATOR
@@ -845,6 +836,7 @@ int main(int argc, char** argv) {
     log_messages.printf(MSG_NORMAL, "Starting\n");
 
     install_stop_signal_handler();
+    hav_cache.init(config.hav_cache_period);
 
     main_loop();
 }
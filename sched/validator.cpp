@@ -65,6 +65,7 @@
 #include "common_defs.h"
 
 #include "credit.h"
+#include "hav_cache.h"
 #include "sched_config.h"
 #include "sched_util.h"
 #include "sched_msgs.h"
@@ -316,7 +317,7 @@ int handle_wu(
 
             bool update_hav = false;
             DB_HOST_APP_VERSION hav;
-            retval = hav_lookup(hav, result.hostid,
+            retval = hav_cache.lookup(hav, result.hostid,
                 generalized_app_version_id(result.app_version_id, result.appid)
             );
             if (retval) {
@@ -379,7 +380,7 @@ int handle_wu(
                         havv[0].host_id, havv[0].app_version_id,
                         result.runtime_outlier, hav_orig.pfc.n, havv[0].pfc.n
                     );
-                    retval=havv[0].update_validator(hav_orig);
+                    retval = hav_cache.update(havv[0], hav_orig);
                     if (retval) {
                         log_messages.printf(MSG_CRITICAL,
                             "[HOST#%lu AV%lu] hav.update_validator() failed: %s\n",
@@ -432,7 +433,7 @@ int handle_wu(
 
             viable_results.push_back(result);
             DB_HOST_APP_VERSION hav;
-            retval = hav_lookup(hav, result.hostid,
+            retval = hav_cache.lookup(hav, result.hostid,
                 generalized_app_version_id(result.app_version_id, result.appid)
             );
             if (retval) {
@@ -643,7 +644,7 @@ int handle_wu(
                             hav.host_id, hav.app_version_id,
                             result.runtime_outlier, hav_orig.pfc.n, hav.pfc.n
                         );
-                        retval = hav.update_validator(hav_orig);
+                        retval = hav_cache.update(hav, hav_orig);
                         if (retval) {
                             log_messages.printf(MSG_CRITICAL,
                                 "[HOST#%lu AV%lu] hav.update_validator() failed: %s\n",
@@ -799,6 +800,7 @@ bool do_validate_scan() {
         }
         retval = handle_wu(validator, items);
         if (!retval) found = true;
+        hav_cache.poll();
         if (++i == one_pass_N_WU) break;
         if (wu_id) break;
         if (dry_run) break;  // otherwise it will enumerate forever
@@ -827,6 +829,7 @@ int main_loop() {
         did_something = do_validate_scan();
         if (!did_something) {
             write_modified_app_versions(app_versions);
+            hav_cache.poll();
             if (one_pass) break;
 #ifdef GCL_SIMULATOR
             char nameforsim[64];
@@ -968,6 +971,7 @@ int main(int argc, char** argv) {
         );
         exit(1);
     }
+    boinc_db.use_prepared_statements = config.db_prepared_statements;
 
     if (credit_from_runtime) {
         if (max_granted_credit == 0) {
@@ -1003,6 +1007,8 @@ int main(int argc, char** argv) {
         );
     }
 
+    hav_cache.init(dry_run?0:config.hav_cache_period);
+
     argv[j] = 0;
     retval = validate_handler_init(j, argv);
     if (retval) exit(1);
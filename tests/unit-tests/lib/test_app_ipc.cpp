@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+#include "common_defs.h"
+#include "app_ipc.h"
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+namespace test_app_ipc {
+
+    class test_app_ipc : public ::testing::Test {
+    protected:
+        SHARED_MEM* shm;
+        APP_CLIENT_SHM client, app;
+
+        virtual void SetUp() {
+            shm = new SHARED_MEM;
+            client.shm = shm;
+            client.reset_msgs();
+            app.shm = shm;
+        }
+
+        virtual void TearDown() {
+            delete shm;
+        }
+
+        // what the app does if the client passes msg_ring_version
+        //
+        void app_use_rings() {
+            app.has_rings = true;
+            shm->ring_header.app_ring_version = MSG_RING_VERSION;
+        }
+    };
+
+    TEST_F(test_app_ipc, ring_wraps) {
+        MSG_RING& r = shm->rings[0];
+        char buf[MSG_CHANNEL_SIZE];
+        string msg(1000, 'x');
+
+        EXPECT_FALSE(r.get(buf));
+        for (int i=0; i<100; i++) {
+            msg[0] = 'a' + i%26;
+            EXPECT_TRUE(r.put(msg.c_str()));
+            EXPECT_TRUE(r.put("<short/>"));
+            EXPECT_TRUE(r.get(buf));
+            EXPECT_STREQ(buf, msg.c_str());
+            EXPECT_TRUE(r.get(buf));
+            EXPECT_STREQ(buf, "<short/>");
+        }
+        EXPECT_TRUE(r.empty());
+    }
+
+    TEST_F(test_app_ipc, ring_full) {
+        MSG_RING& r = shm->rings[0];
+        char buf[MSG_CHANNEL_SIZE];
+        string msg(MSG_CHANNEL_SIZE-2, 'y');
+        int n = 0;
+
+        while (r.put(msg.c_str())) n++;
+        EXPECT_EQ(n, MSG_RING_SIZE/MSG_CHANNEL_SIZE);
+        EXPECT_TRUE(r.get(buf));
+        EXPECT_STREQ(buf, msg.c_str());
+        EXPECT_TRUE(r.put(msg.c_str()));
+
+        // messages are truncated like in a MSG_CHANNEL
+        //
+        while (r.get(buf)) {}
+        string big(2*MSG_CHANNEL_SIZE, 'z');
+        EXPECT_TRUE(r.put(big.c_str()));
+        EXPECT_TRUE(r.get(buf));
+        EXPECT_EQ(strlen(buf), (size_t)MSG_CHANNEL_SIZE-2);
+    }
+
+    TEST_F(test_app_ipc, old_app) {
+        char buf[MSG_CHANNEL_SIZE];
+
+        // app didn't opt in: one message at a time
+        //
+        EXPECT_TRUE(client.send_msg(shm->process_control_request, "<suspend/>"));
+        EXPECT_FALSE(client.send_msg(shm->process_control_request, "<resume/>"));
+        EXPECT_TRUE(shm->process_control_request.get_msg(buf));
+        EXPECT_STREQ(buf, "<suspend/>");
+    }
+
+    TEST_F(test_app_ipc, switch_to_rings) {
+        char buf[MSG_CHANNEL_SIZE];
+
+        // a message sent before the app opts in is received first
+        //
+        EXPECT_TRUE(client.send_msg(shm->process_control_request, "<suspend/>"));
+        app_use_rings();
+        EXPECT_TRUE(client.send_msg(shm->process_control_request, "<resume/>"));
+        EXPECT_TRUE(client.send_msg(shm->process_control_request, "<quit/>"));
+        EXPECT_TRUE(app.has_msg(shm->process_control_request));
+        EXPECT_TRUE(app.get_msg(shm->process_control_request, buf));
+        EXPECT_STREQ(buf, "<suspend/>");
+        EXPECT_TRUE(app.get_msg(shm->process_control_request, buf));
+        EXPECT_STREQ(buf, "<resume/>");
+        EXPECT_TRUE(app.get_msg(shm->process_control_request, buf));
+        EXPECT_STREQ(buf, "<quit/>");
+        EXPECT_FALSE(app.get_msg(shm->process_control_request, buf));
+
+        // graphics channels are always one-slot
+        //
+        EXPECT_TRUE(app.send_msg(shm->graphics_reply, "<a/>"));
+        EXPECT_FALSE(app.send_msg(shm->graphics_reply, "<b/>"));
+    }
+
+} // namespace
@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "error_numbers.h"
+#include "filesys.h"
+#include <cstdio>
+#include <string>
+
+using namespace std;
+
+namespace test_filesys {
+
+    // The fixture for testing the file copy functions.
+
+    class test_filesys : public ::testing::Test {
+    protected:
+        string src, dst;
+
+        test_filesys() {
+            src = "test_filesys_src";
+            dst = "test_filesys_dst";
+        }
+
+        virtual void TearDown() {
+            boinc_delete_file(src.c_str());
+            boinc_delete_file(dst.c_str());
+        }
+
+        void write_file(const string& path, size_t n) {
+            FILE* f = fopen(path.c_str(), "wb");
+            ASSERT_TRUE(f != NULL);
+            for (size_t i=0; i<n; i++) {
+                fputc((int)((i*7919) % 251), f);
+            }
+            fclose(f);
+        }
+
+        string read_file(const string& path) {
+            string s;
+            FILE* f = fopen(path.c_str(), "rb");
+            if (!f) return s;
+            int c;
+            while ((c = fgetc(f)) != EOF) s += (char)c;
+            fclose(f);
+            return s;
+        }
+    };
+
+    // a copy larger than the copy buffer is identical to the original,
+    // and replaces an existing file
+
+    TEST_F(test_filesys, boinc_copy) {
+        write_file(dst, 10);
+        write_file(src, 3*BOINC_COPY_BUFSIZE + 123);
+        EXPECT_EQ(boinc_copy(src.c_str(), dst.c_str()), 0);
+        EXPECT_TRUE(read_file(src) == read_file(dst));
+
+        write_file(src, 0);
+        EXPECT_EQ(boinc_copy(src.c_str(), dst.c_str()), 0);
+        EXPECT_EQ(read_file(dst).size(), (size_t)0);
+
+        boinc_delete_file(src.c_str());
+        EXPECT_NE(boinc_copy(src.c_str(), dst.c_str()), 0);
+    }
+
+    // a reflink either works and is identical to the original,
+    // or isn't supported here and leaves nothing behind
+
+    TEST_F(test_filesys, boinc_reflink) {
+        write_file(src, 100000);
+        int retval = boinc_reflink(src.c_str(), dst.c_str());
+        if (retval) {
+            EXPECT_EQ(retval, ERR_NOT_IMPLEMENTED);
+            EXPECT_FALSE(boinc_file_exists(dst.c_str()));
+        } else {
+            EXPECT_TRUE(read_file(src) == read_file(dst));
+        }
+    }
+
+} // namespace
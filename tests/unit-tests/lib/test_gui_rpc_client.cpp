@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+#include "common_defs.h"
+#include "gui_rpc_client.h"
+#include <string>
+#include <ios>
+
+using namespace std;
+
+namespace test_gui_rpc_client {
+
+    // The fixture for testing class Foo.
+
+    class test_gui_rpc_client : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        test_gui_rpc_client() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~test_gui_rpc_client() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+    // Tests that Foo does Xyz.
+
+    static RESULT* make_result(const char* url, const char* name, int state) {
+        RESULT* rp = new RESULT();
+        strcpy(rp->project_url, url);
+        strcpy(rp->name, name);
+        rp->state = state;
+        return rp;
+    }
+
+    TEST_F(test_gui_rpc_client, state_changes_apply) {
+        RESULTS rs;
+        FILE_TRANSFERS fts;
+        CC_STATE_CHANGES sc;
+
+        // full list replaces what's there
+        //
+        rs.results.push_back(make_result("http://a/", "old", 1));
+        sc.full = true;
+        sc.results.push_back(make_result("http://a/", "r1", 1));
+        sc.results.push_back(make_result("http://a/", "r2", 1));
+        sc.results.push_back(make_result("http://b/", "r1", 1));
+        sc.apply(rs, fts);
+        EXPECT_EQ(rs.results.size(), 3u);
+        EXPECT_TRUE(sc.results.empty());
+        EXPECT_STREQ(rs.results[0]->name, "r1");
+
+        // changes replace or append; removals are done first
+        //
+        sc.clear();
+        STATE_CHANGE_KEY k;
+        k.project_url = "http://a/";
+        k.name = "r2";
+        sc.deleted_results.push_back(k);
+        k.project_url = "http://b/";
+        k.name = "r1";
+        sc.deleted_results.push_back(k);
+        sc.results.push_back(make_result("http://a/", "r1", 2));
+        sc.results.push_back(make_result("http://b/", "r1", 3));
+        sc.results.push_back(make_result("http://b/", "r3", 1));
+        sc.apply(rs, fts);
+        ASSERT_EQ(rs.results.size(), 3u);
+        EXPECT_STREQ(rs.results[0]->name, "r1");
+        EXPECT_EQ(rs.results[0]->state, 2);
+        EXPECT_STREQ(rs.results[1]->project_url, "http://b/");
+        EXPECT_EQ(rs.results[1]->state, 3);
+        EXPECT_STREQ(rs.results[2]->name, "r3");
+        EXPECT_TRUE(fts.file_transfers.empty());
+    }
+
+} // namespace
@@ -0,0 +1,90 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2020 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+#include "keyword.h"
+
+using namespace std;
+
+namespace test_keyword {
+
+    // The fixture for testing class Foo.
+
+    class test_keyword : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        test_keyword() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~test_keyword() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+    TEST_F(test_keyword, bitset_parse_str) {
+        KEYWORD_BITSET kb;
+        kb.parse_str("");
+        EXPECT_TRUE(kb.empty());
+        kb.parse_str("1 63 64 200");
+        EXPECT_FALSE(kb.empty());
+        EXPECT_FALSE(kb.overflow);
+        EXPECT_EQ(kb.bits[0], (1ULL<<1) | (1ULL<<63));
+        EXPECT_EQ(kb.bits[1], 1ULL);
+        EXPECT_EQ(kb.bits[3], 1ULL<<8);
+        kb.parse_str("5 100000");
+        EXPECT_TRUE(kb.overflow);
+        EXPECT_FALSE(kb.empty());
+    }
+
+    TEST_F(test_keyword, keyword_score_bits) {
+        USER_KEYWORDS uk;
+        uk.yes_bits.set(3);
+        uk.yes_bits.set(70);
+        uk.no_bits.set(10);
+        KEYWORD_BITSET jk;
+        jk.parse_str("3 70 12");
+        EXPECT_EQ(keyword_score_bits(uk, jk), 2);
+        jk.parse_str("12 13");
+        EXPECT_EQ(keyword_score_bits(uk, jk), 0);
+        jk.parse_str("3 10");
+        EXPECT_EQ(keyword_score_bits(uk, jk), -1);
+
+        // "yes" takes precedence over "no"
+        uk.no_bits.set(3);
+        jk.parse_str("3");
+        EXPECT_EQ(keyword_score_bits(uk, jk), 1);
+    }
+
+} // namespace
@@ -0,0 +1,119 @@
+// This file is part of BOINC.
+// http://boinc.berkeley.edu
+// Copyright (C) 2024 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+#include "list_delta.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace test_list_delta {
+
+    // The fixture for testing class Foo.
+
+    class test_list_delta : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        test_list_delta() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~test_list_delta() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+            base["f:a"] = "<file_info><name>a</name></file_info>";
+            base["f:b"] = "<file_info><name>b</name></file_info>";
+            base["r:x"] = "<other_result><name>x</name></other_result>";
+            base["r:y"] = "<other_result><name>y</name></other_result>";
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+        map<string, string> base;
+    };
+
+    TEST_F(test_list_delta, list_digest) {
+        map<string, string> cur = base;
+        EXPECT_EQ(list_digest(cur), list_digest(base));
+        cur["f:a"] = "<file_info><name>a</name><sticky/></file_info>";
+        EXPECT_NE(list_digest(cur), list_digest(base));
+        EXPECT_EQ(list_digest(map<string, string>()), md5_string(""));
+    }
+
+    TEST_F(test_list_delta, no_changes) {
+        map<string, string> changed;
+        vector<string> removed;
+        make_list_delta(base, base, changed, removed);
+        EXPECT_TRUE(changed.empty());
+        EXPECT_TRUE(removed.empty());
+    }
+
+    TEST_F(test_list_delta, round_trip) {
+        map<string, string> cur = base;
+        cur["f:a"] = "<file_info><name>a</name><sticky/></file_info>";
+        cur.erase("f:b");
+        cur.erase("r:x");
+        cur["r:z"] = "<other_result><name>z</name></other_result>";
+
+        map<string, string> changed;
+        vector<string> removed;
+        make_list_delta(base, cur, changed, removed);
+        EXPECT_EQ(changed.size(), 2u);
+        EXPECT_EQ(changed.count("f:a"), 1u);
+        EXPECT_EQ(changed.count("r:z"), 1u);
+        ASSERT_EQ(removed.size(), 2u);
+        EXPECT_EQ(removed[0], "f:b");
+        EXPECT_EQ(removed[1], "r:x");
+
+        map<string, string> applied = base;
+        apply_list_delta(applied, changed, removed);
+        EXPECT_EQ(applied, cur);
+        EXPECT_EQ(list_digest(applied), list_digest(cur));
+    }
+
+    TEST_F(test_list_delta, remove_and_add_again) {
+        map<string, string> cur;
+        cur["f:b"] = "<file_info><name>b</name><nbytes>2</nbytes></file_info>";
+
+        map<string, string> changed;
+        vector<string> removed;
+        make_list_delta(base, cur, changed, removed);
+        EXPECT_EQ(changed.size(), 1u);
+        EXPECT_EQ(removed.size(), 3u);
+
+        map<string, string> applied = base;
+        apply_list_delta(applied, changed, removed);
+        EXPECT_EQ(list_digest(applied), list_digest(cur));
+    }
+
+} // namespace
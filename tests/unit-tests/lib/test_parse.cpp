@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 #include "common_defs.h"
 #include "url.h"
+#include "error_numbers.h"
+#include "parse.h"
 #include <string>
 #include <ios>
 
@@ -123,4 +125,24 @@ namespace test_parse {
 
     }
 
+    TEST_F(test_parse, copy_element_contents) {
+        MIOFILE mf;
+        string str;
+        char buf[64];
+
+        mf.init_buf_read("<a>1</a>\n<b>2</b></x><y>rest</y>");
+        EXPECT_EQ(copy_element_contents(mf, "</x>", str), 0);
+        EXPECT_EQ(str, "<a>1</a>\n<b>2</b>");
+
+        mf.init_buf_read(" abc </x>");
+        EXPECT_EQ(copy_element_contents(mf, "</x>", buf, sizeof(buf)), 0);
+        EXPECT_STREQ(buf, " abc ");
+
+        mf.init_buf_read("abcdef</x>");
+        EXPECT_EQ(copy_element_contents(mf, "</x>", buf, 4), ERR_BUFFER_OVERFLOW);
+
+        mf.init_buf_read("no end tag");
+        EXPECT_EQ(copy_element_contents(mf, "</x>", str), ERR_XML_PARSE);
+    }
+
 } // namespace
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "sched_latency.h"
+
+namespace test_sched_latency {
+
+    // The fixture for testing class Foo.
+
+    class test_sched_latency : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        test_sched_latency() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~test_sched_latency() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+    // Tests that Foo does Xyz.
+
+    TEST_F(test_sched_latency, hist_add) {
+        SCHED_LATENCY sl;
+        sl.clear();
+        sl.add(LAT_AUTHENTICATE, 0);
+        sl.add(LAT_AUTHENTICATE, 3e-6);
+        sl.add(LAT_AUTHENTICATE, 1000);
+        LATENCY_HIST& h = sl.hist[LAT_AUTHENTICATE];
+        ASSERT_EQ(h.n, 3ULL);
+        ASSERT_EQ(h.count[0], 1ULL);
+        ASSERT_EQ(h.count[1], 1ULL);
+        ASSERT_EQ(h.count[LATENCY_NBUCKETS-1], 1ULL);
+        ASSERT_EQ(sl.hist[LAT_REQUEST].n, 0ULL);
+    }
+
+    TEST_F(test_sched_latency, query_hook) {
+        SCHED_LATENCY sl;
+        sl.clear();
+        g_latency = &sl;
+        latency_query_hook("select * from app", .001);
+        latency_query_hook("UPDATE result set server_state=4", .001);
+        latency_query_hook("START TRANSACTION", .001);
+        g_latency = 0;
+        latency_query_hook("insert into host values (1)", .001);
+        ASSERT_EQ(sl.hist[LAT_DB_SELECT].n, 1ULL);
+        ASSERT_EQ(sl.hist[LAT_DB_UPDATE].n, 1ULL);
+        ASSERT_EQ(sl.hist[LAT_DB_OTHER].n, 1ULL);
+        ASSERT_EQ(sl.hist[LAT_DB_INSERT].n, 0ULL);
+    }
+
+} // namespace